@@ -0,0 +1,257 @@
+#include "asset_loader.h"
+#include "raylib.h"
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+
+typedef enum {
+    ASSET_QUEUED = 0,
+    ASSET_DECODING,
+    ASSET_DECODED,
+    ASSET_READY
+} AssetState;
+
+typedef struct {
+    AssetTiming timing;
+    std::function<void()> decode;
+    std::function<void()> upload;
+    std::vector<int> dependsOn;
+    AssetState state;
+} Asset;
+
+// A file read ahead on a loader thread, waiting for raylib to ask for it
+typedef struct {
+    std::string path;
+    unsigned char* data;
+    int size;
+} ProvidedFile;
+
+float assetUploadBudgetMs = ASSET_UPLOAD_BUDGET_MS;
+
+static std::vector<Asset*> assets;   // entries never move; state guarded by assetMutex
+static std::mutex assetMutex;
+static std::condition_variable assetWake;
+static std::vector<std::thread> loaderThreads;
+static bool stopping = false;
+static std::chrono::steady_clock::time_point loadStart;
+static AssetLoadProgress progress = { 0 };
+
+static std::vector<ProvidedFile> providedFiles;
+static std::mutex providedMutex;
+
+static double NowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+}
+
+static bool DependenciesReached(const Asset* asset, AssetState state) {
+    for (int dependency : asset->dependsOn) {
+        if (assets[dependency]->state < state) return false;
+    }
+    return true;
+}
+
+// Call with assetMutex held
+static Asset* NextDecodable() {
+    for (Asset* asset : assets) {
+        if (asset->state == ASSET_QUEUED && DependenciesReached(asset, ASSET_DECODED)) return asset;
+    }
+    return nullptr;
+}
+
+// Call with assetMutex held; queue order, so uploads happen in the order assets were requested
+static Asset* NextUploadable() {
+    for (Asset* asset : assets) {
+        if (asset->state == ASSET_DECODED && DependenciesReached(asset, ASSET_READY)) return asset;
+    }
+    return nullptr;
+}
+
+static void LoaderMain() {
+    for (;;) {
+        Asset* asset = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(assetMutex);
+            assetWake.wait(lock, [&] { asset = NextDecodable(); return stopping || asset != nullptr; });
+            if (asset == nullptr) return;
+            asset->state = ASSET_DECODING;
+        }
+
+        double start = NowMs();
+        asset->decode();
+        double decodeMs = NowMs() - start;
+
+        {
+            std::lock_guard<std::mutex> lock(assetMutex);
+            asset->timing.decodeMs = decodeMs;
+            asset->state = ASSET_DECODED;
+        }
+        assetWake.notify_all();
+    }
+}
+
+// raylib routes every LoadFileData through here while loading, from any thread
+static unsigned char* LoadFileDataCallbackFn(const char* fileName, int* dataSize) {
+    {
+        std::lock_guard<std::mutex> lock(providedMutex);
+        for (size_t i = 0; i < providedFiles.size(); i++) {
+            if (providedFiles[i].path != fileName) continue;
+            unsigned char* data = providedFiles[i].data;   // raylib frees it with UnloadFileData
+            *dataSize = providedFiles[i].size;
+            providedFiles.erase(providedFiles.begin() + i);
+            return data;
+        }
+    }
+    return ReadAssetFile(fileName, dataSize);
+}
+
+unsigned char* ReadAssetFile(const char* path, int* size) {
+    *size = 0;
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "ASSETS: Failed to open %s", path);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = (length > 0) ? (unsigned char*)MemAlloc((unsigned int)length) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)length, file) != (size_t)length) {
+        MemFree(data);
+        data = NULL;
+    }
+    fclose(file);
+
+    if (data != NULL) *size = (int)length;
+    return data;
+}
+
+void ProvideFileData(const char* path, unsigned char* data, int size) {
+    if (data == NULL) return;
+    std::lock_guard<std::mutex> lock(providedMutex);
+    providedFiles.push_back(ProvidedFile{ path, data, size });
+}
+
+int QueueAsset(const char* name, std::function<void()> decode, std::function<void()> upload, const std::vector<int>& dependsOn) {
+    Asset* asset = new Asset();
+    snprintf(asset->timing.name, sizeof(asset->timing.name), "%s", name);
+    asset->decode = decode;
+    asset->upload = upload;
+    asset->dependsOn = dependsOn;
+    asset->state = decode ? ASSET_QUEUED : ASSET_DECODED;
+
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(assetMutex);
+        index = (int)assets.size();
+        assets.push_back(asset);
+        progress.total = index + 1;
+        progress.done = false;
+    }
+    assetWake.notify_all();
+    return index;
+}
+
+void StartAssetLoading() {
+    loadStart = std::chrono::steady_clock::now();
+    SetLoadFileDataCallback(LoadFileDataCallbackFn);
+
+    // A few threads: decoding is mostly stb_image and file reads, and the job system keeps its own workers
+    int hardwareThreads = (int)std::thread::hardware_concurrency();
+    int threadCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+    if (threadCount > ASSET_LOADER_MAX_THREADS) threadCount = ASSET_LOADER_MAX_THREADS;
+
+    stopping = false;
+    for (int i = 0; i < threadCount; i++) {
+        loaderThreads.emplace_back(LoaderMain);
+    }
+}
+
+static void StopAssetLoading() {
+    {
+        std::lock_guard<std::mutex> lock(assetMutex);
+        stopping = true;
+    }
+    assetWake.notify_all();
+    for (std::thread& thread : loaderThreads) thread.join();
+    loaderThreads.clear();
+    SetLoadFileDataCallback(NULL);
+
+    // Anything provided but never requested
+    for (ProvidedFile& file : providedFiles) MemFree(file.data);
+    providedFiles.clear();
+
+    TraceLog(LOG_INFO, "ASSETS: %d assets ready in %.1f ms", progress.total, progress.elapsedMs);
+    for (Asset* asset : assets) {
+        TraceLog(LOG_INFO, "ASSETS:   %-28s decode %8.2f ms   upload %8.2f ms   ready at %8.1f ms",
+                 asset->timing.name, asset->timing.decodeMs, asset->timing.uploadMs, asset->timing.readyMs);
+        delete asset;
+    }
+    assets.clear();
+}
+
+bool UpdateAssetLoading() {
+    if (progress.done || progress.total == 0) return true;
+
+    double frameStart = NowMs();
+    progress.uploadsLastFrame = 0;
+
+    for (;;) {
+        Asset* asset = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(assetMutex);
+            asset = NextUploadable();
+        }
+        if (asset == nullptr) break;
+
+        double start = NowMs();
+        if (asset->upload) asset->upload();
+        double now = NowMs();
+
+        {
+            std::lock_guard<std::mutex> lock(assetMutex);
+            asset->timing.uploadMs = now - start;
+            asset->timing.readyMs = now;
+            asset->state = ASSET_READY;
+            progress.ready++;
+            progress.lastReady = asset->timing.name;
+        }
+        assetWake.notify_all();
+        progress.uploadsLastFrame++;
+
+        // At least one upload per frame, then stop once the budget is spent
+        if (now - frameStart >= assetUploadBudgetMs) break;
+    }
+
+    progress.uploadMsLastFrame = NowMs() - frameStart;
+    progress.elapsedMs = NowMs();
+
+    if (progress.ready == progress.total) {
+        progress.done = true;
+        progress.lastReady = NULL;
+        StopAssetLoading();
+    }
+    return progress.done;
+}
+
+void FinishAssetLoading() {
+    float budget = assetUploadBudgetMs;
+    assetUploadBudgetMs = FLT_MAX;
+
+    while (!UpdateAssetLoading()) {
+        std::unique_lock<std::mutex> lock(assetMutex);
+        assetWake.wait(lock, [] { return NextUploadable() != nullptr; });
+    }
+
+    assetUploadBudgetMs = budget;
+}
+
+const AssetLoadProgress* GetAssetLoadProgress() {
+    return &progress;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#define ASSET_NAME_LENGTH 48
+#define ASSET_LOADER_MAX_THREADS 4
+#define ASSET_UPLOAD_BUDGET_MS 4.0f
+
+typedef struct {
+    char name[ASSET_NAME_LENGTH];
+    double decodeMs;   // loader thread: file read and CPU decode
+    double uploadMs;   // main thread: GL upload and setup
+    double readyMs;    // since loading started
+} AssetTiming;
+
+typedef struct {
+    int total;
+    int ready;
+    int uploadsLastFrame;
+    double uploadMsLastFrame;
+    double elapsedMs;
+    const char* lastReady;
+    bool done;
+} AssetLoadProgress;
+
+extern float assetUploadBudgetMs;   // main-thread upload time per frame while loading
+
+// Queue an asset. decode runs on a loader thread and must not touch GL; upload runs on the
+// main thread. Decode waits for the dependencies' decodes, upload for their uploads.
+// Either step may be empty; uploads may queue further assets.
+int QueueAsset(const char* name, std::function<void()> decode, std::function<void()> upload,
+               const std::vector<int>& dependsOn = std::vector<int>());
+void StartAssetLoading();
+// Run uploads until this frame's budget is spent; true once every asset is ready
+bool UpdateAssetLoading();
+// Block until every queued asset is ready (headless runs, early exit)
+void FinishAssetLoading();
+const AssetLoadProgress* GetAssetLoadProgress();
+
+// Whole-file read that is safe off the main thread. The buffer comes from MemAlloc;
+// handing it to ProvideFileData lets raylib's next LoadFileData of that path use it instead of the disk.
+unsigned char* ReadAssetFile(const char* path, int* size);
+void ProvideFileData(const char* path, unsigned char* data, int size);
@@ -0,0 +1,316 @@
+#include "renderer.h"
+#include "profiler.h"
+#include "deferred.h"
+#include "depth_prepass.h"
+#include "frame_graph.h"
+#include "dynamic_resolution.h"
+#include "light_probe.h"
+#include "asset_loader.h"
+#include "scene_cache.h"
+#include "shadow_atlas.h"
+#include "occlusion_culling.h"
+#include "frame_capture.h"
+#include "light_animation.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+// Benchmark settings, overridable from the command line
+typedef struct {
+    int frames;
+    int warmupFrames;
+    int width;
+    int height;
+    int lights;
+    int shading;
+    bool depthPrepass;
+    bool occlusionCulling;
+    bool leanPost;
+    const char* csvPath;
+    float budgetMs;
+    float resolutionBudgetMs;   // > 0 enables dynamic resolution steering to this GPU time
+    const char* captureDir;     // write every measured frame here when set
+    int captureFormat;
+} BenchmarkOptions;
+
+static void PrintUsage(const char* exe) {
+    printf("Usage: %s [--frames N] [--warmup N] [--width W] [--height H] [--lights N] [--shading forward|deferred] [--depth-prepass] [--no-occlusion] [--lean-post] [--csv PATH] [--budget-ms MS] [--dynres-budget MS] [--capture DIR] [--capture-format png|raw]\n", exe);
+}
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (strcmp(arg, "--frames") == 0 && hasValue) options->frames = atoi(argv[++i]);
+        else if (strcmp(arg, "--warmup") == 0 && hasValue) options->warmupFrames = atoi(argv[++i]);
+        else if (strcmp(arg, "--width") == 0 && hasValue) options->width = atoi(argv[++i]);
+        else if (strcmp(arg, "--height") == 0 && hasValue) options->height = atoi(argv[++i]);
+        else if (strcmp(arg, "--lights") == 0 && hasValue) options->lights = atoi(argv[++i]);
+        else if (strcmp(arg, "--shading") == 0 && hasValue) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "forward") == 0) options->shading = SHADING_FORWARD;
+            else if (strcmp(mode, "deferred") == 0) options->shading = SHADING_DEFERRED;
+            else {
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }
+        else if (strcmp(arg, "--depth-prepass") == 0) options->depthPrepass = true;
+        else if (strcmp(arg, "--no-occlusion") == 0) options->occlusionCulling = false;
+        else if (strcmp(arg, "--lean-post") == 0) options->leanPost = true;
+        else if (strcmp(arg, "--csv") == 0 && hasValue) options->csvPath = argv[++i];
+        else if (strcmp(arg, "--budget-ms") == 0 && hasValue) options->budgetMs = (float)atof(argv[++i]);
+        else if (strcmp(arg, "--dynres-budget") == 0 && hasValue) options->resolutionBudgetMs = (float)atof(argv[++i]);
+        else if (strcmp(arg, "--capture") == 0 && hasValue) options->captureDir = argv[++i];
+        else if (strcmp(arg, "--capture-format") == 0 && hasValue) {
+            const char* format = argv[++i];
+            if (strcmp(format, "png") == 0) options->captureFormat = CAPTURE_PNG;
+            else if (strcmp(format, "raw") == 0) options->captureFormat = CAPTURE_RAW;
+            else {
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }
+        else {
+            PrintUsage(argv[0]);
+            return false;
+        }
+    }
+
+    return options->frames > 0 && options->width > 0 && options->height > 0;
+}
+
+// Deterministic fly-through along the Sponza nave, t in [0, 1]
+static void SetBenchmarkCamera(float t) {
+    float angle = 2.0f * PI * t;
+
+    cam.position = Vector3{ Lerp(-8.0f, 8.0f, t), 2.0f + 0.5f * sinf(2.0f * angle), 0.6f * sinf(angle) };
+    cam.target = Vector3Add(cam.position, Vector3{ 1.0f, -0.1f, 0.3f * cosf(angle) });
+    cam.up = Vector3{ 0.0f, 1.0f, 0.0f };
+    cam.fovy = 45.0f;
+    cam.projection = CAMERA_PERSPECTIVE;
+}
+
+// Orbit every light around its load-time position
+static void SetBenchmarkLights(const Vector3* anchors, float t) {
+    for (int i = 0; i < lightCount; i++) {
+        float phase = 2.0f * PI * t * 3.0f + (float)i * (2.0f * PI / DEFAULT_LIGHTS);
+        lights[i].position = Vector3Add(anchors[i], Vector3{ cosf(phase), 0.25f * sinf(2.0f * phase), sinf(phase) });
+        MarkLightDirty(i);
+    }
+}
+
+// Per-frame pass timings keyed by scope name: passes that skip frames (probe faces, prefiltering)
+// keep their own column instead of shifting everything after them
+typedef struct {
+    std::vector<std::string> names;              // in first-seen order
+    std::vector<std::vector<double>> rows;       // frame cpu and gpu, then cpu and gpu per name; NAN where it did not run
+} PassTable;
+
+static int PassColumn(PassTable* table, const char* name) {
+    for (int i = 0; i < (int)table->names.size(); i++) {
+        if (table->names[i] == name) return i;
+    }
+    table->names.push_back(name);
+    return (int)table->names.size() - 1;
+}
+
+// Scopes sharing a name within one frame are summed
+static void RecordFrame(PassTable* table, const ProfilerFrame* frame) {
+    std::vector<double> row = { frame->cpuFrameMs, frame->gpuFrameMs };
+    for (int i = 0; i < frame->scopeCount; i++) {
+        size_t cell = 2 + 2 * (size_t)PassColumn(table, frame->scopes[i].name);
+        if (row.size() < cell + 2) row.resize(cell + 2, NAN);
+        if (isnan(row[cell])) {
+            row[cell] = 0.0;
+            row[cell + 1] = 0.0;
+        }
+        row[cell] += frame->scopes[i].cpuMs;
+        row[cell + 1] += frame->scopes[i].gpuMs;
+    }
+    table->rows.push_back(row);
+}
+
+static void WriteCsv(FILE* csv, const PassTable* table) {
+    fprintf(csv, "frame,cpu_frame_ms,gpu_frame_ms");
+    for (const std::string& name : table->names) {
+        fprintf(csv, ",%s_cpu_ms,%s_gpu_ms", name.c_str(), name.c_str());
+    }
+    fprintf(csv, "\n");
+
+    for (size_t frame = 0; frame < table->rows.size(); frame++) {
+        const std::vector<double>& row = table->rows[frame];
+        fprintf(csv, "%d", (int)frame);
+        for (size_t cell = 0; cell < 2 + 2 * table->names.size(); cell++) {
+            if (cell < row.size() && !isnan(row[cell])) fprintf(csv, ",%.4f", row[cell]);
+            else fprintf(csv, ",");
+        }
+        fprintf(csv, "\n");
+    }
+}
+
+// GPU time of one column averaged over every measured frame, counting frames it skipped as zero
+static double MeanPassGpuMs(const PassTable* table, int column) {
+    size_t cell = 2 + 2 * (size_t)column + 1;
+    double total = 0.0;
+    for (const std::vector<double>& row : table->rows) {
+        if (cell < row.size() && !isnan(row[cell])) total += row[cell];
+    }
+    return table->rows.empty() ? 0.0 : total / (double)table->rows.size();
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options = { 300, 10, W, H, DEFAULT_LIGHTS, SHADING_FORWARD, false, true, false, "benchmark.csv", 0.0f, 0.0f, NULL, CAPTURE_PNG };
+    if (!ParseOptions(argc, argv, &options)) return 2;
+
+    // Offscreen, uncapped: no visible window, no vsync, no FPS limiter
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(options.width, options.height, "Raylib - Benchmark");
+    SetTargetFPS(0);
+    InitializeCamera();
+
+    int width = options.width;
+    int height = options.height;
+    enableLeanPost = options.leanPost;
+    hdr = CreateRenderTextures(width, height, hdr, bright);
+    LoadResources();
+    FinishAssetLoading();
+    ReportSceneStartup();
+    const SceneCacheInfo* sceneCache = GetSceneCacheInfo();
+    printf("BENCHMARK: %s start, scene ready %.0f ms after window creation\n",
+           sceneCache->used ? "warm (scene cache)" : "cold (source assets)", sceneCache->startupMs);
+    printf("BENCHMARK: textures %.1f MB on the GPU, %.1f MB as RGBA8\n", (double)sceneCache->textureMemory.gpuBytes / (1024.0 * 1024.0),
+           (double)sceneCache->textureMemory.uncompressedBytes / (1024.0 * 1024.0));
+
+    // Every frame's timings are needed for the CSV, so resolve queries synchronously
+    InitializeProfiler();
+    profilerEnabled = true;
+    profilerBlockingResolve = true;
+
+    SetLightCount(options.lights);
+    shadingPath = options.shading;
+    enableDepthPrepass = options.depthPrepass;
+    enableOcclusionCulling = options.occlusionCulling;
+    enableDynamicResolution = (options.resolutionBudgetMs > 0.0f);
+    if (enableDynamicResolution) resolutionBudgetMs = options.resolutionBudgetMs;
+    static Vector3 anchors[MAX_LIGHTS];
+    for (int i = 0; i < lightCount; i++) anchors[i] = lights[i].position;
+
+    FILE* csv = fopen(options.csvPath, "w");
+    if (csv == NULL) {
+        printf("BENCHMARK: failed to open %s for writing\n", options.csvPath);
+        return 1;
+    }
+
+    std::vector<double> frameMs;
+    frameMs.reserve(options.frames);
+    PassTable passes;
+    long long shadowFaces = 0;
+
+    int totalFrames = options.warmupFrames + options.frames;
+    for (int frame = 0; frame < totalFrames; frame++) {
+        int measured = frame - options.warmupFrames;
+        float t = (measured < 0) ? 0.0f : (float)measured / (float)options.frames;
+
+        SetBenchmarkCamera(t);
+        SetBenchmarkLights(anchors, t);
+        if (measured == 0 && options.captureDir != NULL) StartFrameCapture(options.captureDir, (CaptureFormat)options.captureFormat);
+
+        ProfilerBeginFrame();
+            if (enableLightProbe) {
+                UpdateLightProbe();
+            }
+            UpdateShaderUniforms();
+            RenderScene(width, height);
+
+            BeginDrawing();
+                DrawFinalPass(width, height);
+            EndDrawing();
+        ProfilerEndFrame();
+
+        if (measured < 0) continue;
+
+        const ProfilerFrame* result = ProfilerGetLastFrame();
+        RecordFrame(&passes, result);
+
+        frameMs.push_back(fmax(result->cpuFrameMs, result->gpuFrameMs));
+        shadowFaces += GetShadowAtlasStats()->facesRendered;
+    }
+    WriteCsv(csv, &passes);
+    fclose(csv);
+
+    // Waits for the last readbacks and the writer, so the rate covers every frame on disk
+    if (IsFrameCaptureActive()) StopFrameCapture();
+
+    // One unmeasured frame in the other post mode, to report its target traffic next to this one's
+    FrameGraphStats graph = *GetFrameGraphStats();
+    enableLeanPost = !enableLeanPost;
+    ProfilerBeginFrame();
+        RenderScene(width, height);
+        BeginDrawing();
+            DrawFinalPass(width, height);
+        EndDrawing();
+    ProfilerEndFrame();
+    enableLeanPost = !enableLeanPost;
+
+    // Summary: mean and 95th percentile of max(cpu, gpu) frame time
+    std::vector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    double mean = 0.0;
+    for (double ms : frameMs) mean += ms;
+    mean /= (double)frameMs.size();
+    double p95 = sorted[(size_t)((sorted.size() - 1) * 0.95)];
+
+    const char* shadingName = (shadingPath == SHADING_DEFERRED) ? "deferred" : "forward";
+    printf("BENCHMARK: %d frames at %dx%d with %d lights (%s), mean %.3f ms, p95 %.3f ms\n", options.frames, width, height, lightCount, shadingName, mean, p95);
+    for (int i = 0; i < (int)passes.names.size(); i++) {
+        printf("BENCHMARK:   %-16s gpu %.3f ms\n", passes.names[i].c_str(), MeanPassGpuMs(&passes, i));
+    }
+    if (shadingPath == SHADING_FORWARD) {
+        const OverdrawStats* overdraw = GetOverdrawStats();
+        printf("BENCHMARK: depth pre-pass %s, %.2f fragments shaded per pixel", enableDepthPrepass ? "on" : "off", overdraw->litFragmentsPerPixel);
+        if (overdraw->prepassActive) printf(" (%.2f without pre-pass)", overdraw->prepassFragmentsPerPixel);
+        printf("\n");
+    }
+    if (enableDynamicResolution) {
+        const DynamicResolutionState* resolution = GetDynamicResolutionState();
+        printf("BENCHMARK: dynamic resolution budget %.2f ms, final scale %.2f (%dx%d)\n", resolutionBudgetMs,
+               resolution->scale, resolution->renderWidth, resolution->renderHeight);
+    }
+    if (enableShadows) {
+        const ShadowAtlasStats* shadows = GetShadowAtlasStats();
+        printf("BENCHMARK: shadows on %d of %d on-screen lights, %.2f faces rendered per frame (budget %d)\n",
+               shadows->shadowedLights, shadows->candidates, (double)shadowFaces / (double)options.frames, shadowFaceBudget);
+    }
+    const FrameCaptureStats* capture = GetFrameCaptureStats();
+    if (capture->framesIssued > 0) {
+        printf("BENCHMARK: captured %d of %d frames to %s (%s), %.1f frames/s, %d ring waits, %d writer waits\n",
+               capture->framesWritten, capture->framesIssued, options.captureDir, capture->format == CAPTURE_PNG ? "png" : "raw",
+               capture->captureFps, capture->ringWaits, capture->writerWaits);
+    }
+    printf("BENCHMARK: frame graph ran %d of %d passes, pooled targets %.1f MB (%.1f MB unaliased)\n",
+           graph.passes - graph.passesCulled, graph.passes,
+           (double)graph.pooledBytes / (1024.0 * 1024.0), (double)graph.unaliasedBytes / (1024.0 * 1024.0));
+    printf("BENCHMARK: %s post chain moves %.1f MB of color targets per frame (%s: %.1f MB)\n",
+           enableLeanPost ? "lean" : "standard", (double)GetPostTargetBytes(enableLeanPost) / (1024.0 * 1024.0),
+           enableLeanPost ? "standard" : "lean", (double)GetPostTargetBytes(!enableLeanPost) / (1024.0 * 1024.0));
+    printf("BENCHMARK: per-frame timings written to %s\n", options.csvPath);
+
+    UnloadProfiler();
+    UnloadResources();
+    CloseWindow();
+
+    // A non-zero budget turns the run into a perf regression check
+    if (options.budgetMs > 0.0f && p95 > options.budgetMs) {
+        printf("BENCHMARK: FAILED, p95 %.3f ms exceeds budget %.3f ms\n", p95, options.budgetMs);
+        return 1;
+    }
+
+    return 0;
+}
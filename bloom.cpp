@@ -0,0 +1,134 @@
+#include "bloom.h"
+#include "profiler.h"
+#include "shader_cache.h"
+#include <stdio.h>
+
+bool enableBloom = true;
+int bloomQuality = BLOOM_QUALITY_MEDIUM;
+float bloomRadius = 1.0f;
+
+static const int bloomBaseHeights[3] = { 270, 540, 1080 };
+
+static Shader shDownsample, shUpsample;
+static int locDownTexel, locDownPrefilter, locDownThreshold, locDownKnee;
+static int locUpTexel, locUpRadius;
+
+static int mipCount = 0;
+
+void InitializeBloom() {
+    LoadWatchedShader(&shDownsample, NULL, "resources/shaders/bloom_downsample.fs", [](unsigned int) {
+        shDownsample.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shDownsample, "source");
+        locDownTexel = GetShaderLocation(shDownsample, "u_texelSize");
+        locDownPrefilter = GetShaderLocation(shDownsample, "u_prefilter");
+        locDownThreshold = GetShaderLocation(shDownsample, "u_threshold");
+        locDownKnee = GetShaderLocation(shDownsample, "u_knee");
+    });
+
+    LoadWatchedShader(&shUpsample, NULL, "resources/shaders/bloom_upsample.fs", [](unsigned int) {
+        shUpsample.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shUpsample, "source");
+        locUpTexel = GetShaderLocation(shUpsample, "u_texelSize");
+        locUpRadius = GetShaderLocation(shUpsample, "u_radius");
+    });
+}
+
+void UnloadBloom() {
+    UnloadWatchedShader(&shDownsample);
+    UnloadWatchedShader(&shUpsample);
+}
+
+// Draw the sourceWidth x sourceHeight corner of source stretched over the current target, flipped like every other post pass
+static void DrawStretched(Texture2D source, int sourceWidth, int sourceHeight, int width, int height) {
+    Rectangle srcRect = { 0, 0, (float)sourceWidth, -(float)sourceHeight };
+    Rectangle dstRect = { 0, 0, (float)width, (float)height };
+    DrawTexturePro(source, srcRect, dstRect, Vector2{ 0, 0 }, 0.0f, WHITE);
+}
+
+// Threshold and downsample source through the pyramid, then upsample and accumulate back to mip 0.
+// The pyramid is half-resolution capped at the quality's height, halved down to ~8 pixels; its levels
+// are transient graph targets, so they only exist while some pass consumes the result. The source may be
+// rendered into a smaller region of its texture; the pyramid is sized by the output so it stays pooled.
+// In lean post mode the source is hdr itself, so the prefiltered first level is the bright pass.
+FgResource AddBloomPasses(FgResource source, int sourceWidth, int sourceHeight, int width, int height) {
+    int baseHeight = height / 2;
+    if (baseHeight > bloomBaseHeights[bloomQuality]) baseHeight = bloomBaseHeights[bloomQuality];
+    int baseWidth = (int)((float)width * (float)baseHeight / (float)height);
+
+    // Packed floats in lean post mode: alpha is never read and the blurred levels hide the shorter mantissa
+    int format = enableLeanPost ? FRAME_GRAPH_FORMAT_R11G11B10F : RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16;
+    FgResource mips[BLOOM_MAX_MIPS];
+    char name[PROFILER_NAME_LENGTH];
+
+    int mipWidth = baseWidth;
+    int mipHeight = baseHeight;
+    for (mipCount = 0; mipCount < BLOOM_MAX_MIPS && mipWidth >= 8 && mipHeight >= 8; mipCount++) {
+        snprintf(name, sizeof(name), "bloom_mip_%d", mipCount);
+        mips[mipCount] = FrameGraphCreate(name, mipWidth, mipHeight, format);
+        mipWidth /= 2;
+        mipHeight /= 2;
+    }
+
+    for (int i = 0; i < mipCount; i++) {
+        FgResource input = (i == 0) ? source : mips[i - 1];
+        FgResource output = mips[i];
+
+        snprintf(name, sizeof(name), "bloom_down_%d", i);
+        int pass = FrameGraphAddPass(name, FRAME_GRAPH_PHASE_OFFSCREEN, [input, output, i, sourceWidth, sourceHeight]() {
+            Texture2D inputTexture = FrameGraphTarget(input).texture;
+            RenderTexture2D target = FrameGraphTarget(output);
+            int inputWidth = (i == 0) ? sourceWidth : inputTexture.width;
+            int inputHeight = (i == 0) ? sourceHeight : inputTexture.height;
+            Vector2 texelSize = { 1.0f / (float)inputTexture.width, 1.0f / (float)inputTexture.height };
+            int prefilter = (i == 0) ? 1 : 0;
+            float knee = bloomThreshold * BLOOM_KNEE;
+            BeginTextureMode(target);
+                BeginShaderMode(shDownsample);
+                    SetShaderValue(shDownsample, locDownTexel, &texelSize, SHADER_UNIFORM_VEC2);
+                    SetShaderValue(shDownsample, locDownPrefilter, &prefilter, SHADER_UNIFORM_INT);
+                    SetShaderValue(shDownsample, locDownThreshold, &bloomThreshold, SHADER_UNIFORM_FLOAT);
+                    SetShaderValue(shDownsample, locDownKnee, &knee, SHADER_UNIFORM_FLOAT);
+                    SetShaderValueTexture(shDownsample, shDownsample.locs[SHADER_LOC_MAP_DIFFUSE], inputTexture);
+                    DrawStretched(inputTexture, inputWidth, inputHeight, target.texture.width, target.texture.height);
+                EndShaderMode();
+            EndTextureMode();
+        });
+        FrameGraphRead(pass, input);
+        FrameGraphWrite(pass, output);
+    }
+
+    // Each level's tent-filtered upsample is added onto the next larger one
+    for (int i = mipCount - 1; i > 0; i--) {
+        FgResource smaller = mips[i];
+        FgResource larger = mips[i - 1];
+
+        snprintf(name, sizeof(name), "bloom_up_%d", i - 1);
+        int pass = FrameGraphAddPass(name, FRAME_GRAPH_PHASE_OFFSCREEN, [smaller, larger]() {
+            Texture2D smallerTexture = FrameGraphTarget(smaller).texture;
+            RenderTexture2D target = FrameGraphTarget(larger);
+            Vector2 texelSize = { 1.0f / (float)smallerTexture.width, 1.0f / (float)smallerTexture.height };
+            BeginTextureMode(target);
+                BeginBlendMode(BLEND_ADDITIVE);
+                BeginShaderMode(shUpsample);
+                    SetShaderValue(shUpsample, locUpTexel, &texelSize, SHADER_UNIFORM_VEC2);
+                    SetShaderValue(shUpsample, locUpRadius, &bloomRadius, SHADER_UNIFORM_FLOAT);
+                    SetShaderValueTexture(shUpsample, shUpsample.locs[SHADER_LOC_MAP_DIFFUSE], smallerTexture);
+                    DrawStretched(smallerTexture, smallerTexture.width, smallerTexture.height, target.texture.width, target.texture.height);
+                EndShaderMode();
+                EndBlendMode();
+            EndTextureMode();
+        });
+        FrameGraphRead(pass, smaller);
+        FrameGraphRead(pass, larger);
+        FrameGraphWrite(pass, larger);
+    }
+
+    return (mipCount > 0) ? mips[0] : source;
+}
+
+int GetBloomMipCount() {
+    return mipCount;
+}
+
+// Scene shaders write bright only above the knee's lower edge; the prefilter shapes the rest
+float GetBloomCutoff() {
+    return bloomThreshold - bloomThreshold * BLOOM_KNEE;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "renderer.h"
+#include "frame_graph.h"
+
+#define BLOOM_MAX_MIPS 8
+#define BLOOM_KNEE 0.5f   // soft-threshold knee as a fraction of bloomThreshold
+
+// Quality picks the pyramid's base height, so cost stays bounded as output resolution grows
+typedef enum {
+    BLOOM_QUALITY_LOW = 0,
+    BLOOM_QUALITY_MEDIUM,
+    BLOOM_QUALITY_HIGH
+} BloomQuality;
+
+extern bool enableBloom;
+extern int bloomQuality;
+extern float bloomRadius;
+
+void InitializeBloom();
+void UnloadBloom();
+FgResource AddBloomPasses(FgResource source, int sourceWidth, int sourceHeight, int width, int height);
+int GetBloomMipCount();
+float GetBloomCutoff();
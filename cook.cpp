@@ -0,0 +1,44 @@
+#include "renderer.h"
+#include "scene_cache.h"
+#include "job_system.h"
+#include <stdio.h>
+
+// Offline cook: loads Sponza and the skybox faces the slow way once and writes the
+// binary scene cache the interactive app and the benchmark map at startup. Texture
+// encoding is spread over the job system workers.
+// Usage: raylib_cook [output path]   (run from the directory that holds resources/)
+int main(int argc, char** argv) {
+    const char* path = (argc > 1) ? argv[1] : SCENE_CACHE_PATH;
+
+    // raylib's glTF loader creates GL textures, so the cook needs a (hidden) context
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(64, 64, "Raylib - Cook");
+    InitializeJobSystem();
+
+    double startTime = GetTime();
+
+    Model model = LoadModel(sceneSourceFiles[0]);
+    Image faces[6];
+    for (int i = 0; i < 6; i++) {
+        faces[i] = LoadImage(sceneSourceFiles[1 + i]);
+        ImageFormat(&faces[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+    Image sun = LoadImage(sceneSourceFiles[7]);
+    ImageFormat(&sun, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    bool cooked = (model.meshCount > 0) && CookSceneCache(path, model, faces, sun);
+    if (cooked) {
+        printf("COOK: wrote %s in %.0f ms\n", path, (GetTime() - startTime) * 1000.0);
+    } else {
+        printf("COOK: failed to write %s\n", path);
+    }
+
+    for (int i = 0; i < 6; i++) UnloadImage(faces[i]);
+    UnloadImage(sun);
+    UnloadModel(model);
+    ShutdownJobSystem();
+    CloseWindow();
+
+    return cooked ? 0 : 1;
+}
@@ -0,0 +1,333 @@
+#include "deferred.h"
+#include "light_buffer.h"
+#include "draw_constants.h"
+#include "shadow_atlas.h"
+#include "profiler.h"
+#include "bloom.h"
+#include "dynamic_resolution.h"
+#include "light_probe.h"
+#include "irradiance_grid.h"
+#include "shader_cache.h"
+#include "external/glad.h"
+
+int shadingPath = SHADING_FORWARD;
+
+// Compact G-buffer: RGBA8 albedo, RG16F octahedral normal, sampled depth
+typedef struct {
+    unsigned int id;
+    unsigned int albedo;
+    unsigned int normal;
+    unsigned int depth;
+    int width;
+    int height;
+} GBuffer;
+
+static GBuffer gbuffer = { 0 };
+static unsigned int lightingFbo = 0;   // hdr + bright colors over the G-buffer depth
+static unsigned int shadingFbo = 0;    // hdr + bright colors alone, for the passes that sample the G-buffer depth
+static unsigned int brightFbo = 0;     // writes only the bright texture, for the bright-pass extract
+
+static Shader shGBuffer, shGBufferFlat, shDeferredAmbient, shDeferredLight, shBrightExtract;
+static Mesh lightVolume;
+static int locAmbientColor, locAmbientNormal, locAmbientInvViewProj, locAmbientRegionScale, locBrightCutoff;
+static int locLightViewProj, locLightInvViewProj, locLightScreenSize, locLightRegionScale, locLightEyePos, locLightSpec, locLightShine;
+
+// Load the G-buffer, lighting and bright-pass shaders and the light volume mesh
+void InitializeDeferred() {
+    // Normal-mapped variant and one for materials without a normal map, which would otherwise sample whatever sits in its slot
+    LoadWatchedShader(&shGBuffer, "resources/shaders/default.vs", "resources/shaders/gbuffer.fs", [](unsigned int) {
+        shGBuffer.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shGBuffer, "diffuseMap");
+        shGBuffer.locs[SHADER_LOC_MAP_NORMAL] = GetShaderLocation(shGBuffer, "normalMap");
+        BindDrawConstants(shGBuffer);
+    }, "#define HAS_NORMAL_MAP\n");
+    LoadWatchedShader(&shGBufferFlat, "resources/shaders/default.vs", "resources/shaders/gbuffer.fs", [](unsigned int) {
+        shGBufferFlat.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shGBufferFlat, "diffuseMap");
+        BindDrawConstants(shGBufferFlat);
+    });
+
+    LoadWatchedShader(&shDeferredAmbient, NULL, "resources/shaders/deferred_ambient.fs", [](unsigned int previousId) {
+        shDeferredAmbient.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shDeferredAmbient, "albedoMap");
+        shDeferredAmbient.locs[SHADER_LOC_MAP_NORMAL] = GetShaderLocation(shDeferredAmbient, "depthMap");
+        locAmbientColor = GetShaderLocation(shDeferredAmbient, "u_ambientColor");
+        locAmbientNormal = GetShaderLocation(shDeferredAmbient, "normalMap");
+        locAmbientInvViewProj = GetShaderLocation(shDeferredAmbient, "u_invViewProj");
+        locAmbientRegionScale = GetShaderLocation(shDeferredAmbient, "u_regionScale");
+        BindIrradianceGrid(shDeferredAmbient, previousId);
+    });
+
+    LoadWatchedShader(&shDeferredLight, "resources/shaders/deferred_light.vs", "resources/shaders/deferred_light.fs", [](unsigned int) {
+        locLightViewProj = GetShaderLocation(shDeferredLight, "u_viewProj");
+        locLightInvViewProj = GetShaderLocation(shDeferredLight, "u_invViewProj");
+        locLightScreenSize = GetShaderLocation(shDeferredLight, "u_screenSize");
+        locLightRegionScale = GetShaderLocation(shDeferredLight, "u_regionScale");
+        locLightEyePos = GetShaderLocation(shDeferredLight, "u_eyePos");
+        locLightSpec = GetShaderLocation(shDeferredLight, "u_specularColor");
+        locLightShine = GetShaderLocation(shDeferredLight, "u_shininess");
+        int units[3] = { 0, 1, 2 };
+        SetShaderValue(shDeferredLight, GetShaderLocation(shDeferredLight, "albedoMap"), &units[0], SHADER_UNIFORM_INT);
+        SetShaderValue(shDeferredLight, GetShaderLocation(shDeferredLight, "normalMap"), &units[1], SHADER_UNIFORM_INT);
+        SetShaderValue(shDeferredLight, GetShaderLocation(shDeferredLight, "depthMap"), &units[2], SHADER_UNIFORM_INT);
+        BindLightBuffer(shDeferredLight);
+        BindShadowAtlas(shDeferredLight);
+    }, GetLightCapacityDefine());
+
+    LoadWatchedShader(&shBrightExtract, NULL, "resources/shaders/bright_extract.fs", [](unsigned int) {
+        locBrightCutoff = GetShaderLocation(shBrightExtract, "u_bloomCutoff");
+    });
+
+    // Low-poly unit sphere, instanced once per light
+    lightVolume = GenMeshSphere(1.0f, 12, 12);
+    UploadMesh(&lightVolume, false);
+}
+
+void UnloadDeferred() {
+    UnloadWatchedShader(&shGBuffer);
+    UnloadWatchedShader(&shGBufferFlat);
+    UnloadWatchedShader(&shDeferredAmbient);
+    UnloadWatchedShader(&shDeferredLight);
+    UnloadWatchedShader(&shBrightExtract);
+    UnloadMesh(lightVolume);
+    UnloadGBuffer();
+}
+
+// Create G-buffer attachments with the same multi-attachment FBO setup as the HDR target
+void CreateGBuffer(int width, int height) {
+    UnloadGBuffer();
+
+    gbuffer.width = width;
+    gbuffer.height = height;
+    gbuffer.id = rlLoadFramebuffer();
+    gbuffer.albedo = rlLoadTexture(NULL, width, height, RL_PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+    gbuffer.depth = rlLoadTextureDepth(width, height, false);
+
+    // rlgl has no two-channel float format, so allocate the normal target directly
+    glGenTextures(1, &gbuffer.normal);
+    glBindTexture(GL_TEXTURE_2D, gbuffer.normal);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, width, height, 0, GL_RG, GL_HALF_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, gbuffer.id);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, gbuffer.id);
+        rlFramebufferAttach(gbuffer.id, gbuffer.albedo, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+        rlFramebufferAttach(gbuffer.id, gbuffer.normal, RL_ATTACHMENT_COLOR_CHANNEL1, RL_ATTACHMENT_TEXTURE2D, 0);
+        rlFramebufferAttach(gbuffer.id, gbuffer.depth, RL_ATTACHMENT_DEPTH, RL_ATTACHMENT_TEXTURE2D, 0);
+
+    // Activate two draw color buffers
+    rlActiveDrawBuffers(2);
+    if (!rlFramebufferComplete(gbuffer.id)) TraceLog(LOG_WARNING, "DEFERRED: G-buffer framebuffer is incomplete");
+
+    // Lighting target: same color attachments as hdr, depth shared with the G-buffer so
+    // sky, light volumes and orbs test against the scene without copying depth
+    lightingFbo = rlLoadFramebuffer();
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, lightingFbo);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, lightingFbo);
+        rlFramebufferAttach(lightingFbo, hdr.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+        if (!enableLeanPost) rlFramebufferAttach(lightingFbo, bright.texture.id, RL_ATTACHMENT_COLOR_CHANNEL1, RL_ATTACHMENT_TEXTURE2D, 0);
+        rlFramebufferAttach(lightingFbo, gbuffer.depth, RL_ATTACHMENT_DEPTH, RL_ATTACHMENT_TEXTURE2D, 0);
+        rlActiveDrawBuffers(GetSceneDrawBuffers());
+
+    // Same colors without the depth: a texture may not be sampled while attached to the bound framebuffer
+    shadingFbo = rlLoadFramebuffer();
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, shadingFbo);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, shadingFbo);
+        rlFramebufferAttach(shadingFbo, hdr.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+        if (!enableLeanPost) rlFramebufferAttach(shadingFbo, bright.texture.id, RL_ATTACHMENT_COLOR_CHANNEL1, RL_ATTACHMENT_TEXTURE2D, 0);
+        rlActiveDrawBuffers(GetSceneDrawBuffers());
+
+    // Bright-pass target aliases the bloom source texture
+    brightFbo = rlLoadFramebuffer();
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, brightFbo);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, brightFbo);
+        rlFramebufferAttach(brightFbo, bright.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+        rlActiveDrawBuffers(1);
+
+    // Unbind buffers
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, 0);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, 0);
+}
+
+// Depth of the deferred scene, for passes after lighting that reproject it
+Texture2D GetGBufferDepth() {
+    return Texture2D{ gbuffer.depth, gbuffer.width, gbuffer.height, 1, DEPTH_TEXTURE_FORMAT };
+}
+
+void UnloadGBuffer() {
+    if (gbuffer.id == 0) return;
+
+    // rlUnloadFramebuffer deletes the depth attachment, so detach the shared one first
+    rlFramebufferAttach(lightingFbo, 0, RL_ATTACHMENT_DEPTH, RL_ATTACHMENT_TEXTURE2D, 0);
+    rlUnloadFramebuffer(lightingFbo);
+    rlUnloadFramebuffer(shadingFbo);
+    rlUnloadFramebuffer(brightFbo);
+
+    rlUnloadFramebuffer(gbuffer.id);   // also frees gbuffer.depth
+    rlUnloadTexture(gbuffer.albedo);
+    glDeleteTextures(1, &gbuffer.normal);
+
+    gbuffer = GBuffer{ 0 };
+    lightingFbo = 0;
+    brightFbo = 0;
+}
+
+// Full-screen quad over the width x height render region of a G-buffer-sized target (flipped like every other post pass)
+static void DrawFullscreen(unsigned int textureId, int width, int height) {
+    Texture2D texture = { textureId, gbuffer.width, gbuffer.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    Rectangle rect = { 0, 0, (float)width, -(float)height };
+    DrawTextureRec(texture, rect, Vector2{ 0, 0 }, WHITE);
+}
+
+// Rasterize every light's range sphere in one instanced draw, adding its contribution to the HDR target
+static void DrawLightVolumes(Matrix view, Matrix projection, int width, int height) {
+    Matrix viewProj = MatrixMultiply(view, projection);
+    Matrix invViewProj = MatrixInvert(viewProj);
+    Vector2 screenSize = { (float)width, (float)height };
+    Vector2 regionScale = { (float)width / (float)gbuffer.width, (float)height / (float)gbuffer.height };
+
+    rlDrawRenderBatchActive();
+
+    rlEnableShader(shDeferredLight.id);
+    rlSetUniformMatrix(locLightViewProj, viewProj);
+    rlSetUniformMatrix(locLightInvViewProj, invViewProj);
+    rlSetUniform(locLightScreenSize, &screenSize, SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(locLightRegionScale, &regionScale, SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(locLightEyePos, &cam.position, SHADER_UNIFORM_VEC3, 1);
+    rlSetUniform(locLightSpec, &specularColor, SHADER_UNIFORM_VEC3, 1);
+    rlSetUniform(locLightShine, &shininess, SHADER_UNIFORM_FLOAT, 1);
+
+    unsigned int textures[3] = { gbuffer.albedo, gbuffer.normal, gbuffer.depth };
+    for (int i = 0; i < 3; i++) {
+        rlActiveTextureSlot(i);
+        rlEnableTexture(textures[i]);
+    }
+
+    // Back faces behind the stored depth cover exactly the lit pixels, even with the camera inside a volume.
+    // The target has no depth attachment, so the shader makes that test against the sampled depth.
+    rlEnableColorBlend();
+    rlSetBlendMode(RL_BLEND_ADD_COLORS);
+    rlSetCullFace(RL_CULL_FACE_FRONT);
+    rlDisableDepthTest();
+    rlDisableDepthMask();
+
+    rlEnableVertexArray(lightVolume.vaoId);
+    rlDrawVertexArrayInstanced(0, lightVolume.vertexCount, lightCount);
+    rlDisableVertexArray();
+
+    rlEnableDepthMask();
+    rlEnableDepthTest();
+    rlSetCullFace(RL_CULL_FACE_BACK);
+    rlSetBlendMode(RL_BLEND_ALPHA);
+
+    for (int i = 2; i >= 0; i--) {
+        rlActiveTextureSlot(i);
+        rlDisableTexture();
+    }
+    rlDisableShader();
+}
+
+// Visible meshes whose material has a normal map, and the rest, for the two G-buffer variants
+static VisibleMeshes gbufferMapped, gbufferFlat;
+
+static void SplitByNormalMap(const VisibleMeshes* visible) {
+    gbufferMapped.meshes.clear();
+    gbufferFlat.meshes.clear();
+    for (int i = 0; i < (int)visible->meshes.size(); i++) {
+        int mesh = visible->meshes[i];
+        Texture2D normalMap = sponzaModel.materials[sponzaModel.meshMaterial[mesh]].maps[MATERIAL_MAP_NORMAL].texture;
+        bool mapped = normalMap.id != 0 && normalMap.id != rlGetTextureIdDefault();
+        (mapped ? gbufferMapped : gbufferFlat).meshes.push_back(mesh);
+    }
+}
+
+// Deferred alternative to the forward HDR pass: fills hdr and bright for the same bloom/tonemap/FXAA chain
+// (hdr alone in lean post mode, where bloom thresholds it directly).
+// Renders into the currentWidth x currentHeight region of the targets (smaller under dynamic resolution).
+void RenderSceneDeferred(const VisibleMeshes* visible, int currentWidth, int currentHeight) {
+    // Geometry pass: visible Sponza meshes with the G-buffer shader swapped in
+    ProfilerBeginScope("gbuffer");
+    RenderTexture2D target = { gbuffer.id, { gbuffer.albedo, currentWidth, currentHeight, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 }, { 0 } };
+    BeginTextureMode(target);
+        rlActiveDrawBuffers(2);
+        ClearBackground(BLANK);
+        BeginSceneMode3D(cam);
+            SplitByNormalMap(visible);
+            DrawVisibleMeshes(sponzaModel, &gbufferMapped, &shGBuffer);
+            DrawVisibleMeshes(sponzaModel, &gbufferFlat, &shGBufferFlat);
+        EndMode3D();
+    EndTextureMode();
+    ProfilerEndScope();
+
+    ProfilerBeginScope("deferred_lighting");
+    RenderTexture2D lighting = GetSceneViewport(RenderTexture2D{ lightingFbo, hdr.texture, { 0 } });
+    BeginTextureMode(lighting);
+        rlActiveDrawBuffers(GetSceneDrawBuffers());
+        rlClearColor(0, 0, 0, 255);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        BeginSceneMode3D(cam);
+            // Draw skybox
+            BeginShaderMode(shSky);
+                rlDisableBackfaceCulling();
+                rlDisableDepthMask();
+                DrawModel(skyModel, cam.position, 1.0f, WHITE);
+                rlEnableBackfaceCulling();
+                rlEnableDepthMask();
+            EndShaderMode();
+
+            Matrix view = rlGetMatrixModelview();
+            Matrix projection = rlGetMatrixProjection();
+        EndMode3D();
+    EndTextureMode();
+
+    // Ambient term overwrites the sky wherever geometry was rasterized.
+    // This pass and the light volumes sample the G-buffer depth, so they draw without it attached.
+    RenderTexture2D shading = GetSceneViewport(RenderTexture2D{ shadingFbo, hdr.texture, { 0 } });
+    BeginTextureMode(shading);
+        rlActiveDrawBuffers(GetSceneDrawBuffers());
+        rlDisableDepthTest();
+        rlDisableDepthMask();
+        BeginShaderMode(shDeferredAmbient);
+            SetShaderValue(shDeferredAmbient, locAmbientColor, &ambientColor, SHADER_UNIFORM_VEC3);
+            Matrix invViewProj = MatrixInvert(MatrixMultiply(view, projection));
+            Vector2 regionScale = { (float)currentWidth / (float)gbuffer.width, (float)currentHeight / (float)gbuffer.height };
+            SetShaderValueMatrix(shDeferredAmbient, locAmbientInvViewProj, invViewProj);
+            SetShaderValue(shDeferredAmbient, locAmbientRegionScale, &regionScale, SHADER_UNIFORM_VEC2);
+            SetShaderValueTexture(shDeferredAmbient, shDeferredAmbient.locs[SHADER_LOC_MAP_NORMAL], Texture2D{ gbuffer.depth, currentWidth, currentHeight, 1, 0 });
+            SetShaderValueTexture(shDeferredAmbient, locAmbientNormal, Texture2D{ gbuffer.normal, currentWidth, currentHeight, 1, 0 });
+            DrawFullscreen(gbuffer.albedo, currentWidth, currentHeight);
+        EndShaderMode();
+        rlEnableDepthMask();
+        rlEnableDepthTest();
+
+        DrawLightVolumes(view, projection, currentWidth, currentHeight);
+    EndTextureMode();
+
+    // Bright pass from the accumulated lighting
+    if (!enableLeanPost) {
+        RenderTexture2D brightTarget = GetSceneViewport(RenderTexture2D{ brightFbo, bright.texture, { 0 } });
+        BeginTextureMode(brightTarget);
+            BeginShaderMode(shBrightExtract);
+                float bloomCutoff = GetBloomCutoff();
+                SetShaderValue(shBrightExtract, locBrightCutoff, &bloomCutoff, SHADER_UNIFORM_FLOAT);
+                DrawFullscreen(hdr.texture.id, currentWidth, currentHeight);
+            EndShaderMode();
+        EndTextureMode();
+    }
+
+    // Emissive orbs are forward shaded on top, writing both HDR and bright like the forward path
+    BeginTextureMode(lighting);
+        rlActiveDrawBuffers(GetSceneDrawBuffers());
+        BeginSceneMode3D(cam);
+            DrawLightOrbs();
+
+            // Draw light probe visualization (optional)
+            if (showLightProbe) {
+                DrawCubeWires(lightProbe.position, 0.5f, 0.5f, 0.5f, GREEN);
+            }
+        EndMode3D();
+    EndTextureMode();
+    ProfilerEndScope();
+}
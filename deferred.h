@@ -0,0 +1,18 @@
+#pragma once
+
+#include "renderer.h"
+#include "scene_culling.h"
+
+typedef enum {
+    SHADING_FORWARD = 0,
+    SHADING_DEFERRED
+} ShadingPath;
+
+extern int shadingPath;
+
+void InitializeDeferred();
+void UnloadDeferred();
+void CreateGBuffer(int width, int height);
+Texture2D GetGBufferDepth();
+void UnloadGBuffer();
+void RenderSceneDeferred(const VisibleMeshes* visible, int currentWidth, int currentHeight);
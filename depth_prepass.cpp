@@ -0,0 +1,105 @@
+#include "depth_prepass.h"
+#include "profiler.h"
+#include "draw_constants.h"
+#include "shader_cache.h"
+#include "external/glad.h"
+
+bool enableDepthPrepass = false;
+
+static Shader shDepth;
+
+// Samples-passed queries per set: [0] pre-pass, [1] lit pass
+static GLuint overdrawQueries[OVERDRAW_QUERY_BUFFERS][2];
+static bool overdrawPending[OVERDRAW_QUERY_BUFFERS];
+static bool overdrawPrepass[OVERDRAW_QUERY_BUFFERS];
+static int overdrawPixels[OVERDRAW_QUERY_BUFFERS];
+static int overdrawWriteSet = 0;
+static OverdrawStats overdrawStats = { 0 };
+
+void InitializeDepthPrepass() {
+    LoadWatchedShader(&shDepth, "resources/shaders/depth.vs", "resources/shaders/depth.fs", [](unsigned int) {
+        BindDrawConstants(shDepth);
+    });
+
+    glGenQueries(OVERDRAW_QUERY_BUFFERS * 2, &overdrawQueries[0][0]);
+    for (int i = 0; i < OVERDRAW_QUERY_BUFFERS; i++) overdrawPending[i] = false;
+    overdrawWriteSet = 0;
+    overdrawStats = OverdrawStats{ 0 };
+}
+
+void UnloadDepthPrepass() {
+    UnloadWatchedShader(&shDepth);
+    glDeleteQueries(OVERDRAW_QUERY_BUFFERS * 2, &overdrawQueries[0][0]);
+}
+
+// Read back a finished query set without stalling
+static void ResolveOverdraw(int set) {
+    if (!overdrawPending[set]) return;
+
+    GLint available = 0;
+    glGetQueryObjectiv(overdrawQueries[set][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    GLuint prepassSamples = 0;
+    GLuint litSamples = 0;
+    if (overdrawPrepass[set]) glGetQueryObjectuiv(overdrawQueries[set][0], GL_QUERY_RESULT, &prepassSamples);
+    glGetQueryObjectuiv(overdrawQueries[set][1], GL_QUERY_RESULT, &litSamples);
+
+    float pixels = (float)overdrawPixels[set];
+    overdrawStats.prepassActive = overdrawPrepass[set];
+    overdrawStats.prepassFragmentsPerPixel = (float)prepassSamples / pixels;
+    overdrawStats.litFragmentsPerPixel = (float)litSamples / pixels;
+    overdrawStats.pixels = overdrawPixels[set];
+    overdrawPending[set] = false;
+}
+
+// Draw Sponza's visible meshes into the current target (inside BeginMode3D), optionally laying down
+// depth first so the lit pass shades each visible pixel once. Measures fragments per pixel when requested.
+void DrawOpaqueScene(const VisibleMeshes* visible, int width, int height, bool measureOverdraw) {
+    // A set still in flight from two frames ago is dropped rather than waited on
+    int set = overdrawWriteSet;
+    if (measureOverdraw) {
+        for (int i = 0; i < OVERDRAW_QUERY_BUFFERS; i++) ResolveOverdraw(i);
+        overdrawPending[set] = false;
+    }
+
+    rlDrawRenderBatchActive();
+
+    if (enableDepthPrepass) {
+        ProfilerBeginScope("depth_prepass");
+        if (measureOverdraw) glBeginQuery(GL_SAMPLES_PASSED, overdrawQueries[set][0]);
+
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        DrawVisibleMeshes(sponzaModel, visible, &shDepth);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+        if (measureOverdraw) glEndQuery(GL_SAMPLES_PASSED);
+        ProfilerEndScope();
+
+        // Only the front-most fragment matches the stored depth
+        glDepthFunc(GL_EQUAL);
+        rlDisableDepthMask();
+    }
+
+    if (measureOverdraw) glBeginQuery(GL_SAMPLES_PASSED, overdrawQueries[set][1]);
+    BeginShaderMode(sh);
+        DrawVisibleMeshes(sponzaModel, visible, NULL);
+    EndShaderMode();
+    if (measureOverdraw) glEndQuery(GL_SAMPLES_PASSED);
+
+    if (enableDepthPrepass) {
+        glDepthFunc(GL_LEQUAL);
+        rlEnableDepthMask();
+    }
+
+    if (measureOverdraw) {
+        overdrawPending[set] = true;
+        overdrawPrepass[set] = enableDepthPrepass;
+        overdrawPixels[set] = width * height;
+        overdrawWriteSet = (set + 1) % OVERDRAW_QUERY_BUFFERS;
+    }
+}
+
+const OverdrawStats* GetOverdrawStats() {
+    return &overdrawStats;
+}
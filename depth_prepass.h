@@ -0,0 +1,21 @@
+#pragma once
+
+#include "renderer.h"
+#include "scene_culling.h"
+
+#define OVERDRAW_QUERY_BUFFERS 2   // occlusion query pairs in flight, read a frame or two late
+
+// Samples-passed counts of the last resolved main-camera frame, divided by the target's pixel count
+typedef struct {
+    bool prepassActive;            // whether the pre-pass ran in the measured frame
+    float prepassFragmentsPerPixel;
+    float litFragmentsPerPixel;    // fragments that ran phong.fs
+    int pixels;
+} OverdrawStats;
+
+extern bool enableDepthPrepass;
+
+void InitializeDepthPrepass();
+void UnloadDepthPrepass();
+void DrawOpaqueScene(const VisibleMeshes* visible, int width, int height, bool measureOverdraw);
+const OverdrawStats* GetOverdrawStats();
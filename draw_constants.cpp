@@ -0,0 +1,112 @@
+#include "draw_constants.h"
+#include "raymath.h"
+#include "external/glad.h"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DRAW_CONSTANTS_SSE 1
+#endif
+
+static GLuint ringUbo = 0;
+static int ringOffset = 0;
+static DrawConstantStats stats = { 0 };
+
+// a * b in column-vector terms. raylib's Matrix stores rows contiguously (m0 m4 m8 m12 first),
+// so each output row is a sum of b's rows scaled by one row of a.
+static Matrix MultiplyRows(const Matrix& a, const Matrix& b) {
+    const float* left = &a.m0;
+    const float* right = &b.m0;
+    Matrix result;
+    float* out = &result.m0;
+#ifdef DRAW_CONSTANTS_SSE
+    __m128 row0 = _mm_loadu_ps(right);
+    __m128 row1 = _mm_loadu_ps(right + 4);
+    __m128 row2 = _mm_loadu_ps(right + 8);
+    __m128 row3 = _mm_loadu_ps(right + 12);
+    for (int r = 0; r < 4; r++) {
+        const float* row = left + r * 4;
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), row0), _mm_mul_ps(_mm_set1_ps(row[1]), row1)),
+                                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[2]), row2), _mm_mul_ps(_mm_set1_ps(row[3]), row3)));
+        _mm_storeu_ps(out + r * 4, sum);
+    }
+#else
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) {
+            out[r * 4 + c] = left[r * 4] * right[c] + left[r * 4 + 1] * right[4 + c] +
+                             left[r * 4 + 2] * right[8 + c] + left[r * 4 + 3] * right[12 + c];
+        }
+    }
+#endif
+    return result;
+}
+
+void InitializeDrawConstants() {
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment <= 0) alignment = 256;
+    stats = DrawConstantStats{ 0 };
+    stats.blockStride = ((int)sizeof(DrawConstants) + alignment - 1) / alignment * alignment;
+
+    glGenBuffers(1, &ringUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ringUbo);
+    glBufferData(GL_UNIFORM_BUFFER, DRAW_CONSTANT_RING_BYTES, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    ringOffset = 0;
+}
+
+void UnloadDrawConstants() {
+    glDeleteBuffers(1, &ringUbo);
+    ringUbo = 0;
+}
+
+void BindDrawConstants(Shader shader) {
+    GLuint blockIndex = glGetUniformBlockIndex(shader.id, "DrawBlock");
+    if (blockIndex == GL_INVALID_INDEX) {
+        TraceLog(LOG_WARNING, "DRAW: [SHDR ID %i] DrawBlock not found", shader.id);
+        return;
+    }
+    glUniformBlockBinding(shader.id, blockIndex, DRAW_BLOCK_BINDING);
+}
+
+void PushDrawConstants(Matrix model, Matrix view, Matrix projection) {
+    DrawConstants constants;
+    constants.model = model;
+    constants.normal = MatrixTranspose(MatrixInvert(model));
+    constants.mvp = MultiplyRows(projection, MultiplyRows(view, model));
+
+    glBindBuffer(GL_UNIFORM_BUFFER, ringUbo);
+
+    // GL 3.3 has no persistent mapping: a full ring gets fresh storage from the driver instead,
+    // and the old one is freed once the draws reading it retire
+    if (ringOffset + stats.blockStride > DRAW_CONSTANT_RING_BYTES) {
+        glBufferData(GL_UNIFORM_BUFFER, DRAW_CONSTANT_RING_BYTES, NULL, GL_STREAM_DRAW);
+        ringOffset = 0;
+        stats.wraps++;
+    }
+
+    // Ranges are written once per ring pass, so the mapping never has to wait on the GPU
+    void* target = glMapBufferRange(GL_UNIFORM_BUFFER, ringOffset, sizeof(DrawConstants),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (target != NULL) {
+        memcpy(target, &constants, sizeof(DrawConstants));
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    } else {
+        glBufferSubData(GL_UNIFORM_BUFFER, ringOffset, sizeof(DrawConstants), &constants);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, DRAW_BLOCK_BINDING, ringUbo, ringOffset, sizeof(DrawConstants));
+    ringOffset += stats.blockStride;
+    stats.blocks++;
+    stats.bytes += (int)sizeof(DrawConstants);
+}
+
+void ResetDrawConstantStats() {
+    stats.blocks = 0;
+    stats.bytes = 0;
+}
+
+const DrawConstantStats* GetDrawConstantStats() {
+    return &stats;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "raylib.h"
+
+#define DRAW_BLOCK_BINDING 1                   // uniform buffer binding point of DrawBlock
+#define DRAW_CONSTANT_RING_BYTES (256 * 1024)  // orphaned and restarted when full
+
+// std140 DrawBlock, row_major so raylib's Matrix layout uploads as is
+typedef struct {
+    Matrix model;
+    Matrix normal;   // transpose(inverse(model)); the shaders use its upper 3x3
+    Matrix mvp;
+} DrawConstants;
+
+typedef struct {
+    int blocks;       // DrawBlocks written since the last reset
+    int bytes;
+    int wraps;        // times the ring was orphaned
+    int blockStride;  // sizeof(DrawConstants) rounded up to the driver's offset alignment
+} DrawConstantStats;
+
+void InitializeDrawConstants();
+void UnloadDrawConstants();
+
+// Point a shader's DrawBlock at the ring
+void BindDrawConstants(Shader shader);
+
+// Compute model, normal and model-view-projection on the CPU, append them to the ring and
+// bind that range; every draw until the next push reads them
+void PushDrawConstants(Matrix model, Matrix view, Matrix projection);
+
+void ResetDrawConstantStats();
+const DrawConstantStats* GetDrawConstantStats();
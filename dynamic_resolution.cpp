@@ -0,0 +1,200 @@
+#include "dynamic_resolution.h"
+#include "rlgl.h"
+#include "raymath.h"
+#include "shader_cache.h"
+#include <math.h>
+
+bool enableDynamicResolution = false;
+float resolutionBudgetMs = 16.0f;
+float resolutionMinScale = DYNRES_MIN_SCALE;
+
+static Shader shTemporal;
+static int locCurrentColor, locDepth, locRegionScale, locTexelSize, locJitter;
+static int locInvViewProj, locPrevViewProj, locFeedback, locHistoryValid;
+
+// Output-resolution history, ping-ponged: one is read while the other is written
+static RenderTexture2D history[2];
+static int historyIndex = 0;
+static bool historyValid = false;
+
+static DynamicResolutionState state = { 1.0f, 0, 0, 0.0, { 0.0f, 0.0f } };
+static unsigned int jitterIndex = 0;
+static Matrix viewProj;       // unjittered, this frame
+static Matrix prevViewProj;   // unjittered, the frame the history was resolved in
+
+void InitializeDynamicResolution() {
+    LoadWatchedShader(&shTemporal, NULL, "resources/shaders/temporal_upscale.fs", [](unsigned int) {
+        shTemporal.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shTemporal, "historyMap");
+        locCurrentColor = GetShaderLocation(shTemporal, "currentColor");
+        locDepth = GetShaderLocation(shTemporal, "depthMap");
+        locRegionScale = GetShaderLocation(shTemporal, "u_regionScale");
+        locTexelSize = GetShaderLocation(shTemporal, "u_texelSize");
+        locJitter = GetShaderLocation(shTemporal, "u_jitter");
+        locInvViewProj = GetShaderLocation(shTemporal, "u_invViewProj");
+        locPrevViewProj = GetShaderLocation(shTemporal, "u_prevViewProj");
+        locFeedback = GetShaderLocation(shTemporal, "u_feedback");
+        locHistoryValid = GetShaderLocation(shTemporal, "u_historyValid");
+    });
+}
+
+static void UnloadHistory() {
+    for (int i = 0; i < 2; i++) {
+        if (history[i].id == 0) continue;
+        rlUnloadFramebuffer(history[i].id);
+        rlUnloadTexture(history[i].texture.id);
+        history[i] = RenderTexture2D{ 0 };
+    }
+    historyValid = false;
+}
+
+static void CreateHistory(int width, int height) {
+    UnloadHistory();
+
+    for (int i = 0; i < 2; i++) {
+        RenderTexture2D* target = &history[i];
+        target->id = rlLoadFramebuffer();
+        target->texture.id = rlLoadTexture(NULL, width, height, RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16, 1);
+        target->texture.width = width;
+        target->texture.height = height;
+        target->texture.mipmaps = 1;
+        target->texture.format = RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16;
+
+        // Reprojected history lands between texels and may step off the edge
+        SetTextureFilter(target->texture, TEXTURE_FILTER_BILINEAR);
+        SetTextureWrap(target->texture, TEXTURE_WRAP_CLAMP);
+
+        rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, target->id);
+        rlBindFramebuffer(RL_READ_FRAMEBUFFER, target->id);
+            rlFramebufferAttach(target->id, target->texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+            rlActiveDrawBuffers(1);
+    }
+
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, 0);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, 0);
+}
+
+void UnloadDynamicResolution() {
+    UnloadWatchedShader(&shTemporal);
+    UnloadHistory();
+}
+
+// Radical inverse in the given base, in [0, 1)
+static float Halton(unsigned int index, unsigned int base) {
+    float result = 0.0f;
+    float fraction = 1.0f / (float)base;
+    while (index > 0) {
+        result += fraction * (float)(index % base);
+        index /= base;
+        fraction /= (float)base;
+    }
+    return result;
+}
+
+static Matrix SceneProjection(Camera3D camera, int width, int height) {
+    return MatrixPerspective(camera.fovy * DEG2RAD, (double)width / (double)height, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+}
+
+void UpdateDynamicResolution(int width, int height, double gpuFrameMs) {
+    if (!enableDynamicResolution) {
+        if (history[0].id != 0) UnloadHistory();
+        state.scale = 1.0f;
+        state.renderWidth = width;
+        state.renderHeight = height;
+        state.jitter = Vector2{ 0.0f, 0.0f };
+        state.smoothedGpuMs = gpuFrameMs;
+        return;
+    }
+
+    if (history[0].texture.width != width || history[0].texture.height != height) CreateHistory(width, height);
+
+    // Pixel count scales with scale^2, so steer by the square root of the budget ratio.
+    // Timings arrive a couple of frames late; smoothing and a step limit keep it from oscillating.
+    if (gpuFrameMs > 0.0) {
+        state.smoothedGpuMs = (state.smoothedGpuMs > 0.0) ? state.smoothedGpuMs * 0.9 + gpuFrameMs * 0.1 : gpuFrameMs;
+        double ratio = (double)resolutionBudgetMs / state.smoothedGpuMs;
+        if (fabs(1.0 - ratio) > DYNRES_DEADBAND) {
+            float target = state.scale * (float)sqrt(ratio);
+            float step = Clamp(target - state.scale, -DYNRES_SCALE_STEP, DYNRES_SCALE_STEP);
+            state.scale = Clamp(state.scale + step, resolutionMinScale, DYNRES_MAX_SCALE);
+        }
+    }
+
+    state.renderWidth = (int)((float)width * state.scale + 0.5f);
+    state.renderHeight = (int)((float)height * state.scale + 0.5f);
+    if (state.renderWidth < 1) state.renderWidth = 1;
+    if (state.renderHeight < 1) state.renderHeight = 1;
+
+    // Sub-pixel offset of the render grid, in NDC
+    jitterIndex = (jitterIndex + 1) % DYNRES_JITTER_PHASES;
+    state.jitter.x = (Halton(jitterIndex + 1, 2) - 0.5f) * 2.0f / (float)state.renderWidth;
+    state.jitter.y = (Halton(jitterIndex + 1, 3) - 0.5f) * 2.0f / (float)state.renderHeight;
+
+    prevViewProj = viewProj;
+    Matrix view = MatrixLookAt(cam.position, cam.target, cam.up);
+    viewProj = MatrixMultiply(view, SceneProjection(cam, state.renderWidth, state.renderHeight));
+}
+
+RenderTexture2D GetSceneViewport(RenderTexture2D target) {
+    target.texture.width = state.renderWidth;
+    target.texture.height = state.renderHeight;
+    return target;
+}
+
+void BeginSceneMode3D(Camera3D camera) {
+    BeginMode3D(camera);
+    if (!enableDynamicResolution) return;
+
+    // Same frustum BeginMode3D just loaded, then shifted in clip space by the jitter
+    Matrix projection = SceneProjection(camera, state.renderWidth, state.renderHeight);
+    projection = MatrixMultiply(projection, MatrixTranslate(state.jitter.x, state.jitter.y, 0.0f));
+    rlMatrixMode(RL_PROJECTION);
+    rlLoadIdentity();
+    rlMultMatrixf(MatrixToFloat(projection));
+    rlMatrixMode(RL_MODELVIEW);
+}
+
+FgResource AddTemporalUpscalePass(FgResource color, Texture2D colorTexture, Texture2D depthTexture, int width, int height) {
+    RenderTexture2D previous = history[historyIndex];
+    historyIndex = 1 - historyIndex;
+    RenderTexture2D current = history[historyIndex];
+
+    FgResource previousResource = FrameGraphImport("taa_history_prev", previous);
+    FgResource currentResource = FrameGraphImport("taa_history", current);
+
+    int pass = FrameGraphAddPass("temporal_upscale", FRAME_GRAPH_PHASE_OFFSCREEN, [=]() {
+        Vector2 regionScale = { (float)state.renderWidth / (float)colorTexture.width, (float)state.renderHeight / (float)colorTexture.height };
+        Vector2 texelSize = { 1.0f / (float)colorTexture.width, 1.0f / (float)colorTexture.height };
+        Vector2 jitterUv = { state.jitter.x * 0.5f, state.jitter.y * 0.5f };
+        Matrix invViewProj = MatrixInvert(viewProj);
+        float feedback = DYNRES_HISTORY_FEEDBACK;
+        int valid = historyValid ? 1 : 0;
+
+        BeginTextureMode(current);
+            BeginShaderMode(shTemporal);
+                SetShaderValue(shTemporal, locRegionScale, &regionScale, SHADER_UNIFORM_VEC2);
+                SetShaderValue(shTemporal, locTexelSize, &texelSize, SHADER_UNIFORM_VEC2);
+                SetShaderValue(shTemporal, locJitter, &jitterUv, SHADER_UNIFORM_VEC2);
+                SetShaderValueMatrix(shTemporal, locInvViewProj, invViewProj);
+                SetShaderValueMatrix(shTemporal, locPrevViewProj, prevViewProj);
+                SetShaderValue(shTemporal, locFeedback, &feedback, SHADER_UNIFORM_FLOAT);
+                SetShaderValue(shTemporal, locHistoryValid, &valid, SHADER_UNIFORM_INT);
+                SetShaderValueTexture(shTemporal, locCurrentColor, colorTexture);
+                SetShaderValueTexture(shTemporal, locDepth, depthTexture);
+                SetShaderValueTexture(shTemporal, shTemporal.locs[SHADER_LOC_MAP_DIFFUSE], previous.texture);
+                Rectangle rect = { 0, 0, (float)width, -(float)height };
+                DrawTextureRec(previous.texture, rect, Vector2{ 0, 0 }, WHITE);
+            EndShaderMode();
+        EndTextureMode();
+
+        historyValid = true;
+    });
+    FrameGraphRead(pass, color);
+    FrameGraphRead(pass, previousResource);
+    FrameGraphWrite(pass, currentResource);
+
+    return currentResource;
+}
+
+const DynamicResolutionState* GetDynamicResolutionState() {
+    return &state;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "renderer.h"
+#include "frame_graph.h"
+
+#define DYNRES_MIN_SCALE 0.5f
+#define DYNRES_MAX_SCALE 1.0f
+#define DYNRES_SCALE_STEP 0.05f      // largest per-frame change, GPU timings lag by a couple of frames
+#define DYNRES_DEADBAND 0.05f        // fraction of the budget treated as on target
+#define DYNRES_JITTER_PHASES 8       // Halton(2,3) sub-pixel offsets cycled by the jittered projection
+#define DYNRES_HISTORY_FEEDBACK 0.9f // weight of the reprojected history in the temporal resolve
+
+typedef struct {
+    float scale;           // render width / output width
+    int renderWidth;
+    int renderHeight;
+    double smoothedGpuMs;  // frame GPU time the controller steers by
+    Vector2 jitter;        // current projection offset in NDC
+} DynamicResolutionState;
+
+// The scene renders into the top-left region of the full-size targets, and a temporal upscale
+// reconstructs output resolution from the jittered low-resolution frames
+extern bool enableDynamicResolution;
+extern float resolutionBudgetMs;
+extern float resolutionMinScale;
+
+void InitializeDynamicResolution();
+void UnloadDynamicResolution();
+
+// Once per frame before the scene: pick the render scale from last resolved GPU frame time and advance the jitter
+void UpdateDynamicResolution(int width, int height, double gpuFrameMs);
+
+// target restricted to the render region, so BeginTextureMode sets the scaled viewport
+RenderTexture2D GetSceneViewport(RenderTexture2D target);
+// BeginMode3D for the main camera with the sub-pixel jitter applied to the projection
+void BeginSceneMode3D(Camera3D camera);
+
+// Resolve the scene color at render resolution into an output-resolution history target
+FgResource AddTemporalUpscalePass(FgResource color, Texture2D colorTexture, Texture2D depthTexture, int width, int height);
+
+const DynamicResolutionState* GetDynamicResolutionState();
@@ -0,0 +1,331 @@
+#include "frame_capture.h"
+#include "rlgl.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define CAPTURE_PNG_THREADS 3                       // PNG frames are independent files, deflate dominates
+#define CAPTURE_WAIT_NS 1000000000ull               // a fence wait long enough to mean the GPU is stuck
+
+typedef struct {
+    GLuint pbo;
+    GLsync fence;
+    int frame;
+} CaptureSlot;
+
+typedef struct {
+    int frame;
+    int width;
+    int height;
+    int buffer;   // staging buffer holding the bottom-up rows as read back
+} CaptureJob;
+
+static CaptureSlot ring[CAPTURE_RING_SIZE];
+static RenderTexture2D target = { 0 };   // the final passes draw here while capturing; read back, then shown
+static int ringWidth = 0;
+static int ringHeight = 0;
+static int ringHead = 0;      // next slot to read into
+static int ringPending = 0;   // readbacks in flight, oldest first, ending just before ringHead
+static int nextFrame = 0;
+
+// Staging buffers are only reallocated while the writers hold none of them
+static std::vector<std::unique_ptr<unsigned char[]>> staging;
+static std::mutex writerMutex;
+static std::condition_variable writerWake;     // a job arrived or the capture is stopping
+static std::condition_variable bufferFreed;
+static std::deque<CaptureJob> jobs;
+static std::vector<int> freeBuffers;
+static std::vector<std::thread> writerThreads;
+static bool writerStopping = false;
+static int writtenFrames = 0;
+static long long writtenBytes = 0;
+static int failedWrites = 0;
+
+// Owned by the writer thread in raw mode
+static FILE* rawFile = NULL;
+static int rawWidth = 0;
+static int rawHeight = 0;
+
+static std::string captureDirectory;
+static CaptureFormat captureFormat = CAPTURE_PNG;
+static double startTime = 0.0;
+static FrameCaptureStats stats = { 0 };
+
+// GL rows run bottom-up and the target's alpha is whatever the last pass left there
+static void PrepareRows(unsigned char* pixels, int width, int height) {
+    int rowBytes = width * 4;
+    std::vector<unsigned char> row(rowBytes);
+    for (int y = 0; y < height / 2; y++) {
+        unsigned char* top = pixels + (size_t)y * rowBytes;
+        unsigned char* bottom = pixels + (size_t)(height - 1 - y) * rowBytes;
+        memcpy(row.data(), top, rowBytes);
+        memcpy(top, bottom, rowBytes);
+        memcpy(bottom, row.data(), rowBytes);
+    }
+    size_t size = (size_t)rowBytes * height;
+    for (size_t i = 3; i < size; i += 4) pixels[i] = 255;
+}
+
+static bool WriteJob(const CaptureJob& job) {
+    unsigned char* pixels = staging[job.buffer].get();
+    PrepareRows(pixels, job.width, job.height);
+
+    if (captureFormat == CAPTURE_PNG) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/frame_%05d.png", captureDirectory.c_str(), job.frame);
+        Image image = { pixels, job.width, job.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        return ExportImage(image, path);
+    }
+
+    // A size change starts a new sequence file, since a raw stream has one frame size
+    if (rawFile == NULL || job.width != rawWidth || job.height != rawHeight) {
+        if (rawFile != NULL) fclose(rawFile);
+        char path[512];
+        snprintf(path, sizeof(path), "%s/frames_%dx%d.rgba", captureDirectory.c_str(), job.width, job.height);
+        rawFile = fopen(path, "wb");
+        rawWidth = job.width;
+        rawHeight = job.height;
+        if (rawFile == NULL) {
+            TraceLog(LOG_WARNING, "CAPTURE: Failed to open %s", path);
+            return false;
+        }
+        TraceLog(LOG_INFO, "CAPTURE: Writing %s (ffmpeg -f rawvideo -pix_fmt rgba -s %dx%d -i %s out.mp4)", path, job.width, job.height, path);
+    }
+    size_t size = (size_t)job.width * job.height * 4;
+    return fwrite(pixels, 1, size, rawFile) == size;
+}
+
+static void WriterMain() {
+    std::unique_lock<std::mutex> lock(writerMutex);
+    for (;;) {
+        writerWake.wait(lock, [] { return writerStopping || !jobs.empty(); });
+        if (jobs.empty()) break;   // stopping with nothing left
+
+        CaptureJob job = jobs.front();
+        jobs.pop_front();
+        lock.unlock();
+        bool written = WriteJob(job);
+        lock.lock();
+
+        freeBuffers.push_back(job.buffer);
+        if (written) {
+            writtenFrames++;
+            writtenBytes += (long long)job.width * job.height * 4;
+        } else {
+            failedWrites++;
+        }
+        bufferFreed.notify_one();
+    }
+}
+
+static int FrameBytes() {
+    return ringWidth * ringHeight * 4;
+}
+
+// Map the oldest readback and queue it for the writer. Without wait, gives up if its copy has not landed yet.
+static bool HarvestOldest(bool wait) {
+    CaptureSlot* slot = &ring[(ringHead - ringPending + CAPTURE_RING_SIZE) % CAPTURE_RING_SIZE];
+    GLenum result = glClientWaitSync(slot->fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? CAPTURE_WAIT_NS : 0);
+    if (!wait && result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) return false;
+    glDeleteSync(slot->fence);
+    slot->fence = NULL;
+    ringPending--;
+
+    int buffer;
+    {
+        std::unique_lock<std::mutex> lock(writerMutex);
+        if (freeBuffers.empty()) {
+            stats.writerWaits++;
+            bufferFreed.wait(lock, [] { return !freeBuffers.empty(); });
+        }
+        buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+    }
+
+    double copyStart = GetTime();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, FrameBytes(), GL_MAP_READ_BIT);
+    if (pixels != NULL) {
+        memcpy(staging[buffer].get(), pixels, FrameBytes());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    stats.copyMs = (GetTime() - copyStart) * 1000.0;
+
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        if (pixels != NULL) {
+            jobs.push_back(CaptureJob{ slot->frame, ringWidth, ringHeight, buffer });
+        } else {
+            freeBuffers.push_back(buffer);
+            failedWrites++;
+        }
+    }
+    writerWake.notify_one();
+    return true;
+}
+
+static void DrainRing() {
+    while (ringPending > 0) HarvestOldest(true);
+}
+
+static void ReleaseRing() {
+    DrainRing();
+    for (int i = 0; i < CAPTURE_RING_SIZE; i++) {
+        glDeleteBuffers(1, &ring[i].pbo);
+        ring[i].pbo = 0;
+    }
+    if (target.id != 0) UnloadRenderTexture(target);
+    target = RenderTexture2D{ 0 };
+    ringWidth = 0;
+    ringHeight = 0;
+}
+
+// Size the PBOs and the staging pool for one frame size; as many staging frames as fit the queue budget
+static void AllocateRing(int width, int height) {
+    DrainRing();
+    ringWidth = width;
+    ringHeight = height;
+    ringHead = 0;
+    for (int i = 0; i < CAPTURE_RING_SIZE; i++) {
+        if (ring[i].pbo == 0) glGenBuffers(1, &ring[i].pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, ring[i].pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, FrameBytes(), NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (target.id != 0) UnloadRenderTexture(target);
+    target = LoadRenderTexture(width, height);
+
+    std::unique_lock<std::mutex> lock(writerMutex);
+    bufferFreed.wait(lock, [] { return freeBuffers.size() == staging.size(); });
+    int count = CAPTURE_QUEUE_BYTES / FrameBytes();
+    if (count < 2) count = 2;
+    staging.clear();
+    freeBuffers.clear();
+    for (int i = 0; i < count; i++) {
+        staging.emplace_back(new unsigned char[FrameBytes()]);
+        freeBuffers.push_back(i);
+    }
+    stats.stagingBuffers = count;
+    stats.width = width;
+    stats.height = height;
+}
+
+bool StartFrameCapture(const char* directory, CaptureFormat format) {
+    StopFrameCapture();
+
+    MakeDirectory(directory);
+    if (!DirectoryExists(directory)) {
+        TraceLog(LOG_WARNING, "CAPTURE: Could not create %s", directory);
+        return false;
+    }
+
+    captureDirectory = directory;
+    captureFormat = format;
+    stats = FrameCaptureStats{ 0 };
+    stats.active = true;
+    stats.format = format;
+    nextFrame = 0;
+    writtenFrames = 0;
+    writtenBytes = 0;
+    failedWrites = 0;
+    writerStopping = false;
+
+    int threadCount = 1;
+    if (format == CAPTURE_PNG) {
+        int hardwareThreads = (int)std::thread::hardware_concurrency();
+        threadCount = (hardwareThreads > 2) ? hardwareThreads - 2 : 1;
+        if (threadCount > CAPTURE_PNG_THREADS) threadCount = CAPTURE_PNG_THREADS;
+    }
+    for (int i = 0; i < threadCount; i++) writerThreads.emplace_back(WriterMain);
+
+    startTime = GetTime();
+    TraceLog(LOG_INFO, "CAPTURE: Started %s capture into %s", format == CAPTURE_PNG ? "PNG" : "raw", directory);
+    return true;
+}
+
+void StopFrameCapture() {
+    if (!stats.active) return;
+
+    ReleaseRing();
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writerStopping = true;
+    }
+    writerWake.notify_all();
+    for (std::thread& thread : writerThreads) thread.join();
+    writerThreads.clear();
+    if (rawFile != NULL) {
+        fclose(rawFile);
+        rawFile = NULL;
+    }
+
+    GetFrameCaptureStats();
+    stats.active = false;
+    staging.clear();
+    freeBuffers.clear();
+    TraceLog(LOG_INFO, "CAPTURE: %d frames written to %s, %.1f frames/s", stats.framesWritten, captureDirectory.c_str(), stats.captureFps);
+}
+
+bool IsFrameCaptureActive() {
+    return stats.active;
+}
+
+bool BeginCapturedFrame(int width, int height) {
+    if (!stats.active) return false;
+    if (width != ringWidth || height != ringHeight) AllocateRing(width, height);
+    BeginTextureMode(target);
+    return true;
+}
+
+void EndCapturedFrame() {
+    EndTextureMode();
+
+    // Hand every readback that has landed to the writer; the ring only waits when it is full
+    while (ringPending > 0 && HarvestOldest(false)) {}
+    if (ringPending == CAPTURE_RING_SIZE) {
+        stats.ringWaits++;
+        HarvestOldest(true);
+    }
+
+    CaptureSlot* slot = &ring[ringHead];
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target.id);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+    glReadPixels(0, 0, ringWidth, ringHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->frame = nextFrame++;
+
+    // Show the captured frame; the window's own backbuffer is never read
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, ringWidth, ringHeight, 0, 0, ringWidth, ringHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    ringHead = (ringHead + 1) % CAPTURE_RING_SIZE;
+    ringPending++;
+    stats.framesIssued++;
+}
+
+const FrameCaptureStats* GetFrameCaptureStats() {
+    if (!stats.active) return &stats;
+
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        stats.framesWritten = writtenFrames;
+        stats.framesQueued = (int)jobs.size();
+        stats.bytesWritten = writtenBytes;
+        stats.failedWrites = failedWrites;
+    }
+    stats.framesInFlight = ringPending;
+    double elapsed = GetTime() - startTime;
+    stats.captureFps = (elapsed > 0.0) ? stats.framesWritten / elapsed : 0.0;
+    return &stats;
+}
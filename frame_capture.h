@@ -0,0 +1,52 @@
+#pragma once
+
+#include "raylib.h"
+
+// Frame capture: the finished frame is drawn into an offscreen target, copied into a ring of pixel
+// buffer objects and fenced, then mapped a few frames later once the copy has landed, so the GPU
+// never waits on the CPU.
+// A writer thread flips, encodes and writes frames out of a fixed pool of staging buffers.
+#define CAPTURE_RING_SIZE 3                     // readbacks in flight on the GPU
+#define CAPTURE_QUEUE_BYTES (128 * 1024 * 1024) // staging memory shared by frames waiting for the writer
+#define CAPTURE_DIR "captures"
+
+typedef enum {
+    CAPTURE_PNG = 0,   // one numbered PNG per frame
+    CAPTURE_RAW        // top-down RGBA8 frames appended to one file, for muxing into video
+} CaptureFormat;
+
+typedef struct {
+    bool active;
+    int format;
+    int width;
+    int height;
+    int framesIssued;      // readbacks queued on the GPU
+    int framesWritten;
+    int framesInFlight;    // in the PBO ring
+    int framesQueued;      // mapped and waiting for the writer
+    int stagingBuffers;
+    int ringWaits;         // the oldest readback had not landed when its PBO was needed again
+    int writerWaits;       // every staging buffer was still waiting for the writer
+    int failedWrites;
+    long long bytesWritten;    // frame pixels handed to disk, before PNG compression
+    double captureFps;     // frames written per second since the capture started
+    double copyMs;         // main-thread copy out of the mapped PBO, last frame
+} FrameCaptureStats;
+
+// Start writing frames into directory (created if missing); numbering restarts at 0
+bool StartFrameCapture(const char* directory, CaptureFormat format);
+
+// Finish outstanding readbacks, wait for the writer and stop
+void StopFrameCapture();
+
+bool IsFrameCaptureActive();
+
+// While capturing, bind the capture target for the final pass and return true. The window's
+// backbuffer is undefined to read back (a hidden window may not have one), so frames are
+// taken from this offscreen target instead.
+bool BeginCapturedFrame(int width, int height);
+
+// Queue the target's readback and blit it onto the default framebuffer; call before the UI is drawn
+void EndCapturedFrame();
+
+const FrameCaptureStats* GetFrameCaptureStats();
@@ -0,0 +1,332 @@
+#include "frame_graph.h"
+#include "profiler.h"
+#include "external/glad.h"
+#include <string.h>
+
+typedef enum {
+    RESOURCE_TRANSIENT = 0,
+    RESOURCE_IMPORTED,
+    RESOURCE_VIRTUAL      // ordering/dependency only, never allocated
+} ResourceKind;
+
+typedef struct {
+    char name[PROFILER_NAME_LENGTH];
+    int kind;
+    int width;
+    int height;
+    int format;
+    RenderTexture2D target;
+    int poolEntry;
+    int firstPass;        // first and last surviving pass touching it, -1 if unused
+    int lastPass;
+    bool needed;
+} FgResourceNode;
+
+typedef struct {
+    char name[PROFILER_NAME_LENGTH];
+    int phase;
+    std::function<void()> execute;
+    FgResource reads[FRAME_GRAPH_MAX_PASS_IO];
+    FgResource writes[FRAME_GRAPH_MAX_PASS_IO];
+    int readCount;
+    int writeCount;
+    bool alive;
+} FgPass;
+
+// Pooled render target: one color texture and its FBO, reused by size and format
+typedef struct {
+    RenderTexture2D target;
+    int width;
+    int height;
+    int format;
+    bool inUse;
+    unsigned int lastUsedFrame;
+} PoolEntry;
+
+static FgResourceNode resources[FRAME_GRAPH_MAX_RESOURCES];
+static int resourceCount = 0;
+static FgPass passes[FRAME_GRAPH_MAX_PASSES];
+static int passCount = 0;
+
+static PoolEntry pool[FRAME_GRAPH_POOL_SIZE];
+static int poolCount = 0;
+static unsigned int frameIndex = 0;
+static FrameGraphStats stats = { 0 };
+
+static long long BytesPerPixel(int format) {
+    switch (format) {
+        case PIXELFORMAT_UNCOMPRESSED_R16G16B16A16: return 8;
+        case PIXELFORMAT_UNCOMPRESSED_R32G32B32A32: return 16;
+        case PIXELFORMAT_UNCOMPRESSED_R16G16B16: return 6;
+        case PIXELFORMAT_UNCOMPRESSED_R32G32B32: return 12;
+        case PIXELFORMAT_UNCOMPRESSED_R16: return 2;
+        case PIXELFORMAT_UNCOMPRESSED_R32: return 4;
+        case FRAME_GRAPH_FORMAT_R11G11B10F: return 4;
+        default: return 4;
+    }
+}
+
+static RenderTexture2D LoadPoolTarget(int width, int height, int format) {
+    RenderTexture2D target = { 0 };
+    target.id = rlLoadFramebuffer();
+    target.texture.id = LoadColorTexture(width, height, format);
+    target.texture.width = width;
+    target.texture.height = height;
+    target.texture.mipmaps = 1;
+    target.texture.format = format;
+
+    // Post passes sample between texels and at the edges
+    SetTextureFilter(target.texture, TEXTURE_FILTER_BILINEAR);
+    SetTextureWrap(target.texture, TEXTURE_WRAP_CLAMP);
+
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, target.id);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, target.id);
+        rlFramebufferAttach(target.id, target.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+        rlActiveDrawBuffers(1);
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, 0);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, 0);
+
+    return target;
+}
+
+static void UnloadPoolEntry(int index) {
+    rlUnloadFramebuffer(pool[index].target.id);
+    rlUnloadTexture(pool[index].target.texture.id);
+    pool[index] = pool[--poolCount];
+}
+
+// Free target of matching size and format, or a new one
+static int AcquirePoolEntry(int width, int height, int format) {
+    for (int i = 0; i < poolCount; i++) {
+        PoolEntry* entry = &pool[i];
+        if (!entry->inUse && entry->width == width && entry->height == height && entry->format == format) {
+            entry->inUse = true;
+            entry->lastUsedFrame = frameIndex;
+            return i;
+        }
+    }
+
+    if (poolCount == FRAME_GRAPH_POOL_SIZE) {
+        TraceLog(LOG_WARNING, "FRAMEGRAPH: render target pool exhausted (%i targets)", FRAME_GRAPH_POOL_SIZE);
+        return -1;
+    }
+
+    PoolEntry* entry = &pool[poolCount];
+    entry->target = LoadPoolTarget(width, height, format);
+    entry->width = width;
+    entry->height = height;
+    entry->format = format;
+    entry->inUse = true;
+    entry->lastUsedFrame = frameIndex;
+    stats.allocations++;
+    return poolCount++;
+}
+
+void InitializeFrameGraph() {
+    poolCount = 0;
+    resourceCount = 0;
+    passCount = 0;
+    frameIndex = 0;
+}
+
+void UnloadFrameGraph() {
+    while (poolCount > 0) UnloadPoolEntry(poolCount - 1);
+    for (int i = 0; i < passCount; i++) passes[i].execute = nullptr;
+    resourceCount = 0;
+    passCount = 0;
+}
+
+// Start a new frame: drop last frame's declarations and evict targets nobody asked for lately
+void FrameGraphBegin() {
+    frameIndex++;
+    for (int i = 0; i < passCount; i++) passes[i].execute = nullptr;
+    resourceCount = 0;
+    passCount = 0;
+
+    for (int i = poolCount - 1; i >= 0; i--) {
+        pool[i].inUse = false;
+        if (frameIndex - pool[i].lastUsedFrame > FRAME_GRAPH_EVICT_FRAMES) UnloadPoolEntry(i);
+    }
+    stats.allocations = 0;
+}
+
+static FgResource AddResource(const char* name, int kind) {
+    if (resourceCount == FRAME_GRAPH_MAX_RESOURCES) {
+        TraceLog(LOG_WARNING, "FRAMEGRAPH: too many resources, dropping %s", name);
+        return -1;
+    }
+
+    FgResourceNode* resource = &resources[resourceCount];
+    memset(resource, 0, sizeof(*resource));
+    strncpy(resource->name, name, PROFILER_NAME_LENGTH - 1);
+    resource->kind = kind;
+    resource->poolEntry = -1;
+    resource->firstPass = -1;
+    resource->lastPass = -1;
+    return resourceCount++;
+}
+
+// External target owned by the caller (e.g. the HDR buffer, or a zero target for the backbuffer)
+FgResource FrameGraphImport(const char* name, RenderTexture2D target) {
+    FgResource handle = AddResource(name, RESOURCE_IMPORTED);
+    if (handle >= 0) resources[handle].target = target;
+    return handle;
+}
+
+// Target that only lives between its first writer and last reader, backed by the pool
+FgResource FrameGraphCreate(const char* name, int width, int height, int format) {
+    FgResource handle = AddResource(name, RESOURCE_TRANSIENT);
+    if (handle >= 0) {
+        resources[handle].width = width;
+        resources[handle].height = height;
+        resources[handle].format = format;
+    }
+    return handle;
+}
+
+// Dependency without storage, e.g. CPU-built data a later pass consumes
+FgResource FrameGraphCreateVirtual(const char* name) {
+    return AddResource(name, RESOURCE_VIRTUAL);
+}
+
+int FrameGraphAddPass(const char* name, int phase, std::function<void()> execute) {
+    if (passCount == FRAME_GRAPH_MAX_PASSES) {
+        TraceLog(LOG_WARNING, "FRAMEGRAPH: too many passes, dropping %s", name);
+        return -1;
+    }
+
+    FgPass* pass = &passes[passCount];
+    strncpy(pass->name, name, PROFILER_NAME_LENGTH - 1);
+    pass->name[PROFILER_NAME_LENGTH - 1] = '\0';
+    pass->phase = phase;
+    pass->execute = execute;
+    pass->readCount = 0;
+    pass->writeCount = 0;
+    pass->alive = false;
+    return passCount++;
+}
+
+void FrameGraphRead(int pass, FgResource resource) {
+    if (pass < 0 || resource < 0 || passes[pass].readCount == FRAME_GRAPH_MAX_PASS_IO) return;
+    passes[pass].reads[passes[pass].readCount++] = resource;
+}
+
+void FrameGraphWrite(int pass, FgResource resource) {
+    if (pass < 0 || resource < 0 || passes[pass].writeCount == FRAME_GRAPH_MAX_PASS_IO) return;
+    passes[pass].writes[passes[pass].writeCount++] = resource;
+}
+
+// Size of one full pass over a resource's color texture; imported targets report theirs, virtual ones have none
+static long long TargetBytes(const FgResourceNode* resource) {
+    if (resource->kind == RESOURCE_TRANSIENT) return (long long)resource->width * resource->height * BytesPerPixel(resource->format);
+    if (resource->kind == RESOURCE_IMPORTED) {
+        const Texture2D* texture = &resource->target.texture;
+        return (long long)texture->width * texture->height * BytesPerPixel(texture->format);
+    }
+    return 0;
+}
+
+// Cull passes whose outputs nobody consumes, then derive each transient's lifetime
+void FrameGraphCompile() {
+    // Backwards sweep: a pass survives if it writes an imported target or something a surviving pass reads
+    for (int r = 0; r < resourceCount; r++) resources[r].needed = (resources[r].kind == RESOURCE_IMPORTED);
+    for (int p = passCount - 1; p >= 0; p--) {
+        FgPass* pass = &passes[p];
+        pass->alive = false;
+        for (int w = 0; w < pass->writeCount; w++) {
+            if (resources[pass->writes[w]].needed) pass->alive = true;
+        }
+        if (!pass->alive) continue;
+        for (int r = 0; r < pass->readCount; r++) resources[pass->reads[r]].needed = true;
+    }
+
+    stats.passes = passCount;
+    stats.passesCulled = 0;
+    stats.transientResources = 0;
+    stats.unaliasedBytes = 0;
+    stats.targetBytes = 0;
+
+    for (int p = 0; p < passCount; p++) {
+        FgPass* pass = &passes[p];
+        if (!pass->alive) {
+            stats.passesCulled++;
+            continue;
+        }
+
+        FgResource touched[FRAME_GRAPH_MAX_PASS_IO * 2];
+        int touchedCount = 0;
+        for (int r = 0; r < pass->readCount; r++) touched[touchedCount++] = pass->reads[r];
+        for (int w = 0; w < pass->writeCount; w++) touched[touchedCount++] = pass->writes[w];
+        for (int i = 0; i < touchedCount; i++) {
+            FgResourceNode* resource = &resources[touched[i]];
+            if (resource->firstPass < 0) resource->firstPass = p;
+            resource->lastPass = p;
+            stats.targetBytes += TargetBytes(resource);
+        }
+    }
+
+    for (int r = 0; r < resourceCount; r++) {
+        FgResourceNode* resource = &resources[r];
+        if (resource->kind != RESOURCE_TRANSIENT || resource->firstPass < 0) continue;
+        stats.transientResources++;
+        stats.unaliasedBytes += (long long)resource->width * resource->height * BytesPerPixel(resource->format);
+    }
+}
+
+// Run one phase in declaration order. Targets are taken from the pool right before their first pass
+// and returned right after their last, so later resources of the same size alias the memory.
+void FrameGraphExecute(int phase) {
+    for (int p = 0; p < passCount; p++) {
+        FgPass* pass = &passes[p];
+        if (!pass->alive || pass->phase != phase) continue;
+
+        for (int r = 0; r < resourceCount; r++) {
+            FgResourceNode* resource = &resources[r];
+            if (resource->kind != RESOURCE_TRANSIENT || resource->firstPass != p) continue;
+            resource->poolEntry = AcquirePoolEntry(resource->width, resource->height, resource->format);
+            if (resource->poolEntry >= 0) resource->target = pool[resource->poolEntry].target;
+        }
+
+        ProfilerBeginScope(pass->name);
+        pass->execute();
+        ProfilerEndScope();
+
+        for (int r = 0; r < resourceCount; r++) {
+            FgResourceNode* resource = &resources[r];
+            if (resource->kind != RESOURCE_TRANSIENT || resource->lastPass != p || resource->poolEntry < 0) continue;
+            pool[resource->poolEntry].inUse = false;
+            resource->poolEntry = -1;
+        }
+    }
+
+    stats.pooledTargets = poolCount;
+    stats.pooledBytes = 0;
+    for (int i = 0; i < poolCount; i++) {
+        stats.pooledBytes += (long long)pool[i].width * pool[i].height * BytesPerPixel(pool[i].format);
+    }
+}
+
+RenderTexture2D FrameGraphTarget(FgResource resource) {
+    if (resource < 0 || resource >= resourceCount) return RenderTexture2D{ 0 };
+    return resources[resource].target;
+}
+
+const FrameGraphStats* GetFrameGraphStats() {
+    return &stats;
+}
+
+unsigned int LoadColorTexture(int width, int height, int format) {
+    if (format != FRAME_GRAPH_FORMAT_R11G11B10F) return rlLoadTexture(NULL, width, height, format, 1);
+
+    // Same sampling state rlLoadTexture leaves a single-level texture in
+    unsigned int id = 0;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return id;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "renderer.h"
+#include <functional>
+
+#define FRAME_GRAPH_MAX_RESOURCES 64
+#define FRAME_GRAPH_MAX_PASSES 48
+#define FRAME_GRAPH_MAX_PASS_IO 8
+#define FRAME_GRAPH_POOL_SIZE 32
+#define FRAME_GRAPH_EVICT_FRAMES 8   // pooled targets unused this long are freed (old sizes after a resize)
+#define FRAME_GRAPH_FORMAT_R11G11B10F 0x100   // packed float color, no alpha; rlgl has no pixel format for it
+
+// Passes run in two phases: offscreen work in RenderScene, then the passes that draw to the
+// backbuffer from DrawFinalPass (between BeginDrawing/EndDrawing)
+typedef enum {
+    FRAME_GRAPH_PHASE_OFFSCREEN = 0,
+    FRAME_GRAPH_PHASE_PRESENT
+} FrameGraphPhase;
+
+typedef int FgResource;   // handle into the current frame's resource table
+
+// Transient render-target pool and pass culling results of the last compiled frame
+typedef struct {
+    int passes;
+    int passesCulled;
+    int transientResources;
+    int pooledTargets;
+    int allocations;          // targets created this frame
+    long long pooledBytes;    // VRAM held by the pool
+    long long unaliasedBytes; // VRAM if every transient resource had its own target
+    long long targetBytes;    // color target traffic: every read and write of a surviving pass counts the whole target
+} FrameGraphStats;
+
+void InitializeFrameGraph();
+void UnloadFrameGraph();
+
+// Build: declare resources and passes, then compile to cull and assign pooled targets
+void FrameGraphBegin();
+FgResource FrameGraphImport(const char* name, RenderTexture2D target);
+FgResource FrameGraphCreate(const char* name, int width, int height, int format);
+FgResource FrameGraphCreateVirtual(const char* name);
+int FrameGraphAddPass(const char* name, int phase, std::function<void()> execute);
+void FrameGraphRead(int pass, FgResource resource);
+void FrameGraphWrite(int pass, FgResource resource);
+void FrameGraphCompile();
+
+// Execute the surviving passes of one phase; targets are valid inside a pass's execute callback
+void FrameGraphExecute(int phase);
+RenderTexture2D FrameGraphTarget(FgResource resource);
+const FrameGraphStats* GetFrameGraphStats();
+
+// Color texture in any format a graph target may use, including FRAME_GRAPH_FORMAT_R11G11B10F
+unsigned int LoadColorTexture(int width, int height, int format);
@@ -0,0 +1,364 @@
+#include "irradiance_grid.h"
+#include "light_probe.h"
+#include "light_buffer.h"
+#include "job_system.h"
+#include "mapped_file.h"
+#include "external/glad.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define IRRADIANCE_SSE 1
+#endif
+
+#define IRRADIANCE_PROBE_TEXELS (PROBE_FACES * IRRADIANCE_BAKE_RESOLUTION * IRRADIANCE_BAKE_RESOLUTION)
+#define IRRADIANCE_PROBE_FLOATS (IRRADIANCE_SH_COEFFICIENTS * 3)
+
+// File layout: this header, then RGB floats ordered [coefficient][z][y][x], so the data block
+// uploads as one 3D texture with the nine coefficient volumes stacked along z
+typedef struct {
+    char magic[4];            // "IRRG"
+    uint32_t version;
+    int32_t dims[3];
+    float boundsMin[3];       // first and last probe positions
+    float boundsMax[3];
+    uint32_t coefficients;    // per probe and channel
+    uint32_t dataOffset;      // bytes from the start of the file
+} IrradianceFileHeader;
+
+// Uniform locations of a shader that samples the grid
+typedef struct {
+    unsigned int shaderId;
+    int locMin;
+    int locMax;
+    int locDims;
+    int locStrength;
+} IrradianceShader;
+
+bool enableIrradianceGrid = true;
+float irradianceStrength = 1.0f;
+bool irradianceBakeRequested = false;
+
+static unsigned int gridTexture = 0;   // RGB16F, X x Y x (Z * 9)
+static IrradianceGridInfo info = { 0 };
+static std::vector<IrradianceShader> irradianceShaders;   // the base program, every lit variant and their reloads
+static bool baking = false;
+
+// Per texel of a probe in readback order (row, face, column), the nine SH basis values times the texel's solid angle
+static std::vector<float> projectionWeights;
+
+// Direction through a point of a cubemap face (u, v in [-1, 1]), in GL's face orientation like probe_prefilter.fs
+static Vector3 FaceDirection(int face, float u, float v) {
+    switch (face) {
+        case 0: return Vector3{ 1.0f, -v, -u };
+        case 1: return Vector3{ -1.0f, -v, u };
+        case 2: return Vector3{ u, 1.0f, v };
+        case 3: return Vector3{ u, -1.0f, -v };
+        case 4: return Vector3{ u, -v, 1.0f };
+        default: return Vector3{ -u, -v, -1.0f };
+    }
+}
+
+// Real L2 SH basis, same constants and order as SampleIrradiance in phong.fs
+static void EvaluateSH(Vector3 n, float* basis) {
+    basis[0] = 0.282095f;
+    basis[1] = 0.488603f * n.y;
+    basis[2] = 0.488603f * n.z;
+    basis[3] = 0.488603f * n.x;
+    basis[4] = 1.092548f * n.x * n.y;
+    basis[5] = 1.092548f * n.y * n.z;
+    basis[6] = 0.315392f * (3.0f * n.z * n.z - 1.0f);
+    basis[7] = 1.092548f * n.x * n.z;
+    basis[8] = 0.546274f * (n.x * n.x - n.y * n.y);
+}
+
+static void BuildProjectionWeights() {
+    const int res = IRRADIANCE_BAKE_RESOLUTION;
+    projectionWeights.resize((size_t)IRRADIANCE_PROBE_TEXELS * IRRADIANCE_SH_COEFFICIENTS);
+
+    double total = 0.0;
+    float* weights = projectionWeights.data();
+    for (int y = 0; y < res; y++) {
+        for (int face = 0; face < PROBE_FACES; face++) {
+            for (int x = 0; x < res; x++) {
+                float u = ((float)x + 0.5f) / (float)res * 2.0f - 1.0f;
+                float v = ((float)y + 0.5f) / (float)res * 2.0f - 1.0f;
+
+                // Texels shrink in solid angle away from the face centre
+                float solidAngle = 1.0f / powf(1.0f + u * u + v * v, 1.5f);
+                EvaluateSH(Vector3Normalize(FaceDirection(face, u, v)), weights);
+                for (int k = 0; k < IRRADIANCE_SH_COEFFICIENTS; k++) weights[k] *= solidAngle;
+                weights += IRRADIANCE_SH_COEFFICIENTS;
+                total += solidAngle;
+            }
+        }
+    }
+
+    // Normalize so the texels cover exactly the sphere
+    float scale = (float)(4.0 * PI / total);
+    for (size_t i = 0; i < projectionWeights.size(); i++) projectionWeights[i] *= scale;
+}
+
+// Project one probe's RGBA texels onto SH and convolve with the cosine lobe
+static void ProjectProbe(const float* texels, float* coefficients) {
+    const float* weights = projectionWeights.data();
+
+#ifdef IRRADIANCE_SSE
+    // One texel's RGBA in a register, scaled by each basis weight: four channels per multiply-add
+    __m128 sum[IRRADIANCE_SH_COEFFICIENTS];
+    for (int k = 0; k < IRRADIANCE_SH_COEFFICIENTS; k++) sum[k] = _mm_setzero_ps();
+    for (int t = 0; t < IRRADIANCE_PROBE_TEXELS; t++, weights += IRRADIANCE_SH_COEFFICIENTS) {
+        __m128 color = _mm_loadu_ps(texels + t * 4);
+        for (int k = 0; k < IRRADIANCE_SH_COEFFICIENTS; k++) {
+            sum[k] = _mm_add_ps(sum[k], _mm_mul_ps(color, _mm_set1_ps(weights[k])));
+        }
+    }
+    for (int k = 0; k < IRRADIANCE_SH_COEFFICIENTS; k++) {
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, sum[k]);
+        memcpy(&coefficients[k * 3], lanes, sizeof(float) * 3);
+    }
+#else
+    for (int i = 0; i < IRRADIANCE_PROBE_FLOATS; i++) coefficients[i] = 0.0f;
+    for (int t = 0; t < IRRADIANCE_PROBE_TEXELS; t++, weights += IRRADIANCE_SH_COEFFICIENTS) {
+        const float* color = texels + t * 4;
+        for (int k = 0; k < IRRADIANCE_SH_COEFFICIENTS; k++) {
+            coefficients[k * 3 + 0] += color[0] * weights[k];
+            coefficients[k * 3 + 1] += color[1] * weights[k];
+            coefficients[k * 3 + 2] += color[2] * weights[k];
+        }
+    }
+#endif
+
+    // Clamped cosine per band (pi, 2pi/3, pi/4) with the Lambertian 1/pi folded in,
+    // so evaluating the result gives the radiance a white diffuse surface reflects
+    static const float bandScale[IRRADIANCE_SH_COEFFICIENTS] = {
+        1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f
+    };
+    for (int k = 0; k < IRRADIANCE_SH_COEFFICIENTS; k++) {
+        for (int c = 0; c < 3; c++) coefficients[k * 3 + c] *= bandScale[k];
+    }
+}
+
+void InitializeIrradianceGrid() {
+    LoadIrradianceGrid(IRRADIANCE_GRID_PATH);
+}
+
+void UnloadIrradianceGrid() {
+    if (gridTexture != 0) glDeleteTextures(1, &gridTexture);
+    gridTexture = 0;
+    info.loaded = false;
+}
+
+void BindIrradianceGrid(Shader shader, unsigned int replaceId) {
+    IrradianceShader* entry = NULL;
+    for (int i = 0; i < (int)irradianceShaders.size() && replaceId != 0; i++) {
+        if (irradianceShaders[i].shaderId == replaceId) entry = &irradianceShaders[i];
+    }
+    if (entry == NULL) {
+        irradianceShaders.push_back(IrradianceShader{});
+        entry = &irradianceShaders.back();
+    }
+
+    int unit = IRRADIANCE_TEXTURE_UNIT;
+    SetShaderValue(shader, GetShaderLocation(shader, "u_irradianceGrid"), &unit, SHADER_UNIFORM_INT);
+
+    entry->shaderId = shader.id;
+    entry->locMin = GetShaderLocation(shader, "u_irradianceMin");
+    entry->locMax = GetShaderLocation(shader, "u_irradianceMax");
+    entry->locDims = GetShaderLocation(shader, "u_irradianceDims");
+    entry->locStrength = GetShaderLocation(shader, "u_irradianceStrength");
+}
+
+void UpdateIrradianceGridUniforms() {
+    // Strength 0 makes the shaders skip the lookup entirely
+    float strength = (enableIrradianceGrid && info.loaded && !baking) ? irradianceStrength : 0.0f;
+    Vector3 dims = { (float)info.dims[0], (float)info.dims[1], (float)info.dims[2] };
+
+    for (int i = 0; i < (int)irradianceShaders.size(); i++) {
+        Shader shader = { irradianceShaders[i].shaderId, NULL };
+        SetShaderValue(shader, irradianceShaders[i].locMin, &info.boundsMin, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader, irradianceShaders[i].locMax, &info.boundsMax, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader, irradianceShaders[i].locDims, &dims, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader, irradianceShaders[i].locStrength, &strength, SHADER_UNIFORM_FLOAT);
+    }
+
+    glActiveTexture(GL_TEXTURE0 + IRRADIANCE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_3D, gridTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+bool LoadIrradianceGrid(const char* path) {
+    double startTime = GetTime();
+
+    MappedFile file;
+    if (!MapFile(path, &file)) {
+        TraceLog(LOG_INFO, "IRRADIANCE: No baked grid at %s, using flat ambient", path);
+        return false;
+    }
+
+    const IrradianceFileHeader* header = (const IrradianceFileHeader*)file.data;
+    bool valid = file.size >= sizeof(IrradianceFileHeader) && memcmp(header->magic, "IRRG", 4) == 0 &&
+                 header->version == IRRADIANCE_FILE_VERSION && header->coefficients == IRRADIANCE_SH_COEFFICIENTS;
+    size_t probeCount = 1;
+    for (int i = 0; valid && i < 3; i++) {
+        valid = header->dims[i] >= 2 && header->dims[i] <= 256;
+        probeCount *= valid ? (size_t)header->dims[i] : 0;
+    }
+    if (valid) {
+        size_t dataBytes = probeCount * IRRADIANCE_PROBE_FLOATS * sizeof(float);
+        valid = header->dataOffset >= sizeof(IrradianceFileHeader) && header->dataOffset % sizeof(float) == 0 &&
+                file.size >= header->dataOffset + dataBytes;
+    }
+    if (!valid) {
+        TraceLog(LOG_WARNING, "IRRADIANCE: %s is not a version %d grid, bake it again", path, IRRADIANCE_FILE_VERSION);
+        UnmapFile(&file);
+        return false;
+    }
+
+    // Uploaded straight from the mapped pages, with no intermediate copy of the file
+    if (gridTexture == 0) glGenTextures(1, &gridTexture);
+    glBindTexture(GL_TEXTURE_3D, gridTexture);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB16F, header->dims[0], header->dims[1], header->dims[2] * IRRADIANCE_SH_COEFFICIENTS,
+                 0, GL_RGB, GL_FLOAT, file.data + header->dataOffset);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    info.loaded = true;
+    memcpy(info.dims, header->dims, sizeof(info.dims));
+    info.boundsMin = Vector3{ header->boundsMin[0], header->boundsMin[1], header->boundsMin[2] };
+    info.boundsMax = Vector3{ header->boundsMax[0], header->boundsMax[1], header->boundsMax[2] };
+    info.fileBytes = file.size;
+    UnmapFile(&file);
+    info.loadMs = (GetTime() - startTime) * 1000.0;
+
+    TraceLog(LOG_INFO, "IRRADIANCE: Loaded %dx%dx%d probe grid from %s in %.2f ms",
+             info.dims[0], info.dims[1], info.dims[2], path, info.loadMs);
+    return true;
+}
+
+bool BakeIrradianceGrid(const char* path) {
+    double startTime = GetTime();
+    const int res = IRRADIANCE_BAKE_RESOLUTION;
+    const int probeCount = IRRADIANCE_GRID_X * IRRADIANCE_GRID_Y * IRRADIANCE_GRID_Z;
+
+    // Keep the outer probes just inside the walls, floor and roof line
+    BoundingBox bounds = GetModelBoundingBox(sponzaModel);
+    Vector3 inset = Vector3Scale(Vector3Subtract(bounds.max, bounds.min), 0.02f);
+    Vector3 gridMin = Vector3Add(bounds.min, inset);
+    Vector3 gridMax = Vector3Subtract(bounds.max, inset);
+
+    if (projectionWeights.empty()) BuildProjectionWeights();
+
+    // HDR face target with depth, and an atlas (one row of six faces per probe) read back once per batch
+    RenderTexture2D faceTarget = LoadRenderTexture(res, res);
+    UnloadTexture(faceTarget.texture);
+    faceTarget.texture.id = rlLoadTexture(NULL, res, res, RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16, 1);
+    faceTarget.texture.format = RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16;
+    rlFramebufferAttach(faceTarget.id, faceTarget.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+
+    int atlasWidth = PROBE_FACES * res;
+    int atlasHeight = IRRADIANCE_BAKE_BATCH * res;
+    unsigned int atlasTexture = rlLoadTexture(NULL, atlasWidth, atlasHeight, RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16, 1);
+    unsigned int atlasFbo = rlLoadFramebuffer();
+    rlFramebufferAttach(atlasFbo, atlasTexture, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+
+    // The grid must not light its own bake; lights are captured as they are right now
+    baking = true;
+    UpdateIrradianceGridUniforms();
+    UpdateLightBuffer(lights, lightCount);
+
+    std::vector<float> readback((size_t)atlasWidth * atlasHeight * 4);
+    std::vector<float> coefficients((size_t)probeCount * IRRADIANCE_PROBE_FLOATS);
+    double projectMs = 0.0;
+
+    for (int first = 0; first < probeCount; first += IRRADIANCE_BAKE_BATCH) {
+        int count = (probeCount - first < IRRADIANCE_BAKE_BATCH) ? probeCount - first : IRRADIANCE_BAKE_BATCH;
+
+        for (int i = 0; i < count; i++) {
+            int probe = first + i;
+            int x = probe % IRRADIANCE_GRID_X;
+            int y = (probe / IRRADIANCE_GRID_X) % IRRADIANCE_GRID_Y;
+            int z = probe / (IRRADIANCE_GRID_X * IRRADIANCE_GRID_Y);
+            Vector3 position = {
+                Lerp(gridMin.x, gridMax.x, (float)x / (float)(IRRADIANCE_GRID_X - 1)),
+                Lerp(gridMin.y, gridMax.y, (float)y / (float)(IRRADIANCE_GRID_Y - 1)),
+                Lerp(gridMin.z, gridMax.z, (float)z / (float)(IRRADIANCE_GRID_Z - 1))
+            };
+
+            for (int face = 0; face < PROBE_FACES; face++) {
+                RenderProbeFace(GetProbeFaceCamera(position, face), faceTarget);
+
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, faceTarget.id);
+                glBindTexture(GL_TEXTURE_2D, atlasTexture);
+                glCopyTexSubImage2D(GL_TEXTURE_2D, 0, face * res, i * res, 0, 0, res, res);
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }
+        }
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, atlasFbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, atlasWidth, count * res, GL_RGBA, GL_FLOAT, readback.data());
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+        // A probe's faces are atlas rows [i * res, (i + 1) * res), already in projection-weight order
+        double projectStart = GetTime();
+        ParallelFor(count, 1, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                ProjectProbe(&readback[(size_t)i * IRRADIANCE_PROBE_TEXELS * 4], &coefficients[(size_t)(first + i) * IRRADIANCE_PROBE_FLOATS]);
+            }
+        });
+        projectMs += (GetTime() - projectStart) * 1000.0;
+    }
+
+    baking = false;
+    UnloadRenderTexture(faceTarget);
+    rlUnloadFramebuffer(atlasFbo);
+    rlUnloadTexture(atlasTexture);
+
+    // Probe-major to coefficient-major, matching the texture layout
+    std::vector<float> data(coefficients.size());
+    for (int probe = 0; probe < probeCount; probe++) {
+        for (int k = 0; k < IRRADIANCE_SH_COEFFICIENTS; k++) {
+            memcpy(&data[((size_t)k * probeCount + probe) * 3], &coefficients[(size_t)probe * IRRADIANCE_PROBE_FLOATS + k * 3], sizeof(float) * 3);
+        }
+    }
+
+    IrradianceFileHeader header = { { 'I', 'R', 'R', 'G' }, IRRADIANCE_FILE_VERSION,
+                                    { IRRADIANCE_GRID_X, IRRADIANCE_GRID_Y, IRRADIANCE_GRID_Z },
+                                    { gridMin.x, gridMin.y, gridMin.z }, { gridMax.x, gridMax.y, gridMax.z },
+                                    IRRADIANCE_SH_COEFFICIENTS, (uint32_t)sizeof(IrradianceFileHeader) };
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "IRRADIANCE: Could not write %s", path);
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(data.data(), sizeof(float), data.size(), file) == data.size();
+    fclose(file);
+    if (!written) {
+        TraceLog(LOG_WARNING, "IRRADIANCE: Short write to %s", path);
+        return false;
+    }
+
+    double bakeMs = (GetTime() - startTime) * 1000.0;
+    TraceLog(LOG_INFO, "IRRADIANCE: Baked %d probes (%d faces) in %.1f ms, %.1f ms projecting on %d threads",
+             probeCount, probeCount * PROBE_FACES, bakeMs, projectMs, GetJobWorkerCount() + 1);
+
+    bool loaded = LoadIrradianceGrid(path);
+    info.bakeMs = bakeMs;
+    info.projectMs = projectMs;
+    return loaded;
+}
+
+const IrradianceGridInfo* GetIrradianceGridInfo() {
+    return &info;
+}
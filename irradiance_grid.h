@@ -0,0 +1,42 @@
+#pragma once
+
+#include "renderer.h"
+
+// Probe grid over Sponza's bounds, baked offline into L2 spherical harmonics
+#define IRRADIANCE_GRID_X 16
+#define IRRADIANCE_GRID_Y 8
+#define IRRADIANCE_GRID_Z 8
+#define IRRADIANCE_SH_COEFFICIENTS 9
+#define IRRADIANCE_BAKE_RESOLUTION 32   // face size of each baked probe
+#define IRRADIANCE_BAKE_BATCH 64        // probes rendered before one readback
+#define IRRADIANCE_FILE_VERSION 1
+#define IRRADIANCE_GRID_PATH "resources/irradiance_grid.bin"
+
+// Texture unit reserved for the grid volume (below the cluster buffers)
+#define IRRADIANCE_TEXTURE_UNIT 13
+
+typedef struct {
+    bool loaded;
+    int dims[3];
+    Vector3 boundsMin;
+    Vector3 boundsMax;
+    size_t fileBytes;
+    double loadMs;       // map, validate and upload
+    double bakeMs;       // last bake in this session, 0 if none
+    double projectMs;    // CPU share of the last bake
+} IrradianceGridInfo;
+
+extern bool enableIrradianceGrid;
+extern float irradianceStrength;
+extern bool irradianceBakeRequested;   // set by the UI, handled between frames
+
+// Load the baked grid if the file exists
+void InitializeIrradianceGrid();
+void UnloadIrradianceGrid();
+void BindIrradianceGrid(Shader shader, unsigned int replaceId = 0);   // replaceId: a reloaded program's predecessor
+// Bind the volume and refresh the grid uniforms of every bound shader
+void UpdateIrradianceGridUniforms();
+// Render, project and save the grid, then load the result
+bool BakeIrradianceGrid(const char* path);
+bool LoadIrradianceGrid(const char* path);
+const IrradianceGridInfo* GetIrradianceGridInfo();
@@ -0,0 +1,108 @@
+#include "job_system.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+static std::vector<std::thread> workers;
+static std::mutex jobMutex;
+static std::mutex submitMutex;
+static std::condition_variable jobStart;
+static std::condition_variable jobDone;
+
+// Current job, published under jobMutex
+static const std::function<void(int, int)>* jobFn = nullptr;
+static int jobCount = 0;
+static int jobGrain = 1;
+static std::atomic<int> jobNext(0);
+static int jobActiveWorkers = 0;
+static unsigned int jobGeneration = 0;
+static bool quitting = false;
+
+static thread_local bool insideJob = false;
+
+static void RunChunks() {
+    insideJob = true;
+    for (;;) {
+        int begin = jobNext.fetch_add(jobGrain);
+        if (begin >= jobCount) break;
+        int end = (begin + jobGrain < jobCount) ? begin + jobGrain : jobCount;
+        (*jobFn)(begin, end);
+    }
+    insideJob = false;
+}
+
+static void WorkerMain() {
+    unsigned int seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobStart.wait(lock, [&] { return quitting || jobGeneration != seenGeneration; });
+            if (quitting) return;
+            seenGeneration = jobGeneration;
+        }
+
+        RunChunks();
+
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if (--jobActiveWorkers == 0) jobDone.notify_one();
+    }
+}
+
+void InitializeJobSystem(int workerCount) {
+    if (!workers.empty()) return;
+
+    if (workerCount <= 0) {
+        int hardwareThreads = (int)std::thread::hardware_concurrency();
+        workerCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 0;
+    }
+
+    quitting = false;
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(WorkerMain);
+    }
+}
+
+void ShutdownJobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        quitting = true;
+    }
+    jobStart.notify_all();
+    for (std::thread& worker : workers) worker.join();
+    workers.clear();
+}
+
+int GetJobWorkerCount() {
+    return (int)workers.size();
+}
+
+void ParallelFor(int count, int grainSize, const std::function<void(int begin, int end)>& fn) {
+    if (count <= 0) return;
+    if (grainSize < 1) grainSize = 1;
+
+    // Single chunk, no workers, or called from inside a job: no point waking anyone
+    if (workers.empty() || count <= grainSize || insideJob) {
+        fn(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(submitMutex);
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobFn = &fn;
+        jobCount = count;
+        jobGrain = grainSize;
+        jobNext.store(0);
+        jobActiveWorkers = (int)workers.size();
+        jobGeneration++;
+    }
+    jobStart.notify_all();
+
+    RunChunks();
+
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobDone.wait(lock, [] { return jobActiveWorkers == 0; });
+    jobFn = nullptr;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <functional>
+
+// Persistent worker threads for data-parallel loops. The calling thread joins in,
+// so ParallelFor returns only when every index has been processed.
+void InitializeJobSystem(int workerCount = 0);   // 0 = one worker per extra hardware thread
+void ShutdownJobSystem();
+int GetJobWorkerCount();
+
+// Calls fn(begin, end) over [0, count) in chunks of grainSize; runs inline when nested or too small
+void ParallelFor(int count, int grainSize, const std::function<void(int begin, int end)>& fn);
@@ -0,0 +1,351 @@
+#include "light_animation.h"
+#include "job_system.h"
+#include <math.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define LIGHT_ANIMATION_SSE 1
+#endif
+
+#define LIGHT_ANIMATION_GRAIN 1024   // slots per job chunk
+#define TWO_PI 6.28318531f
+#define HALF_PI 1.57079633f
+
+// Closed loop down the nave for path lights, first point repeated so segment i ends at i + 1
+#define PATH_POINTS 4
+static const float pathX[PATH_POINTS + 1] = { -9.0f, 9.0f, 9.0f, -9.0f, -9.0f };
+static const float pathZ[PATH_POINTS + 1] = { -1.3f, -1.3f, 1.3f, 1.3f, -1.3f };
+
+bool enableLightAnimation = false;
+
+static LightSoA sceneLights;
+static bool sceneLightsBuilt = false;
+static std::vector<int> dirtyLights;
+static LightAnimationStats stats = { 0 };
+
+// sin(x) for any x: wrap to [-pi, pi], parabola fit plus one refinement step (error below 0.001)
+static inline float FastSin(float x) {
+    x -= TWO_PI * floorf(x * (1.0f / TWO_PI) + 0.5f);
+    float y = 1.27323954f * x - 0.405284735f * x * fabsf(x);
+    return 0.225f * (y * fabsf(y) - y) + y;
+}
+
+static inline float WrapPhase(float phase, float period) {
+    return phase - period * floorf(phase / period);
+}
+
+#ifdef LIGHT_ANIMATION_SSE
+// SSE2 has no floor; truncate and step down where that rounded up
+static inline __m128 Floor4(__m128 v) {
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128 Abs4(__m128 v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+static inline __m128 FastSin4(__m128 x) {
+    x = _mm_sub_ps(x, _mm_mul_ps(_mm_set1_ps(TWO_PI), Floor4(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.0f / TWO_PI)), _mm_set1_ps(0.5f)))));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.27323954f), x), _mm_mul_ps(_mm_set1_ps(0.405284735f), _mm_mul_ps(x, Abs4(x))));
+    return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.225f), _mm_sub_ps(_mm_mul_ps(y, Abs4(y)), y)), y);
+}
+
+static inline __m128 WrapPhase4(__m128 phase, float period) {
+    __m128 p = _mm_set1_ps(period);
+    return _mm_sub_ps(phase, _mm_mul_ps(p, Floor4(_mm_mul_ps(phase, _mm_set1_ps(1.0f / period)))));
+}
+#endif
+
+// Kernels work on slots [begin, end) of one motion; the SIMD loops leave the last few slots to the scalar tail
+static void OrbitKernel(LightSoA* set, int begin, int end, float dt, bool simd) {
+    int i = begin;
+#ifdef LIGHT_ANIMATION_SSE
+    if (simd) {
+        __m128 step = _mm_set1_ps(dt);
+        for (; i + 4 <= end; i += 4) {
+            __m128 phase = WrapPhase4(_mm_add_ps(_mm_loadu_ps(&set->phase[i]), _mm_mul_ps(_mm_loadu_ps(&set->speed[i]), step)), TWO_PI);
+            __m128 amplitude = _mm_loadu_ps(&set->amplitude[i]);
+            __m128 s = FastSin4(phase);
+            __m128 c = FastSin4(_mm_add_ps(phase, _mm_set1_ps(HALF_PI)));
+            __m128 bob = FastSin4(_mm_add_ps(phase, phase));
+            _mm_storeu_ps(&set->phase[i], phase);
+            _mm_storeu_ps(&set->x[i], _mm_add_ps(_mm_loadu_ps(&set->anchorX[i]), _mm_mul_ps(amplitude, c)));
+            _mm_storeu_ps(&set->y[i], _mm_add_ps(_mm_loadu_ps(&set->anchorY[i]), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.25f), amplitude), bob)));
+            _mm_storeu_ps(&set->z[i], _mm_add_ps(_mm_loadu_ps(&set->anchorZ[i]), _mm_mul_ps(amplitude, s)));
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        float phase = WrapPhase(set->phase[i] + set->speed[i] * dt, TWO_PI);
+        float amplitude = set->amplitude[i];
+        set->phase[i] = phase;
+        set->x[i] = set->anchorX[i] + amplitude * FastSin(phase + HALF_PI);
+        set->y[i] = set->anchorY[i] + 0.25f * amplitude * FastSin(phase + phase);
+        set->z[i] = set->anchorZ[i] + amplitude * FastSin(phase);
+    }
+}
+
+// Intensity dips by up to amplitude of the base; sin(p) * sin(3p) keeps the pattern periodic in the wrapped phase
+static void FlickerKernel(LightSoA* set, int begin, int end, float dt, bool simd) {
+    int i = begin;
+#ifdef LIGHT_ANIMATION_SSE
+    if (simd) {
+        __m128 step = _mm_set1_ps(dt);
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 one = _mm_set1_ps(1.0f);
+        for (; i + 4 <= end; i += 4) {
+            __m128 phase = WrapPhase4(_mm_add_ps(_mm_loadu_ps(&set->phase[i]), _mm_mul_ps(_mm_loadu_ps(&set->speed[i]), step)), TWO_PI);
+            __m128 wave = _mm_mul_ps(FastSin4(phase), FastSin4(_mm_mul_ps(phase, _mm_set1_ps(3.0f))));
+            __m128 dip = _mm_mul_ps(_mm_loadu_ps(&set->amplitude[i]), _mm_add_ps(half, _mm_mul_ps(half, wave)));
+            _mm_storeu_ps(&set->phase[i], phase);
+            _mm_storeu_ps(&set->intensity[i], _mm_mul_ps(_mm_loadu_ps(&set->baseIntensity[i]), _mm_sub_ps(one, dip)));
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        float phase = WrapPhase(set->phase[i] + set->speed[i] * dt, TWO_PI);
+        float wave = FastSin(phase) * FastSin(3.0f * phase);
+        set->phase[i] = phase;
+        set->intensity[i] = set->baseIntensity[i] * (1.0f - set->amplitude[i] * (0.5f + 0.5f * wave));
+    }
+}
+
+// Phase counts path segments; the waypoint lookup is a gather, so only the interpolation is vectorized
+static void PathKernel(LightSoA* set, int begin, int end, float dt, bool simd) {
+    int i = begin;
+#ifdef LIGHT_ANIMATION_SSE
+    if (simd) {
+        __m128 step = _mm_set1_ps(dt);
+        for (; i + 4 <= end; i += 4) {
+            __m128 phase = WrapPhase4(_mm_add_ps(_mm_loadu_ps(&set->phase[i]), _mm_mul_ps(_mm_loadu_ps(&set->speed[i]), step)), (float)PATH_POINTS);
+            _mm_storeu_ps(&set->phase[i], phase);
+
+            float segment[4];
+            _mm_storeu_ps(segment, Floor4(phase));
+            int s[4];
+            for (int lane = 0; lane < 4; lane++) s[lane] = std::min(std::max((int)segment[lane], 0), PATH_POINTS - 1);
+
+            __m128 t = _mm_sub_ps(phase, _mm_setr_ps((float)s[0], (float)s[1], (float)s[2], (float)s[3]));
+            __m128 x0 = _mm_setr_ps(pathX[s[0]], pathX[s[1]], pathX[s[2]], pathX[s[3]]);
+            __m128 x1 = _mm_setr_ps(pathX[s[0] + 1], pathX[s[1] + 1], pathX[s[2] + 1], pathX[s[3] + 1]);
+            __m128 z0 = _mm_setr_ps(pathZ[s[0]], pathZ[s[1]], pathZ[s[2]], pathZ[s[3]]);
+            __m128 z1 = _mm_setr_ps(pathZ[s[0] + 1], pathZ[s[1] + 1], pathZ[s[2] + 1], pathZ[s[3] + 1]);
+            _mm_storeu_ps(&set->x[i], _mm_add_ps(x0, _mm_mul_ps(_mm_sub_ps(x1, x0), t)));
+            _mm_storeu_ps(&set->y[i], _mm_loadu_ps(&set->anchorY[i]));
+            _mm_storeu_ps(&set->z[i], _mm_add_ps(_mm_add_ps(z0, _mm_mul_ps(_mm_sub_ps(z1, z0), t)), _mm_loadu_ps(&set->amplitude[i])));
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        float phase = WrapPhase(set->phase[i] + set->speed[i] * dt, (float)PATH_POINTS);
+        int s = std::min(std::max((int)floorf(phase), 0), PATH_POINTS - 1);
+        float t = phase - (float)s;
+        set->phase[i] = phase;
+        set->x[i] = pathX[s] + (pathX[s + 1] - pathX[s]) * t;
+        set->y[i] = set->anchorY[i];
+        set->z[i] = pathZ[s] + (pathZ[s + 1] - pathZ[s]) * t + set->amplitude[i];
+    }
+}
+
+void ReserveLightSoA(LightSoA* set, int capacity) {
+    if (capacity <= set->capacity) return;
+    std::vector<float>* fields[] = {
+        &set->x, &set->y, &set->z, &set->intensity,
+        &set->anchorX, &set->anchorY, &set->anchorZ, &set->baseIntensity, &set->speed, &set->phase, &set->amplitude
+    };
+    for (std::vector<float>* field : fields) field->resize(capacity);
+    set->lightIndex.resize(capacity);
+    set->slotOf.resize(capacity);
+    set->capacity = capacity;
+}
+
+// The default lights orbit their start points; the rest get a stable mix of motions
+LightMotion GetLightMotion(int index) {
+    if (index < DEFAULT_LIGHTS) return LIGHT_MOTION_ORBIT;
+    float h = LightHash(index, 5);
+    if (h < 0.4f) return LIGHT_MOTION_ORBIT;
+    if (h < 0.7f) return LIGHT_MOTION_FLICKER;
+    if (h < 0.9f) return LIGHT_MOTION_PATH;
+    return LIGHT_MOTION_STATIC;
+}
+
+void BuildLightSoA(LightSoA* set, const Light* lights, int count) {
+    ReserveLightSoA(set, count);
+    set->count = count;
+
+    int perMotion[LIGHT_MOTION_KINDS] = { 0 };
+    for (int i = 0; i < count; i++) perMotion[GetLightMotion(i)]++;
+    set->first[0] = 0;
+    for (int k = 0; k < LIGHT_MOTION_KINDS; k++) set->first[k + 1] = set->first[k] + perMotion[k];
+
+    int next[LIGHT_MOTION_KINDS];
+    for (int k = 0; k < LIGHT_MOTION_KINDS; k++) next[k] = set->first[k];
+
+    for (int i = 0; i < count; i++) {
+        LightMotion motion = GetLightMotion(i);
+        int slot = next[motion]++;
+        const Light* light = &lights[i];
+        set->lightIndex[slot] = i;
+        set->slotOf[i] = slot;
+        set->x[slot] = set->anchorX[slot] = light->position.x;
+        set->y[slot] = set->anchorY[slot] = light->position.y;
+        set->z[slot] = set->anchorZ[slot] = light->position.z;
+        set->intensity[slot] = set->baseIntensity[slot] = light->intensity;
+
+        float speedHash = LightHash(i, 6);
+        float phaseHash = LightHash(i, 7);
+        float amplitudeHash = LightHash(i, 8);
+        switch (motion) {
+        case LIGHT_MOTION_ORBIT:
+            set->speed[slot] = (0.4f + 0.8f * speedHash) * ((i & 1) ? -1.0f : 1.0f);
+            set->phase[slot] = TWO_PI * phaseHash;
+            set->amplitude[slot] = 0.5f + amplitudeHash;
+            break;
+        case LIGHT_MOTION_FLICKER:
+            set->speed[slot] = 6.0f + 8.0f * speedHash;
+            set->phase[slot] = TWO_PI * phaseHash;
+            set->amplitude[slot] = 0.3f + 0.4f * amplitudeHash;
+            break;
+        case LIGHT_MOTION_PATH:
+            set->speed[slot] = 0.15f + 0.25f * speedHash;
+            set->phase[slot] = (float)PATH_POINTS * phaseHash;
+            set->amplitude[slot] = 1.2f * amplitudeHash - 0.6f;
+            break;
+        default:
+            set->speed[slot] = 0.0f;
+            set->phase[slot] = 0.0f;
+            set->amplitude[slot] = 0.0f;
+            break;
+        }
+    }
+}
+
+void AnimateLightSoA(LightSoA* set, float dt, bool simd, bool parallel) {
+    typedef void (*Kernel)(LightSoA*, int, int, float, bool);
+    const Kernel kernels[LIGHT_MOTION_KINDS] = { NULL, OrbitKernel, FlickerKernel, PathKernel };
+
+    for (int k = LIGHT_MOTION_ORBIT; k < LIGHT_MOTION_KINDS; k++) {
+        int first = set->first[k];
+        int count = set->first[k + 1] - first;
+        if (count == 0) continue;
+        Kernel kernel = kernels[k];
+        if (parallel) {
+            ParallelFor(count, LIGHT_ANIMATION_GRAIN, [set, kernel, first, dt, simd](int begin, int end) {
+                kernel(set, first + begin, first + end, dt, simd);
+            });
+        } else {
+            kernel(set, first, first + count, dt, simd);
+        }
+    }
+}
+
+int WriteLightSoA(const LightSoA* set, Light* lights, std::vector<int>* dirty) {
+    int written = 0;
+    int firstAnimated = set->first[LIGHT_MOTION_ORBIT];
+    for (int i = 0; i < set->count; i++) {
+        int slot = set->slotOf[i];
+        if (slot < firstAnimated) continue;
+
+        Light* light = &lights[i];
+        Vector3 position = { set->x[slot], set->y[slot], set->z[slot] };
+        float intensity = set->intensity[slot];
+        if (position.x == light->position.x && position.y == light->position.y &&
+            position.z == light->position.z && intensity == light->intensity) continue;
+
+        light->position = position;
+        light->intensity = intensity;
+        dirty->push_back(i);
+        written++;
+    }
+    return written;
+}
+
+// Put every light back where the animation found it; returns how many moved
+static int RestoreLightAnchors() {
+    int count = std::min(sceneLights.count, lightCount);
+    int restored = 0;
+    for (int i = 0; i < count; i++) {
+        int slot = sceneLights.slotOf[i];
+        if (slot < sceneLights.first[LIGHT_MOTION_ORBIT]) continue;
+        lights[i].position = { sceneLights.anchorX[slot], sceneLights.anchorY[slot], sceneLights.anchorZ[slot] };
+        lights[i].intensity = sceneLights.baseIntensity[slot];
+        dirtyLights.push_back(i);
+        restored++;
+    }
+    sceneLightsBuilt = false;
+    return restored;
+}
+
+void UpdateLightAnimation(float dt) {
+    if (!enableLightAnimation) {
+        stats.dirty = sceneLightsBuilt ? RestoreLightAnchors() : 0;
+        return;
+    }
+
+    // A changed light count rebuilds the set around the anchors, not wherever the lights drifted to
+    if (sceneLightsBuilt && sceneLights.count != lightCount) RestoreLightAnchors();
+    if (!sceneLightsBuilt) {
+        BuildLightSoA(&sceneLights, lights, lightCount);
+        sceneLightsBuilt = true;
+    }
+
+    double startTime = GetTime();
+    AnimateLightSoA(&sceneLights, dt);
+    double animatedTime = GetTime();
+    int written = WriteLightSoA(&sceneLights, lights, &dirtyLights);
+    double endTime = GetTime();
+
+    stats.lights = sceneLights.count - sceneLights.first[LIGHT_MOTION_ORBIT];
+    stats.dirty = written;
+    stats.animateMs = (animatedTime - startTime) * 1000.0;
+    stats.writeMs = (endTime - animatedTime) * 1000.0;
+    double totalMs = stats.animateMs + stats.writeMs;
+    stats.lightsPerMs = (totalMs > 0.0) ? stats.lights / totalMs : 0.0;
+}
+
+bool GetAnimatedLight(int index, Vector3* anchor, float* baseIntensity) {
+    if (!sceneLightsBuilt || index < 0 || index >= sceneLights.count) return false;
+    int slot = sceneLights.slotOf[index];
+    *anchor = { sceneLights.anchorX[slot], sceneLights.anchorY[slot], sceneLights.anchorZ[slot] };
+    *baseIntensity = sceneLights.baseIntensity[slot];
+    return true;
+}
+
+void SetAnimatedLight(int index, Vector3 anchor, float baseIntensity) {
+    if (!sceneLightsBuilt || index < 0 || index >= sceneLights.count) return;
+    int slot = sceneLights.slotOf[index];
+    sceneLights.anchorX[slot] = anchor.x;
+    sceneLights.anchorY[slot] = anchor.y;
+    sceneLights.anchorZ[slot] = anchor.z;
+    sceneLights.baseIntensity[slot] = baseIntensity;
+
+    // Static lights are never written back, so apply the edit directly
+    if (slot < sceneLights.first[LIGHT_MOTION_ORBIT]) {
+        lights[index].position = anchor;
+        lights[index].intensity = baseIntensity;
+    }
+    // Color and range live only in lights[], and WriteLightSoA does not compare them
+    MarkLightDirty(index);
+}
+
+void MarkLightDirty(int index) {
+    dirtyLights.push_back(index);
+}
+
+const int* GetLightDirtyList(int* count) {
+    // Edits and animation writes interleave; the upload wants one ascending run list
+    if (!std::is_sorted(dirtyLights.begin(), dirtyLights.end())) std::sort(dirtyLights.begin(), dirtyLights.end());
+    dirtyLights.erase(std::unique(dirtyLights.begin(), dirtyLights.end()), dirtyLights.end());
+    *count = (int)dirtyLights.size();
+    return dirtyLights.data();
+}
+
+void ClearLightDirtyList() {
+    dirtyLights.clear();
+}
+
+const LightAnimationStats* GetLightAnimationStats() {
+    return &stats;
+}
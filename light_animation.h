@@ -0,0 +1,75 @@
+#pragma once
+
+#include "renderer.h"
+#include <vector>
+
+// Animation state of the lights in structure-of-arrays form. Slots are grouped by motion, so every
+// kernel runs over one contiguous range. lights[] stays the store the renderer and the GPU read:
+// color and range live only there, and positions and intensities are written back into it
+// for the lights that actually changed.
+typedef enum {
+    LIGHT_MOTION_STATIC = 0,
+    LIGHT_MOTION_ORBIT,      // circles its anchor with a slight vertical bob
+    LIGHT_MOTION_FLICKER,    // stays put, intensity wavers
+    LIGHT_MOTION_PATH,       // walks a closed loop down the nave
+    LIGHT_MOTION_KINDS
+} LightMotion;
+
+typedef struct {
+    int count;
+    int capacity;
+    int first[LIGHT_MOTION_KINDS + 1];   // motion k owns slots [first[k], first[k + 1])
+    std::vector<int> lightIndex;         // slot -> index into the Light array
+    std::vector<int> slotOf;             // Light index -> slot
+    // Animated state, written back into lights[]
+    std::vector<float> x, y, z;
+    std::vector<float> intensity;
+    // Motion parameters; phase advances by speed every second and wraps
+    std::vector<float> anchorX, anchorY, anchorZ;
+    std::vector<float> baseIntensity;
+    std::vector<float> speed, phase;
+    std::vector<float> amplitude;        // orbit radius, flicker depth or lane offset on the path
+} LightSoA;
+
+typedef struct {
+    int lights;           // animated (non-static) lights
+    int dirty;            // lights written back this frame
+    double animateMs;
+    double writeMs;
+    double lightsPerMs;   // animated lights over animate + write time
+} LightAnimationStats;
+
+extern bool enableLightAnimation;
+
+// Grow the arrays; existing slots are kept
+void ReserveLightSoA(LightSoA* set, int capacity);
+
+// Rebuild the set from an AoS light array; anchors are the current positions, motions come from the light index
+void BuildLightSoA(LightSoA* set, const Light* lights, int count);
+
+// Advance every light by dt. simd = false runs the scalar kernels; parallel splits each motion over the job system
+void AnimateLightSoA(LightSoA* set, float dt, bool simd = true, bool parallel = true);
+
+// Copy lights whose position or intensity changed into the AoS array and append their indices
+// to dirty in ascending order; returns how many were written
+int WriteLightSoA(const LightSoA* set, Light* lights, std::vector<int>* dirty);
+
+LightMotion GetLightMotion(int index);
+
+// Renderer side: animates lights[] each frame while enabled and restores the anchors when turned off
+void UpdateLightAnimation(float dt);
+
+// Anchor and base intensity the animation moves lights[index] around; false while not animating
+bool GetAnimatedLight(int index, Vector3* anchor, float* baseIntensity);
+
+// Apply an edit to an animated light; color and range are edited in lights[index] directly
+void SetAnimatedLight(int index, Vector3 anchor, float baseIntensity);
+
+// Queue lights[index] for the next light buffer upload; every edit made outside the animation must call it
+void MarkLightDirty(int index);
+
+// Lights changed since the last ClearLightDirtyList, ascending and without repeats
+const int* GetLightDirtyList(int* count);
+void ClearLightDirtyList();
+
+const LightAnimationStats* GetLightAnimationStats();
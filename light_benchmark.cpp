@@ -0,0 +1,107 @@
+#include "renderer.h"
+#include "light_animation.h"
+#include "job_system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+// Light animation micro-benchmark: runs the SoA kernels on a large synthetic light set without
+// a window or GL context and reports lights updated per millisecond for each kernel variant.
+typedef struct {
+    int lights;
+    int frames;
+    int warmupFrames;
+    int threads;   // 0 = one worker per extra hardware thread
+} LightBenchmarkOptions;
+
+static void PrintUsage(const char* exe) {
+    printf("Usage: %s [--lights N] [--frames N] [--warmup N] [--threads N]\n", exe);
+}
+
+static bool ParseOptions(int argc, char** argv, LightBenchmarkOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (strcmp(arg, "--lights") == 0 && hasValue) options->lights = atoi(argv[++i]);
+        else if (strcmp(arg, "--frames") == 0 && hasValue) options->frames = atoi(argv[++i]);
+        else if (strcmp(arg, "--warmup") == 0 && hasValue) options->warmupFrames = atoi(argv[++i]);
+        else if (strcmp(arg, "--threads") == 0 && hasValue) options->threads = atoi(argv[++i]);
+        else {
+            PrintUsage(argv[0]);
+            return false;
+        }
+    }
+
+    return options->lights > 0 && options->frames > 0 && options->threads >= 0;
+}
+
+static double NowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Average milliseconds per animation step
+static double TimeAnimation(LightSoA* set, const LightBenchmarkOptions* options, bool simd, bool parallel) {
+    const float dt = 1.0f / 60.0f;
+    for (int i = 0; i < options->warmupFrames; i++) AnimateLightSoA(set, dt, simd, parallel);
+
+    double startMs = NowMs();
+    for (int i = 0; i < options->frames; i++) AnimateLightSoA(set, dt, simd, parallel);
+    return (NowMs() - startMs) / options->frames;
+}
+
+int main(int argc, char** argv) {
+    LightBenchmarkOptions options = { 100000, 200, 10, 0 };
+    if (!ParseOptions(argc, argv, &options)) return 1;
+
+    InitializeJobSystem(options.threads);
+
+    // Scattered over roughly the Sponza volume, like the extra lights SetLightCount adds
+    std::vector<Light> lightArray(options.lights);
+    for (int i = 0; i < options.lights; i++) {
+        lightArray[i].position = Vector3{ -12.0f + 24.0f * LightHash(i, 0), 0.5f + 6.0f * LightHash(i, 1), -5.0f + 10.0f * LightHash(i, 2) };
+        lightArray[i].range = 1.5f + 2.5f * LightHash(i, 4);
+        lightArray[i].color = Vector3{ 1.0f, 1.0f, 1.0f };
+        lightArray[i].intensity = 1.0f;
+    }
+
+    LightSoA set = {};
+    BuildLightSoA(&set, lightArray.data(), options.lights);
+    int animated = set.count - set.first[LIGHT_MOTION_ORBIT];
+    printf("LIGHTBENCH: %d lights (%d orbit, %d flicker, %d path, %d static), %d workers\n", set.count,
+           set.first[LIGHT_MOTION_FLICKER] - set.first[LIGHT_MOTION_ORBIT], set.first[LIGHT_MOTION_PATH] - set.first[LIGHT_MOTION_FLICKER],
+           set.first[LIGHT_MOTION_KINDS] - set.first[LIGHT_MOTION_PATH], set.first[LIGHT_MOTION_ORBIT], GetJobWorkerCount());
+
+    struct { const char* name; bool simd; bool parallel; } modes[] = {
+        { "scalar", false, false },
+        { "simd", true, false },
+        { "simd + workers", true, true }
+    };
+    for (const auto& mode : modes) {
+        double ms = TimeAnimation(&set, &options, mode.simd, mode.parallel);
+        printf("LIGHTBENCH: %-15s %.3f ms per update, %.0f lights updated per ms\n", mode.name, ms, ms > 0.0 ? animated / ms : 0.0);
+    }
+
+    // Write-back into the AoS array the light buffer uploads from, one animation step apart
+    std::vector<int> dirty;
+    dirty.reserve(options.lights);
+    double writeMs = 0.0;
+    long long dirtyTotal = 0;
+    for (int i = 0; i < options.frames; i++) {
+        AnimateLightSoA(&set, 1.0f / 60.0f);
+        dirty.clear();
+        double startMs = NowMs();
+        dirtyTotal += WriteLightSoA(&set, lightArray.data(), &dirty);
+        writeMs += NowMs() - startMs;
+    }
+    writeMs /= options.frames;
+    printf("LIGHTBENCH: write-back      %.3f ms per update, %lld dirty lights per update\n", writeMs, dirtyTotal / options.frames);
+
+    double totalMs = TimeAnimation(&set, &options, true, true) + writeMs;
+    printf("LIGHTBENCH: total           %.3f ms per update, %.0f lights updated per ms\n", totalMs, totalMs > 0.0 ? animated / totalMs : 0.0);
+
+    ShutdownJobSystem();
+    return 0;
+}
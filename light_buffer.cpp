@@ -0,0 +1,144 @@
+#include "light_buffer.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <string.h>
+
+// std140 layout of LightBlock: an ivec4 header (x = light count) followed by the Light array
+typedef struct {
+    int count;
+    int padding[3];
+} LightBlockHeader;
+
+static_assert(sizeof(LightBlockHeader) == 16, "LightBlock header must occupy one std140 vec4 slot");
+
+static GLuint lightUbo = 0;
+static Light uploadedLights[MAX_LIGHTS];  // last contents sent to the GPU
+static int uploadedCount = -1;
+static int lightCapacity = MAX_LIGHTS;
+static char capacityDefine[48];
+
+// Create the shared light uniform buffer and attach it to its binding point
+void InitializeLightBuffer() {
+    // Start from zeroed contents so the shadow copy matches the GPU side
+    memset(uploadedLights, 0, sizeof(uploadedLights));
+    uploadedCount = -1;
+
+    // The block must fit the driver's limit, so the light array shrinks to what fits
+    GLint maxBlockSize = 0;
+    glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+    lightCapacity = (maxBlockSize - (int)sizeof(LightBlockHeader)) / (int)sizeof(Light);
+    if (lightCapacity > MAX_LIGHTS) lightCapacity = MAX_LIGHTS;
+    if (lightCapacity < MAX_LIGHTS) {
+        TraceLog(LOG_WARNING, "LIGHTS: Uniform block limit of %i bytes caps lights at %i", maxBlockSize, lightCapacity);
+    }
+    snprintf(capacityDefine, sizeof(capacityDefine), "#define LIGHT_CAPACITY %d\n", lightCapacity);
+
+    int arrayBytes = lightCapacity * (int)sizeof(Light);
+    glGenBuffers(1, &lightUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlockHeader) + arrayBytes, NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, sizeof(LightBlockHeader), arrayBytes, uploadedLights);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, lightUbo);
+}
+
+void UnloadLightBuffer() {
+    glDeleteBuffers(1, &lightUbo);
+    lightUbo = 0;
+}
+
+int GetLightCapacity() {
+    return lightCapacity;
+}
+
+const char* GetLightCapacityDefine() {
+    return capacityDefine;
+}
+
+// Point a lit shader's LightBlock at the shared buffer
+void BindLightBuffer(Shader shader) {
+    GLuint blockIndex = glGetUniformBlockIndex(shader.id, "LightBlock");
+    if (blockIndex == GL_INVALID_INDEX) {
+        TraceLog(LOG_WARNING, "LIGHTS: [SHDR ID %i] LightBlock not found", shader.id);
+        return;
+    }
+    glUniformBlockBinding(shader.id, blockIndex, LIGHT_BLOCK_BINDING);
+}
+
+// Upload one run of lights and record it in the shadow copy
+static int UploadLightRange(const Light* lights, int first, int last) {
+    int rangeSize = (last - first + 1) * (int)sizeof(Light);
+    glBufferSubData(GL_UNIFORM_BUFFER, sizeof(LightBlockHeader) + first * sizeof(Light), rangeSize, &lights[first]);
+    memcpy(&uploadedLights[first], &lights[first], rangeSize);
+    return rangeSize;
+}
+
+static int UploadLightCount(int count) {
+    if (count == uploadedCount) return 0;
+    LightBlockHeader header = { count, { 0, 0, 0 } };
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(header), &header);
+    uploadedCount = count;
+    return sizeof(header);
+}
+
+// Smallest contiguous range of lights that differ from the shadow copy; false when none do
+static bool FindChangedLights(const Light* lights, int count, int* first, int* last) {
+    *first = -1;
+    *last = -1;
+    for (int i = 0; i < count; i++) {
+        if (memcmp(&lights[i], &uploadedLights[i], sizeof(Light)) != 0) {
+            if (*first < 0) *first = i;
+            *last = i;
+        }
+    }
+    return *first >= 0;
+}
+
+// Upload the smallest contiguous range of lights that changed since the last call; returns bytes uploaded
+int UpdateLightBuffer(const Light* lights, int count) {
+    if (count > lightCapacity) count = lightCapacity;
+
+    int first, last;
+    bool changed = FindChangedLights(lights, count, &first, &last);
+    if (!changed && count == uploadedCount) return 0;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUbo);
+    int bytes = UploadLightCount(count);
+    if (changed) bytes += UploadLightRange(lights, first, last);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return bytes;
+}
+
+// Upload the listed lights as runs of adjacent indices; returns bytes uploaded
+int UpdateLightBufferDirty(const Light* lights, int count, const int* dirty, int dirtyCount) {
+    if (count > lightCapacity) count = lightCapacity;
+#ifdef NDEBUG
+    if (dirtyCount == 0 && count == uploadedCount) return 0;
+#endif
+
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUbo);
+    int bytes = UploadLightCount(count);
+    for (int i = 0; i < dirtyCount; ) {
+        int first = dirty[i];
+        int last = first;
+        i++;
+        while (i < dirtyCount && dirty[i] == last + 1) last = dirty[i++];
+        if (first >= count) break;
+        if (last >= count) last = count - 1;
+        bytes += UploadLightRange(lights, first, last);
+    }
+
+#ifndef NDEBUG
+    // Writes to lights[] that skipped MarkLightDirty would never reach the GPU in release builds
+    int first, last;
+    if (FindChangedLights(lights, count, &first, &last)) {
+        static bool warned = false;
+        if (!warned) TraceLog(LOG_WARNING, "LIGHTS: Lights %i..%i changed without being marked dirty", first, last);
+        warned = true;
+        bytes += UploadLightRange(lights, first, last);
+    }
+#endif
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return bytes;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "renderer.h"
+
+#define LIGHT_BLOCK_BINDING 0       // uniform buffer binding point of LightBlock
+
+void InitializeLightBuffer();
+void UnloadLightBuffer();
+void BindLightBuffer(Shader shader);
+// Lights the LightBlock holds: MAX_LIGHTS, or fewer where GL_MAX_UNIFORM_BLOCK_SIZE is smaller
+// (GL 3.3 only guarantees 16 KB). Shaders declaring LightBlock size their array with LIGHT_CAPACITY.
+int GetLightCapacity();
+const char* GetLightCapacityDefine();   // "#define LIGHT_CAPACITY n\n", for LoadWatchedShader's defines
+// Compare every light against the last upload and send the smallest range that changed
+int UpdateLightBuffer(const Light* lights, int count);
+// Upload only the listed lights (ascending) as runs of adjacent indices. Debug builds also
+// compare every light and upload, with a warning, changes that were not listed.
+int UpdateLightBufferDirty(const Light* lights, int count, const int* dirty, int dirtyCount);
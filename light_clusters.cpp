@@ -0,0 +1,282 @@
+#include "light_clusters.h"
+#include "job_system.h"
+#include "external/glad.h"
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+
+// A light in view space with the conservative cluster range it may touch
+typedef struct {
+    Vector3 center;     // view space, camera looking down -Z
+    float radius;
+    int x0, x1, y0, y1, z0, z1;
+    bool visible;
+} ClusterLight;
+
+// Uniform locations of a shader that reads the cluster buffers
+typedef struct {
+    unsigned int shaderId;
+    int locDims;
+    int locDepth;
+    int locScreenSize;
+    int locViewDir;
+    int locEyePos;
+    int locDebug;
+} ClusterShader;
+
+bool showClusterHeatmap = false;
+
+static GLuint gridBuffer = 0, gridTexture = 0;     // RG32UI: offset, count per cluster
+static GLuint indexBuffer = 0, indexTexture = 0;   // R16UI: light indices
+static std::vector<ClusterShader> clusterShaders;   // the base program, every lit variant and their reloads
+
+static std::vector<ClusterLight> clusterLights;
+static std::vector<uint16_t> sliceIndices[CLUSTER_Z];
+static std::vector<uint16_t> indexList;
+static uint32_t clusterGrid[CLUSTER_COUNT * 2];
+static BoundingBox clusterBounds[CLUSTER_COUNT];
+static ClusterStats stats = { 0 };
+
+static int DepthToSlice(float depth) {
+    if (depth <= CLUSTER_NEAR) return 0;
+    int slice = (int)(logf(depth / CLUSTER_NEAR) / logf(CLUSTER_FAR / CLUSTER_NEAR) * CLUSTER_Z);
+    return (slice < CLUSTER_Z) ? slice : CLUSTER_Z - 1;
+}
+
+static float SliceToDepth(int slice) {
+    return CLUSTER_NEAR * powf(CLUSTER_FAR / CLUSTER_NEAR, (float)slice / CLUSTER_Z);
+}
+
+static int NdcToTile(float ndc, int tiles) {
+    int tile = (int)floorf((ndc * 0.5f + 0.5f) * tiles);
+    return (tile < 0) ? 0 : (tile >= tiles ? tiles - 1 : tile);
+}
+
+// View-space AABB of every froxel for the given frustum
+static void ComputeClusterBounds(float tanX, float tanY) {
+    for (int z = 0; z < CLUSTER_Z; z++) {
+        float depthNear = SliceToDepth(z);
+        float depthFar = (z == CLUSTER_Z - 1) ? 1.0e6f : SliceToDepth(z + 1);
+
+        for (int y = 0; y < CLUSTER_Y; y++) {
+            float ndcY0 = -1.0f + 2.0f * y / CLUSTER_Y;
+            float ndcY1 = -1.0f + 2.0f * (y + 1) / CLUSTER_Y;
+
+            for (int x = 0; x < CLUSTER_X; x++) {
+                float ndcX0 = -1.0f + 2.0f * x / CLUSTER_X;
+                float ndcX1 = -1.0f + 2.0f * (x + 1) / CLUSTER_X;
+
+                BoundingBox box = { { 1.0e9f, 1.0e9f, -depthFar }, { -1.0e9f, -1.0e9f, -depthNear } };
+                float depths[2] = { depthNear, depthFar };
+                for (int d = 0; d < 2; d++) {
+                    float xs[2] = { ndcX0 * depths[d] * tanX, ndcX1 * depths[d] * tanX };
+                    float ys[2] = { ndcY0 * depths[d] * tanY, ndcY1 * depths[d] * tanY };
+                    box.min.x = fminf(box.min.x, fminf(xs[0], xs[1]));
+                    box.max.x = fmaxf(box.max.x, fmaxf(xs[0], xs[1]));
+                    box.min.y = fminf(box.min.y, fminf(ys[0], ys[1]));
+                    box.max.y = fmaxf(box.max.y, fmaxf(ys[0], ys[1]));
+                }
+
+                clusterBounds[x + CLUSTER_X * (y + CLUSTER_Y * z)] = box;
+            }
+        }
+    }
+}
+
+static bool SphereIntersectsBox(Vector3 center, float radius, BoundingBox box) {
+    float dx = fmaxf(fmaxf(box.min.x - center.x, 0.0f), center.x - box.max.x);
+    float dy = fmaxf(fmaxf(box.min.y - center.y, 0.0f), center.y - box.max.y);
+    float dz = fmaxf(fmaxf(box.min.z - center.z, 0.0f), center.z - box.max.z);
+    return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+// Conservative tile range of [lo, hi] (view units) seen between two depths
+static void ProjectRange(float lo, float hi, float depthNear, float depthFar, float tanHalf, int tiles, int* first, int* last) {
+    float ndcMin = lo / (((lo >= 0.0f) ? depthFar : depthNear) * tanHalf);
+    float ndcMax = hi / (((hi >= 0.0f) ? depthNear : depthFar) * tanHalf);
+    *first = NdcToTile(ndcMin, tiles);
+    *last = NdcToTile(ndcMax, tiles);
+}
+
+void InitializeLightClusters() {
+    glGenBuffers(1, &gridBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(clusterGrid), NULL, GL_STREAM_DRAW);
+    glGenTextures(1, &gridTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, gridBuffer);
+
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(uint16_t), NULL, GL_STREAM_DRAW);
+    glGenTextures(1, &indexTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, indexBuffer);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    clusterShaders.clear();
+}
+
+void UnloadLightClusters() {
+    glDeleteTextures(1, &gridTexture);
+    glDeleteTextures(1, &indexTexture);
+    glDeleteBuffers(1, &gridBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+    gridTexture = indexTexture = gridBuffer = indexBuffer = 0;
+}
+
+// Register a lit shader: point its cluster samplers at the reserved units and cache its locations
+void BindLightClusters(Shader shader, unsigned int replaceId) {
+    ClusterShader* entry = NULL;
+    for (int i = 0; i < (int)clusterShaders.size() && replaceId != 0; i++) {
+        if (clusterShaders[i].shaderId == replaceId) entry = &clusterShaders[i];
+    }
+    if (entry == NULL) {
+        clusterShaders.push_back(ClusterShader{});
+        entry = &clusterShaders.back();
+    }
+
+    int gridUnit = CLUSTER_GRID_TEXTURE_UNIT;
+    int indexUnit = CLUSTER_INDEX_TEXTURE_UNIT;
+    SetShaderValue(shader, GetShaderLocation(shader, "u_clusterGrid"), &gridUnit, SHADER_UNIFORM_INT);
+    SetShaderValue(shader, GetShaderLocation(shader, "u_clusterLights"), &indexUnit, SHADER_UNIFORM_INT);
+
+    entry->shaderId = shader.id;
+    entry->locDims = GetShaderLocation(shader, "u_clusterDims");
+    entry->locDepth = GetShaderLocation(shader, "u_clusterDepth");
+    entry->locScreenSize = GetShaderLocation(shader, "u_screenSize");
+    entry->locViewDir = GetShaderLocation(shader, "u_viewDir");
+    entry->locEyePos = GetShaderLocation(shader, "u_eyePos");
+    entry->locDebug = GetShaderLocation(shader, "u_clusterDebug");
+}
+
+// Bin lights into the froxels of the given camera and upload the per-cluster index lists
+void UpdateLightClusters(Camera3D camera, int width, int height, const Light* lights, int count) {
+    double startTime = GetTime();
+
+    float tanY = tanf(camera.fovy * 0.5f * DEG2RAD);
+    float tanX = tanY * (float)width / (float)height;
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    ComputeClusterBounds(tanX, tanY);
+
+    // Pass 1: per light, view-space sphere and the froxel range it can touch
+    clusterLights.resize(count);
+    ParallelFor(count, 64, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            ClusterLight* light = &clusterLights[i];
+            light->center = Vector3Transform(lights[i].position, view);
+            light->radius = lights[i].range;
+
+            float depthMin = -light->center.z - light->radius;
+            float depthMax = -light->center.z + light->radius;
+            light->visible = (depthMax > CLUSTER_NEAR) && (lights[i].intensity > 0.0f);
+            if (!light->visible) continue;
+
+            depthMin = fmaxf(depthMin, CLUSTER_NEAR);
+            light->z0 = DepthToSlice(depthMin);
+            light->z1 = DepthToSlice(depthMax);
+            ProjectRange(light->center.x - light->radius, light->center.x + light->radius, depthMin, depthMax, tanX, CLUSTER_X, &light->x0, &light->x1);
+            ProjectRange(light->center.y - light->radius, light->center.y + light->radius, depthMin, depthMax, tanY, CLUSTER_Y, &light->y0, &light->y1);
+        }
+    });
+
+    // Pass 2: per depth slice, exact sphere/froxel tests; slices are independent so each job owns its output
+    std::atomic<int> maxPerCluster(0);
+    ParallelFor(CLUSTER_Z, 1, [&](int begin, int end) {
+        std::vector<int> candidates;
+        for (int z = begin; z < end; z++) {
+            std::vector<uint16_t>& indices = sliceIndices[z];
+            indices.clear();
+
+            candidates.clear();
+            for (int i = 0; i < count; i++) {
+                const ClusterLight* light = &clusterLights[i];
+                if (light->visible && z >= light->z0 && z <= light->z1) candidates.push_back(i);
+            }
+
+            int sliceMax = 0;
+            for (int y = 0; y < CLUSTER_Y; y++) {
+                for (int x = 0; x < CLUSTER_X; x++) {
+                    int cluster = x + CLUSTER_X * (y + CLUSTER_Y * z);
+                    uint32_t offset = (uint32_t)indices.size();
+
+                    for (int i : candidates) {
+                        const ClusterLight* light = &clusterLights[i];
+                        if (x < light->x0 || x > light->x1 || y < light->y0 || y > light->y1) continue;
+                        if (SphereIntersectsBox(light->center, light->radius, clusterBounds[cluster])) {
+                            indices.push_back((uint16_t)i);
+                        }
+                    }
+
+                    uint32_t lightsInCluster = (uint32_t)indices.size() - offset;
+                    clusterGrid[cluster * 2 + 0] = offset;   // slice-relative until compaction
+                    clusterGrid[cluster * 2 + 1] = lightsInCluster;
+                    if ((int)lightsInCluster > sliceMax) sliceMax = (int)lightsInCluster;
+                }
+            }
+
+            int previous = maxPerCluster.load();
+            while (sliceMax > previous && !maxPerCluster.compare_exchange_weak(previous, sliceMax)) {}
+        }
+    });
+
+    // Compact the slice lists into one index list and rebase the offsets
+    indexList.clear();
+    int activeClusters = 0;
+    for (int z = 0; z < CLUSTER_Z; z++) {
+        uint32_t base = (uint32_t)indexList.size();
+        for (int c = z * CLUSTER_X * CLUSTER_Y; c < (z + 1) * CLUSTER_X * CLUSTER_Y; c++) {
+            clusterGrid[c * 2] += base;
+            if (clusterGrid[c * 2 + 1] > 0) activeClusters++;
+        }
+        indexList.insert(indexList.end(), sliceIndices[z].begin(), sliceIndices[z].end());
+    }
+    if (indexList.empty()) indexList.push_back(0);   // keep the buffer texture non-empty
+
+    // Orphan and refill both buffers so in-flight draws keep their data
+    glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(clusterGrid), clusterGrid, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, indexList.size() * sizeof(uint16_t), indexList.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glActiveTexture(GL_TEXTURE0 + CLUSTER_GRID_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+    glActiveTexture(GL_TEXTURE0 + CLUSTER_INDEX_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // slice = log(depth) * scale + bias
+    float logRange = logf(CLUSTER_FAR / CLUSTER_NEAR);
+    float depthParams[2] = { CLUSTER_Z / logRange, -CLUSTER_Z * logf(CLUSTER_NEAR) / logRange };
+    int dims[3] = { CLUSTER_X, CLUSTER_Y, CLUSTER_Z };
+    Vector2 screenSize = { (float)width, (float)height };
+    Vector3 viewDir = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    int debug = showClusterHeatmap ? 1 : 0;
+
+    for (int i = 0; i < (int)clusterShaders.size(); i++) {
+        Shader shader = { clusterShaders[i].shaderId, NULL };
+        SetShaderValue(shader, clusterShaders[i].locDims, dims, SHADER_UNIFORM_IVEC3);
+        SetShaderValue(shader, clusterShaders[i].locDepth, depthParams, SHADER_UNIFORM_VEC2);
+        SetShaderValue(shader, clusterShaders[i].locScreenSize, &screenSize, SHADER_UNIFORM_VEC2);
+        SetShaderValue(shader, clusterShaders[i].locViewDir, &viewDir, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader, clusterShaders[i].locEyePos, &camera.position, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader, clusterShaders[i].locDebug, &debug, SHADER_UNIFORM_INT);
+    }
+
+    int visible = 0;
+    for (int i = 0; i < count; i++) visible += clusterLights[i].visible ? 1 : 0;
+
+    stats.lightCount = count;
+    stats.visibleLights = visible;
+    stats.indexCount = (int)indexList.size();
+    stats.activeClusters = activeClusters;
+    stats.maxLightsPerCluster = maxPerCluster.load();
+    stats.buildMs = (GetTime() - startTime) * 1000.0;
+}
+
+const ClusterStats* GetClusterStats() {
+    return &stats;
+}
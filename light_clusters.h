@@ -0,0 +1,32 @@
+#pragma once
+
+#include "renderer.h"
+
+// Froxel grid: screen tiles x depth slices (exponential in view depth)
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+#define CLUSTER_COUNT (CLUSTER_X * CLUSTER_Y * CLUSTER_Z)
+#define CLUSTER_NEAR 0.1f
+#define CLUSTER_FAR 100.0f
+
+// Texture units reserved for the cluster buffers (above raylib's material maps)
+#define CLUSTER_GRID_TEXTURE_UNIT 14
+#define CLUSTER_INDEX_TEXTURE_UNIT 15
+
+typedef struct {
+    int lightCount;        // lights passed in
+    int visibleLights;     // lights touching at least one cluster
+    int indexCount;        // total entries in the light-index list
+    int activeClusters;    // clusters with at least one light
+    int maxLightsPerCluster;
+    double buildMs;
+} ClusterStats;
+
+extern bool showClusterHeatmap;
+
+void InitializeLightClusters();
+void UnloadLightClusters();
+void BindLightClusters(Shader shader, unsigned int replaceId = 0);   // replaceId: a reloaded program's predecessor
+void UpdateLightClusters(Camera3D camera, int width, int height, const Light* lights, int count);
+const ClusterStats* GetClusterStats();
@@ -0,0 +1,336 @@
+#include "light_probe.h"
+#include "profiler.h"
+#include "light_clusters.h"
+#include "depth_prepass.h"
+#include "occlusion_culling.h"
+#include "shader_cache.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <string.h>
+
+LightProbe lightProbe;
+bool enableLightProbe = true;
+bool showLightProbe = false;
+int probeFacesPerFrame = 1;
+int probeMipFacesPerFrame = 6;
+
+static Shader shPrefilter;
+static int locPrefilterFace, locPrefilterSize, locPrefilterCone, locPrefilterEnvironment;
+static unsigned int prefilterFbo = 0;
+static int probeMipCount = 1;
+
+// Work queue: faces to re-render, then (mip, face) pairs to filter in order mip 1..n
+static bool faceDirty[PROBE_FACES];
+static int nextFace = 0;
+static int prefilterNext = 0;     // index into the (mip - 1) * 6 + face sequence
+static bool prefilterActive = false;
+
+// What the cubemap currently shows; compared every frame to find stale faces
+static Light renderedLights[MAX_LIGHTS];
+static int renderedLightCount = 0;
+static Vector3 renderedPosition;
+static Vector3 renderedAmbient, renderedSpecular;
+static float renderedShininess;
+
+static VisibleMeshes probeVisible;
+static CullStats probeCullStats = { 0 };
+static ProbeUpdateStats updateStats = { 0 };
+
+// Camera target and up per face, matching the GL cubemap face orientation: +X, -X, +Y, -Y, +Z, -Z
+static const Vector3 faceDirections[PROBE_FACES] = {
+    { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+    { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }
+};
+static const Vector3 faceUps[PROBE_FACES] = {
+    { 0.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+    { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }
+};
+
+static void MarkAllFacesDirty() {
+    for (int i = 0; i < PROBE_FACES; i++) faceDirty[i] = true;
+}
+
+// Initialize light probe
+void InitializeLightProbe(Vector3 position, int resolution) {
+    lightProbe.position = position;
+    lightProbe.resolution = resolution;
+    lightProbe.needsUpdate = true;
+
+    // One HDR staging face with depth; rendered faces are copied out of it
+    lightProbe.staging = LoadRenderTexture(resolution, resolution);
+    UnloadTexture(lightProbe.staging.texture);
+    lightProbe.staging.texture.id = rlLoadTexture(NULL, resolution, resolution, RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16, 1);
+    lightProbe.staging.texture.width = resolution;
+    lightProbe.staging.texture.height = resolution;
+    lightProbe.staging.texture.mipmaps = 1;
+    lightProbe.staging.texture.format = RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16;
+    rlFramebufferAttach(lightProbe.staging.id, lightProbe.staging.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+
+    // Cubemap with its full mip chain allocated up front, so updates never reallocate
+    probeMipCount = 1;
+    while ((resolution >> probeMipCount) > 0) probeMipCount++;
+
+    unsigned int cubemapId = 0;
+    glGenTextures(1, &cubemapId);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapId);
+    for (int level = 0; level < probeMipCount; level++) {
+        int size = resolution >> level;
+        for (int face = 0; face < PROBE_FACES; face++) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, GL_RGBA16F, size, size, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+        }
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, probeMipCount - 1);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);   // filtered mips blend across face edges
+
+    lightProbe.cubemap = TextureCubemap{ cubemapId, resolution, resolution, probeMipCount, RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16 };
+
+    LoadWatchedShader(&shPrefilter, NULL, "resources/shaders/probe_prefilter.fs", [](unsigned int) {
+        locPrefilterFace = GetShaderLocation(shPrefilter, "u_face");
+        locPrefilterSize = GetShaderLocation(shPrefilter, "u_faceSize");
+        locPrefilterCone = GetShaderLocation(shPrefilter, "u_coneAngle");
+        locPrefilterEnvironment = GetShaderLocation(shPrefilter, "environmentMap");
+    });
+    prefilterFbo = rlLoadFramebuffer();
+
+    MarkAllFacesDirty();
+    prefilterActive = false;
+    renderedLightCount = 0;
+    updateStats = ProbeUpdateStats{ 0 };
+}
+
+// Unload light probe resources
+void UnloadLightProbe() {
+    UnloadRenderTexture(lightProbe.staging);
+    rlUnloadTexture(lightProbe.cubemap.id);
+    rlUnloadFramebuffer(prefilterFbo);
+    UnloadWatchedShader(&shPrefilter);
+}
+
+// Whether a sphere around the probe-relative point reaches into the face's 90 degree frustum
+static bool SphereTouchesFace(Vector3 point, float radius, int face) {
+    float p[3] = { point.x, point.y, point.z };
+    int axis = face / 2;
+    float forward = (face % 2 == 0) ? p[axis] : -p[axis];
+    float limit = -radius * 1.41421356f;   // side planes have normals (forward +- side) / sqrt(2)
+    for (int side = 0; side < 3; side++) {
+        if (side == axis) continue;
+        if (forward - p[side] < limit || forward + p[side] < limit) return false;
+    }
+    return true;
+}
+
+static void MarkLightFaces(const Light* light) {
+    Vector3 relative = Vector3Subtract(light->position, lightProbe.position);
+    float radius = light->range + 0.2f;   // lit area plus the orb itself
+    for (int face = 0; face < PROBE_FACES; face++) {
+        if (SphereTouchesFace(relative, radius, face)) faceDirty[face] = true;
+    }
+}
+
+// Compare the scene against what the faces were rendered with and queue only the faces that changed
+static void DetectProbeChanges() {
+    bool moved = !Vector3Equals(lightProbe.position, renderedPosition);
+    bool shadingChanged = !Vector3Equals(ambientColor, renderedAmbient) || !Vector3Equals(specularColor, renderedSpecular) ||
+                          shininess != renderedShininess;
+
+    if (lightProbe.needsUpdate || moved || shadingChanged) {
+        MarkAllFacesDirty();
+        lightProbe.needsUpdate = false;
+    } else {
+        // A changed light dirties the faces its old and new spheres reach
+        int count = (lightCount > renderedLightCount) ? lightCount : renderedLightCount;
+        for (int i = 0; i < count; i++) {
+            bool existed = (i < renderedLightCount);
+            bool exists = (i < lightCount);
+            if (existed && exists && memcmp(&renderedLights[i], &lights[i], sizeof(Light)) == 0) continue;
+            if (existed) MarkLightFaces(&renderedLights[i]);
+            if (exists) MarkLightFaces(&lights[i]);
+        }
+    }
+
+    memcpy(renderedLights, lights, sizeof(Light) * lightCount);
+    renderedLightCount = lightCount;
+    renderedPosition = lightProbe.position;
+    renderedAmbient = ambientColor;
+    renderedSpecular = specularColor;
+    renderedShininess = shininess;
+}
+
+// Filter one face of one mip from the mip above it
+static void PrefilterMipFace(int level, int face) {
+    int size = lightProbe.resolution >> level;
+    int sourceSize = lightProbe.resolution >> (level - 1);
+    float coneAngle = 1.5f * (PI * 0.5f) / (float)sourceSize;   // about 1.5 source texels
+    float faceSize = (float)size;
+
+    // Only the source mip is visible to the sampler, so writing the next one is not a feedback loop
+    glBindTexture(GL_TEXTURE_CUBE_MAP, lightProbe.cubemap.id);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, level - 1);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, level - 1);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    rlFramebufferAttach(prefilterFbo, lightProbe.cubemap.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_CUBEMAP_POSITIVE_X + face, level);
+    RenderTexture2D target = { prefilterFbo, { lightProbe.cubemap.id, size, size, 1, RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16 }, { 0 } };
+
+    BeginTextureMode(target);
+        BeginShaderMode(shPrefilter);
+            SetShaderValue(shPrefilter, locPrefilterFace, &face, SHADER_UNIFORM_INT);
+            SetShaderValue(shPrefilter, locPrefilterSize, &faceSize, SHADER_UNIFORM_FLOAT);
+            SetShaderValue(shPrefilter, locPrefilterCone, &coneAngle, SHADER_UNIFORM_FLOAT);
+
+            // The batch only binds 2D textures, so the cubemap goes on its own unit for this draw
+            int unit = 1;
+            rlActiveTextureSlot(unit);
+            rlEnableTextureCubemap(lightProbe.cubemap.id);
+            SetShaderValue(shPrefilter, locPrefilterEnvironment, &unit, SHADER_UNIFORM_INT);
+            rlActiveTextureSlot(0);
+
+            // Any quad covering the face; the shader derives directions from gl_FragCoord
+            Rectangle source = { 0, 0, (float)lightProbe.staging.texture.width, (float)lightProbe.staging.texture.height };
+            Rectangle dest = { 0, 0, (float)size, (float)size };
+            DrawTexturePro(lightProbe.staging.texture, source, dest, Vector2{ 0, 0 }, 0.0f, WHITE);
+        EndShaderMode();
+
+        rlActiveTextureSlot(unit);
+        rlDisableTextureCubemap();
+        rlActiveTextureSlot(0);
+    EndTextureMode();
+
+    glBindTexture(GL_TEXTURE_CUBE_MAP, lightProbe.cubemap.id);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, probeMipCount - 1);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
+
+// Spend this frame's probe budget: dirty faces first (round robin), then the mip chain a few faces at a time.
+// Costs nothing beyond the change check once the cubemap matches the scene.
+void UpdateLightProbe() {
+    updateStats.facesRendered = 0;
+    updateStats.mipFacesFiltered = 0;
+
+    DetectProbeChanges();
+
+    int dirtyFaces = 0;
+    for (int i = 0; i < PROBE_FACES; i++) dirtyFaces += faceDirty[i] ? 1 : 0;
+    if (dirtyFaces == 0 && !prefilterActive) {
+        updateStats.dirtyFaces = 0;
+        updateStats.prefilterPending = 0;
+        updateStats.framesSinceChange++;
+        return;
+    }
+
+    ProfilerBeginScope("light_probe");
+    updateStats.framesSinceChange = 0;
+
+    if (dirtyFaces > 0) probeCullStats = CullStats{ 0 };
+
+    for (int checked = 0; checked < PROBE_FACES && updateStats.facesRendered < probeFacesPerFrame; checked++) {
+        int face = nextFace;
+        nextFace = (nextFace + 1) % PROBE_FACES;
+        if (!faceDirty[face]) continue;
+
+        Camera3D probeCamera = GetProbeFaceCamera(lightProbe.position, face);
+
+        char scopeName[32];
+        snprintf(scopeName, sizeof(scopeName), "light_probe_face_%d", face);
+        ProfilerBeginScope(scopeName);
+        RenderSceneToLightProbe(probeCamera, face);
+        ProfilerEndScope();
+
+        faceDirty[face] = false;
+        dirtyFaces--;
+        updateStats.facesRendered++;
+        updateStats.lastFace = face;
+    }
+
+    // Mips restart whenever level 0 changed; filtering waits until every face is current
+    if (updateStats.facesRendered > 0) {
+        prefilterActive = true;
+        prefilterNext = 0;
+    }
+    int prefilterTotal = (probeMipCount - 1) * PROBE_FACES;
+    if (dirtyFaces == 0 && prefilterActive) {
+        ProfilerBeginScope("light_probe_prefilter");
+        while (prefilterNext < prefilterTotal && updateStats.mipFacesFiltered < probeMipFacesPerFrame) {
+            PrefilterMipFace(1 + prefilterNext / PROBE_FACES, prefilterNext % PROBE_FACES);
+            prefilterNext++;
+            updateStats.mipFacesFiltered++;
+        }
+        if (prefilterNext >= prefilterTotal) prefilterActive = false;
+        ProfilerEndScope();
+    }
+
+    updateStats.dirtyFaces = dirtyFaces;
+    updateStats.prefilterPending = prefilterActive ? prefilterTotal - prefilterNext : 0;
+
+    ProfilerEndScope();
+}
+
+// Camera looking through one cubemap face from the given point
+Camera3D GetProbeFaceCamera(Vector3 position, int face) {
+    Camera3D probeCamera = { 0 };
+    probeCamera.position = position;
+    probeCamera.target = Vector3Add(position, faceDirections[face]);
+    probeCamera.up = faceUps[face];
+    probeCamera.fovy = 90.0f;  // 90 degrees for cubemap
+    probeCamera.projection = CAMERA_PERSPECTIVE;
+    return probeCamera;
+}
+
+// Render the scene as seen by a probe camera into a square HDR target with depth
+void RenderProbeFace(Camera3D probeCamera, RenderTexture2D target) {
+    int size = target.texture.width;
+
+    // Re-bin lights and cull meshes for this face's frustum
+    UpdateLightClusters(probeCamera, size, size, lights, lightCount);
+    CullScene(probeCamera, 1.0f, &probeVisible);
+    CullOccludedMeshes(probeCamera, 1.0f, &probeVisible);
+    AccumulateCullStats(&probeCullStats, &probeVisible.stats);
+
+    BeginTextureMode(target);
+        ClearBackground(BLACK);
+        BeginMode3D(probeCamera);
+            // Draw skybox
+            BeginShaderMode(shSky);
+                rlDisableBackfaceCulling();
+                rlDisableDepthMask();
+                DrawModel(skyModel, probeCamera.position, 1.0f, WHITE);
+                rlEnableBackfaceCulling();
+                rlEnableDepthMask();
+            EndShaderMode();
+
+            // Draw scene models (excluding light probe visualization)
+            DrawOpaqueScene(&probeVisible, size, size, false);
+
+            // Draw light sources
+            DrawLightOrbs();
+        EndMode3D();
+    EndTextureMode();
+}
+
+// Render scene to a light probe face and copy it into that face of the cubemap
+void RenderSceneToLightProbe(Camera3D probeCamera, int faceIndex) {
+    RenderProbeFace(probeCamera, lightProbe.staging);
+
+    // GPU-side copy; framebuffer row 0 is the bottom of the face, which is where GL expects it
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, lightProbe.staging.id);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, lightProbe.cubemap.id);
+    glCopyTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + faceIndex, 0, 0, 0, 0, 0, lightProbe.resolution, lightProbe.resolution);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+const ProbeUpdateStats* GetProbeUpdateStats() {
+    return &updateStats;
+}
+
+const CullStats* GetProbeCullStats() {
+    return &probeCullStats;
+}
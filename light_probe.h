@@ -0,0 +1,41 @@
+#pragma once
+
+#include "renderer.h"
+#include "scene_culling.h"
+
+#define PROBE_FACES 6
+
+typedef struct {
+    Vector3 position;
+    RenderTexture2D staging;   // each face renders here (HDR, with depth) before it is copied into the cubemap
+    TextureCubemap cubemap;    // RGBA16F, full mip chain; mip n is filtered from mip n-1
+    int resolution;
+    bool needsUpdate;          // re-render every face (UI button)
+} LightProbe;
+
+// Work left and done for the time-sliced probe update
+typedef struct {
+    int dirtyFaces;            // faces waiting to be re-rendered
+    int prefilterPending;      // mip faces waiting to be filtered
+    int facesRendered;         // this frame
+    int mipFacesFiltered;      // this frame
+    int framesSinceChange;
+    int lastFace;              // most recently rendered face, shown in the preview
+} ProbeUpdateStats;
+
+extern LightProbe lightProbe;
+extern bool enableLightProbe;
+extern bool showLightProbe;
+extern int probeFacesPerFrame;      // scene renders per frame while faces are dirty
+extern int probeMipFacesPerFrame;   // prefilter face/mip draws per frame once every face is current
+
+void InitializeLightProbe(Vector3 position, int resolution);
+void UnloadLightProbe();
+// Detect what changed since the faces were rendered and spend this frame's budget on it
+void UpdateLightProbe();
+void RenderSceneToLightProbe(Camera3D probeCamera, int faceIndex);
+// Face camera and scene render shared by the probe and the irradiance bake
+Camera3D GetProbeFaceCamera(Vector3 position, int face);
+void RenderProbeFace(Camera3D probeCamera, RenderTexture2D target);
+const ProbeUpdateStats* GetProbeUpdateStats();
+const CullStats* GetProbeCullStats();
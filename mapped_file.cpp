@@ -0,0 +1,80 @@
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+bool MapFile(const char* path, MappedFile* file) {
+    *file = MappedFile{ NULL, 0, 0, 0 };
+
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (view == NULL) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    file->data = (const unsigned char*)view;
+    file->size = (size_t)size.QuadPart;
+    file->handle = (intptr_t)handle;
+    file->mapping = (intptr_t)mapping;
+    return true;
+}
+
+void UnmapFile(MappedFile* file) {
+    if (file->data == NULL) return;
+    UnmapViewOfFile(file->data);
+    CloseHandle((HANDLE)file->mapping);
+    CloseHandle((HANDLE)file->handle);
+    *file = MappedFile{ NULL, 0, 0, 0 };
+}
+
+#else
+
+bool MapFile(const char* path, MappedFile* file) {
+    *file = MappedFile{ NULL, 0, 0, 0 };
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   // the mapping keeps the file referenced
+    if (view == MAP_FAILED) return false;
+
+    file->data = (const unsigned char*)view;
+    file->size = (size_t)info.st_size;
+    return true;
+}
+
+void UnmapFile(MappedFile* file) {
+    if (file->data == NULL) return;
+    munmap((void*)file->data, file->size);
+    *file = MappedFile{ NULL, 0, 0, 0 };
+}
+
+#endif
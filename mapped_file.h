@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Read-only view of a whole file, paged in by the OS on first touch.
+// Kept free of raylib so the platform headers stay in mapped_file.cpp.
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    intptr_t handle;    // file descriptor or file HANDLE
+    intptr_t mapping;   // Windows mapping HANDLE, unused elsewhere
+} MappedFile;
+
+bool MapFile(const char* path, MappedFile* file);
+void UnmapFile(MappedFile* file);
@@ -0,0 +1,323 @@
+#include "occlusion_culling.h"
+#include "job_system.h"
+#include "rlgl.h"
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define OCCLUSION_SSE 1
+#endif
+
+bool enableOcclusionCulling = true;
+
+// One occluder triangle in screen space; valid ones face the camera and lie past the near limit
+typedef struct {
+    float x[3];
+    float y[3];
+    float invW[3];
+    int minX, minY, maxX, maxY;   // pixel rect, inclusive
+    bool valid;
+} ScreenTriangle;
+
+static std::vector<Vector3> occluderVertices;   // three per triangle, world space
+static std::vector<ScreenTriangle> screenTriangles;
+static std::vector<std::vector<int>> tileBins;
+static std::vector<float> depthBuffer;          // 1/w, 0 where no occluder was drawn
+static std::vector<float> tileFarthest;         // smallest 1/w in each tile
+static std::vector<unsigned char> meshOccluded;
+static int bufferHeight = 0;
+static int tilesX = 0;
+static int tilesY = 0;
+static OccluderInfo info = { 0 };
+
+typedef struct {
+    float area;
+    int mesh;
+} OccluderCandidate;
+
+static Vector3 MeshVertex(const Mesh* mesh, int triangle, int corner, Matrix transform) {
+    int index = mesh->indices ? mesh->indices[triangle * 3 + corner] : triangle * 3 + corner;
+    const float* v = &mesh->vertices[index * 3];
+    return Vector3Transform(Vector3{ v[0], v[1], v[2] }, transform);
+}
+
+void BuildOccluders(Model model) {
+    UnloadOccluders();
+
+    std::vector<OccluderCandidate> candidates;
+    for (int i = 0; i < model.meshCount; i++) {
+        const Mesh* mesh = &model.meshes[i];
+        if (mesh->vertices == NULL || mesh->triangleCount == 0 || mesh->triangleCount > OCCLUDER_MAX_TRIANGLES) continue;
+
+        float area = 0.0f;
+        for (int t = 0; t < mesh->triangleCount; t++) {
+            Vector3 a = MeshVertex(mesh, t, 0, model.transform);
+            Vector3 b = MeshVertex(mesh, t, 1, model.transform);
+            Vector3 c = MeshVertex(mesh, t, 2, model.transform);
+            area += 0.5f * Vector3Length(Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(c, a)));
+        }
+        candidates.push_back(OccluderCandidate{ area, i });
+    }
+
+    // Largest surfaces first, as long as they fit the triangle budget
+    std::sort(candidates.begin(), candidates.end(), [](const OccluderCandidate& a, const OccluderCandidate& b) { return a.area > b.area; });
+    for (const OccluderCandidate& candidate : candidates) {
+        if (info.meshes >= OCCLUDER_MAX_MESHES) break;
+        const Mesh* mesh = &model.meshes[candidate.mesh];
+        if (info.triangles + mesh->triangleCount > OCCLUDER_TRIANGLE_BUDGET) continue;
+        for (int t = 0; t < mesh->triangleCount; t++) {
+            for (int corner = 0; corner < 3; corner++) occluderVertices.push_back(MeshVertex(mesh, t, corner, model.transform));
+        }
+        info.meshes++;
+        info.triangles += mesh->triangleCount;
+    }
+    screenTriangles.resize(info.triangles);
+    TraceLog(LOG_INFO, "OCCLUSION: %i occluder meshes, %i triangles", info.meshes, info.triangles);
+}
+
+void UnloadOccluders() {
+    occluderVertices.clear();
+    screenTriangles.clear();
+    info = OccluderInfo{ 0 };
+}
+
+static void ResizeBuffer(int height) {
+    if (height == bufferHeight) return;
+    bufferHeight = height;
+    tilesX = OCCLUSION_WIDTH / OCCLUSION_TILE_WIDTH;
+    tilesY = height / OCCLUSION_TILE_HEIGHT;
+    depthBuffer.assign(OCCLUSION_WIDTH * height, 0.0f);
+    tileFarthest.assign(tilesX * tilesY, 0.0f);
+    tileBins.assign(tilesX * tilesY, std::vector<int>());
+}
+
+// raylib matrices keep rows contiguous, so the clip-space position is x * (m0 m1 m2 m3) + y * (m4 ...) + ...
+static Vector4 ToClip(Vector3 p, const Matrix& m) {
+    return Vector4{
+        m.m0 * p.x + m.m4 * p.y + m.m8 * p.z + m.m12,
+        m.m1 * p.x + m.m5 * p.y + m.m9 * p.z + m.m13,
+        m.m2 * p.x + m.m6 * p.y + m.m10 * p.z + m.m14,
+        m.m3 * p.x + m.m7 * p.y + m.m11 * p.z + m.m15
+    };
+}
+
+// Project, reject back faces (the renderer culls them, so they hide nothing) and bound in pixels
+static void SetupTriangle(int index, const Matrix& viewProj) {
+    ScreenTriangle* tri = &screenTriangles[index];
+    tri->valid = false;
+    for (int k = 0; k < 3; k++) {
+        Vector4 clip = ToClip(occluderVertices[index * 3 + k], viewProj);
+        if (clip.w < OCCLUSION_NEAR) return;
+        float invW = 1.0f / clip.w;
+        tri->x[k] = (clip.x * invW * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+        tri->y[k] = (clip.y * invW * 0.5f + 0.5f) * bufferHeight;
+        tri->invW[k] = invW;
+    }
+
+    float area = (tri->x[1] - tri->x[0]) * (tri->y[2] - tri->y[0]) - (tri->x[2] - tri->x[0]) * (tri->y[1] - tri->y[0]);
+    if (area <= 0.0f) return;
+
+    tri->minX = std::max(0, (int)floorf(std::min(tri->x[0], std::min(tri->x[1], tri->x[2]))));
+    tri->maxX = std::min(OCCLUSION_WIDTH - 1, (int)floorf(std::max(tri->x[0], std::max(tri->x[1], tri->x[2]))));
+    tri->minY = std::max(0, (int)floorf(std::min(tri->y[0], std::min(tri->y[1], tri->y[2]))));
+    tri->maxY = std::min(bufferHeight - 1, (int)floorf(std::max(tri->y[0], std::max(tri->y[1], tri->y[2]))));
+    tri->valid = tri->minX <= tri->maxX && tri->minY <= tri->maxY;
+}
+
+// Only pixel centers inside the triangle are covered, so an occluder never grows. Centers exactly on
+// an edge count for both triangles sharing it: the edge functions are exact negatives, leaving no cracks.
+static void RasterizeTriangle(const ScreenTriangle* tri, int tileX0, int tileY0) {
+    // Edge k runs opposite vertex k; E(x, y) = a x + b y + c is non-negative inside a counter-clockwise triangle
+    float a[3], b[3], c[3];
+    for (int k = 0; k < 3; k++) {
+        int i = (k + 1) % 3;
+        int j = (k + 2) % 3;
+        a[k] = tri->y[i] - tri->y[j];
+        b[k] = tri->x[j] - tri->x[i];
+        c[k] = tri->x[i] * tri->y[j] - tri->x[j] * tri->y[i];
+    }
+    float area = c[0] + c[1] + c[2];
+    float invArea = 1.0f / area;
+
+    // 1/w is affine in screen space
+    float za = (a[0] * tri->invW[0] + a[1] * tri->invW[1] + a[2] * tri->invW[2]) * invArea;
+    float zb = (b[0] * tri->invW[0] + b[1] * tri->invW[1] + b[2] * tri->invW[2]) * invArea;
+    float zc = (c[0] * tri->invW[0] + c[1] * tri->invW[1] + c[2] * tri->invW[2]) * invArea;
+
+    // Rows start on a multiple of 4 inside the tile, so the SSE loop never leaves it
+    int x0 = std::max(tri->minX, tileX0) & ~3;
+    int x1 = std::min(tri->maxX, tileX0 + OCCLUSION_TILE_WIDTH - 1);
+    int y0 = std::max(tri->minY, tileY0);
+    int y1 = std::min(tri->maxY, tileY0 + OCCLUSION_TILE_HEIGHT - 1);
+
+    for (int y = y0; y <= y1; y++) {
+        float py = (float)y + 0.5f;
+        float* row = &depthBuffer[y * OCCLUSION_WIDTH];
+        int x = x0;
+#ifdef OCCLUSION_SSE
+        __m128 laneX = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        __m128 zero = _mm_setzero_ps();
+        for (; x <= x1; x += 4) {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneX);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), px), _mm_set1_ps(b[0] * py + c[0]));
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[1]), px), _mm_set1_ps(b[1] * py + c[1]));
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2]), px), _mm_set1_ps(b[2] * py + c[2]));
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+            if (_mm_movemask_ps(inside) == 0) continue;
+
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(za), px), _mm_set1_ps(zb * py + zc));
+            __m128 depth = _mm_loadu_ps(row + x);
+            __m128 nearer = _mm_max_ps(depth, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, depth)));
+        }
+#else
+        for (; x <= x1; x++) {
+            float px = (float)x + 0.5f;
+            if (a[0] * px + (b[0] * py + c[0]) < 0.0f || a[1] * px + (b[1] * py + c[1]) < 0.0f ||
+                a[2] * px + (b[2] * py + c[2]) < 0.0f) continue;
+            float z = za * px + zb * py + zc;
+            if (z > row[x]) row[x] = z;
+        }
+#endif
+    }
+}
+
+static void RasterizeTile(int tile) {
+    int tileX0 = (tile % tilesX) * OCCLUSION_TILE_WIDTH;
+    int tileY0 = (tile / tilesX) * OCCLUSION_TILE_HEIGHT;
+    for (int y = tileY0; y < tileY0 + OCCLUSION_TILE_HEIGHT; y++) {
+        std::fill_n(&depthBuffer[y * OCCLUSION_WIDTH + tileX0], OCCLUSION_TILE_WIDTH, 0.0f);
+    }
+
+    for (int index : tileBins[tile]) RasterizeTriangle(&screenTriangles[index], tileX0, tileY0);
+
+    float farthest = FLT_MAX;
+    for (int y = tileY0; y < tileY0 + OCCLUSION_TILE_HEIGHT; y++) {
+        const float* row = &depthBuffer[y * OCCLUSION_WIDTH + tileX0];
+        for (int x = 0; x < OCCLUSION_TILE_WIDTH; x++) farthest = std::min(farthest, row[x]);
+    }
+    tileFarthest[tile] = farthest;
+}
+
+// Project on the workers, bin serially, then fill the tiles on the workers
+static int RasterizeOccluders(const Matrix& viewProj) {
+    int triangleCount = (int)screenTriangles.size();
+    ParallelFor(triangleCount, 256, [&viewProj](int begin, int end) {
+        for (int i = begin; i < end; i++) SetupTriangle(i, viewProj);
+    });
+
+    for (std::vector<int>& bin : tileBins) bin.clear();
+    int rasterized = 0;
+    for (int i = 0; i < triangleCount; i++) {
+        const ScreenTriangle* tri = &screenTriangles[i];
+        if (!tri->valid) continue;
+        rasterized++;
+        for (int ty = tri->minY / OCCLUSION_TILE_HEIGHT; ty <= tri->maxY / OCCLUSION_TILE_HEIGHT; ty++) {
+            for (int tx = tri->minX / OCCLUSION_TILE_WIDTH; tx <= tri->maxX / OCCLUSION_TILE_WIDTH; tx++) {
+                tileBins[ty * tilesX + tx].push_back(i);
+            }
+        }
+    }
+
+    ParallelFor(tilesX * tilesY, 1, [](int begin, int end) {
+        for (int tile = begin; tile < end; tile++) RasterizeTile(tile);
+    });
+    return rasterized;
+}
+
+// Hidden when every pixel the box touches holds an occluder nearer than the box's nearest corner
+static bool IsBoxOccluded(BoundingBox box, const Matrix& viewProj) {
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float nearest = 0.0f;
+    for (int i = 0; i < 8; i++) {
+        Vector3 corner = {
+            (i & 1) ? box.max.x : box.min.x,
+            (i & 2) ? box.max.y : box.min.y,
+            (i & 4) ? box.max.z : box.min.z
+        };
+        Vector4 clip = ToClip(corner, viewProj);
+        if (clip.w < OCCLUSION_NEAR) return false;
+        float invW = 1.0f / clip.w;
+        float x = (clip.x * invW * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+        float y = (clip.y * invW * 0.5f + 0.5f) * bufferHeight;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearest = std::max(nearest, invW);
+    }
+
+    int x0 = std::max(0, (int)floorf(minX));
+    int x1 = std::min(OCCLUSION_WIDTH - 1, (int)floorf(maxX));
+    int y0 = std::max(0, (int)floorf(minY));
+    int y1 = std::min(bufferHeight - 1, (int)floorf(maxY));
+    if (x0 > x1 || y0 > y1) return false;
+
+    // An occluder must be nearer than this everywhere under the box
+    float threshold = nearest * (1.0f + OCCLUSION_DEPTH_BIAS);
+    for (int ty = y0 / OCCLUSION_TILE_HEIGHT; ty <= y1 / OCCLUSION_TILE_HEIGHT; ty++) {
+        for (int tx = x0 / OCCLUSION_TILE_WIDTH; tx <= x1 / OCCLUSION_TILE_WIDTH; tx++) {
+            if (tileFarthest[ty * tilesX + tx] > threshold) continue;
+
+            int rx0 = std::max(x0, tx * OCCLUSION_TILE_WIDTH);
+            int rx1 = std::min(x1, tx * OCCLUSION_TILE_WIDTH + OCCLUSION_TILE_WIDTH - 1);
+            int ry0 = std::max(y0, ty * OCCLUSION_TILE_HEIGHT);
+            int ry1 = std::min(y1, ty * OCCLUSION_TILE_HEIGHT + OCCLUSION_TILE_HEIGHT - 1);
+            for (int y = ry0; y <= ry1; y++) {
+                const float* row = &depthBuffer[y * OCCLUSION_WIDTH];
+                int x = rx0;
+#ifdef OCCLUSION_SSE
+                __m128 limit = _mm_set1_ps(threshold);
+                for (; x + 3 <= rx1; x += 4) {
+                    if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(row + x), limit)) != 0) return false;
+                }
+#endif
+                for (; x <= rx1; x++) {
+                    if (row[x] <= threshold) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void CullOccludedMeshes(Camera3D camera, float aspect, VisibleMeshes* visible) {
+    if (!enableOcclusionCulling || screenTriangles.empty() || visible->meshes.empty()) return;
+    double start = GetTime();
+
+    // Same projection as the frustum test; the buffer keeps the view's aspect
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    Matrix viewProj = MatrixMultiply(view, projection);
+    int tileRows = (int)roundf((float)OCCLUSION_WIDTH / aspect / (float)OCCLUSION_TILE_HEIGHT);
+    ResizeBuffer(std::min(std::max(tileRows, 1) * OCCLUSION_TILE_HEIGHT, OCCLUSION_MAX_HEIGHT));
+
+    visible->stats.occluderTriangles = RasterizeOccluders(viewProj);
+
+    int count = (int)visible->meshes.size();
+    meshOccluded.resize(count);
+    ParallelFor(count, 32, [visible, &viewProj](int begin, int end) {
+        for (int i = begin; i < end; i++) meshOccluded[i] = IsBoxOccluded(GetMeshCullBox(visible->meshes[i]), viewProj);
+    });
+
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        int mesh = visible->meshes[i];
+        if (meshOccluded[i]) {
+            visible->stats.meshesOccluded++;
+            visible->stats.trianglesOccluded += GetMeshTriangleCount(mesh);
+            visible->stats.trianglesVisible -= GetMeshTriangleCount(mesh);
+            continue;
+        }
+        visible->meshes[kept++] = mesh;
+    }
+    visible->meshes.resize(kept);
+    visible->stats.meshesVisible = kept;
+    visible->stats.occlusionMs = (GetTime() - start) * 1000.0;
+}
+
+const OccluderInfo* GetOccluderInfo() {
+    return &info;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "scene_culling.h"
+
+// Occlusion culling: a few large meshes picked at load time are rasterized on the CPU into a small
+// depth buffer of 1/w values, split into tiles the job system fills in parallel. Meshes that survived
+// frustum culling are dropped when their box lies behind every depth sample it covers.
+#define OCCLUSION_WIDTH 256
+#define OCCLUSION_MAX_HEIGHT 256           // height follows the view's aspect
+#define OCCLUSION_TILE_WIDTH 32            // multiple of 4, the SSE row width
+#define OCCLUSION_TILE_HEIGHT 16
+#define OCCLUSION_NEAR 0.1f                // occluders and boxes closer than this are not trusted
+#define OCCLUSION_DEPTH_BIAS 0.002f        // relative margin a box must sit behind the occluders
+#define OCCLUDER_MAX_MESHES 32
+#define OCCLUDER_MAX_TRIANGLES 4096        // per mesh; denser meshes cost more to rasterize than they hide
+#define OCCLUDER_TRIANGLE_BUDGET 24576
+
+typedef struct {
+    int meshes;
+    int triangles;
+} OccluderInfo;
+
+extern bool enableOcclusionCulling;
+
+// Pick the occluders by world-space surface area and keep their triangles in world space
+void BuildOccluders(Model model);
+void UnloadOccluders();
+
+// Rasterize the occluders for this view and drop the meshes in visible they completely hide
+void CullOccludedMeshes(Camera3D camera, float aspect, VisibleMeshes* visible);
+
+const OccluderInfo* GetOccluderInfo();
@@ -0,0 +1,280 @@
+#include "profiler.h"
+#include "raylib.h"
+#include "rlgl.h"
+#include "imgui.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PROFILER_MAX_DEPTH 16
+#define PROFILER_QUERY_COUNT (2 + PROFILER_MAX_SCOPES * 2)
+
+bool profilerEnabled = true;
+bool profilerBlockingResolve = false;
+
+// Timestamp queries per set: [0] frame start, [1] frame end, then a start/end pair per scope
+static GLuint queries[PROFILER_QUERY_BUFFERS][PROFILER_QUERY_COUNT];
+static ProfilerFrame pendingFrames[PROFILER_QUERY_BUFFERS];
+static bool pending[PROFILER_QUERY_BUFFERS];
+static int writeSet = 0;
+
+static int scopeStack[PROFILER_MAX_DEPTH];
+static int stackDepth = 0;
+static ProfilerFrame* currentFrame = NULL;
+static double cpuEpoch = 0.0;
+static GLuint64 gpuEpoch = 0;
+static bool hasGpuEpoch = false;
+static unsigned int frameCounter = 0;
+static unsigned int droppedFrames = 0;
+static bool warnedScopeLimit = false;
+static bool initialized = false;
+
+// Resolved frames, oldest overwritten first
+static ProfilerFrame history[PROFILER_HISTORY_FRAMES];
+static int historyHead = 0;
+static int historyCount = 0;
+static ProfilerFrame lastFrame;
+
+static double CpuNowMs() {
+    return (GetTime() - cpuEpoch) * 1000.0;
+}
+
+static GLuint64 ReadTimestamp(GLuint query) {
+    GLuint64 value = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &value);
+    return value;
+}
+
+// Read back a query set; without wait, gives up if the GPU has not reached the frame end yet
+static bool ResolveQuerySet(int set, bool wait) {
+    if (!pending[set]) return false;
+
+    GLuint* setQueries = queries[set];
+    if (!wait) {
+        // Queries complete in order, so the frame-end stamp being ready implies all are
+        GLint available = 0;
+        glGetQueryObjectiv(setQueries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return false;
+    }
+
+    ProfilerFrame* frame = &pendingFrames[set];
+    GLuint64 frameStart = ReadTimestamp(setQueries[0]);
+    GLuint64 frameEnd = ReadTimestamp(setQueries[1]);
+    if (!hasGpuEpoch) {
+        gpuEpoch = frameStart;
+        hasGpuEpoch = true;
+    }
+
+    frame->gpuStartMs = (double)(frameStart - gpuEpoch) / 1.0e6;
+    frame->gpuFrameMs = (double)(frameEnd - frameStart) / 1.0e6;
+
+    for (int i = 0; i < frame->scopeCount; i++) {
+        GLuint64 start = ReadTimestamp(setQueries[2 + i * 2]);
+        GLuint64 end = ReadTimestamp(setQueries[2 + i * 2 + 1]);
+        frame->scopes[i].gpuStartMs = (double)(start - gpuEpoch) / 1.0e6;
+        frame->scopes[i].gpuMs = (double)(end - start) / 1.0e6;
+    }
+
+    pending[set] = false;
+    lastFrame = *frame;
+    history[historyHead] = *frame;
+    historyHead = (historyHead + 1) % PROFILER_HISTORY_FRAMES;
+    if (historyCount < PROFILER_HISTORY_FRAMES) historyCount++;
+    return true;
+}
+
+// i = 0 is the oldest frame in the history ring
+static const ProfilerFrame* HistoryAt(int i) {
+    int index = (historyHead - historyCount + i + PROFILER_HISTORY_FRAMES) % PROFILER_HISTORY_FRAMES;
+    return &history[index];
+}
+
+static const ProfilerScope* FindScope(const ProfilerFrame* frame, int hint, const char* name) {
+    if (hint < frame->scopeCount && strcmp(frame->scopes[hint].name, name) == 0) return &frame->scopes[hint];
+    for (int i = 0; i < frame->scopeCount; i++) {
+        if (strcmp(frame->scopes[i].name, name) == 0) return &frame->scopes[i];
+    }
+    return NULL;
+}
+
+void InitializeProfiler() {
+    if (initialized) return;
+    for (int i = 0; i < PROFILER_QUERY_BUFFERS; i++) {
+        glGenQueries(PROFILER_QUERY_COUNT, queries[i]);
+        pending[i] = false;
+    }
+    memset(&lastFrame, 0, sizeof(lastFrame));
+    cpuEpoch = GetTime();
+    initialized = true;
+}
+
+void UnloadProfiler() {
+    if (!initialized) return;
+    for (int i = 0; i < PROFILER_QUERY_BUFFERS; i++) {
+        glDeleteQueries(PROFILER_QUERY_COUNT, queries[i]);
+    }
+    initialized = false;
+}
+
+void ProfilerBeginFrame() {
+    if (!profilerEnabled || !initialized) return;
+
+    // The set we are about to overwrite is PROFILER_QUERY_BUFFERS frames old; drop it rather than stall
+    if (pending[writeSet] && !ResolveQuerySet(writeSet, false)) {
+        pending[writeSet] = false;
+        droppedFrames++;
+    }
+
+    // Make sure work queued before the frame is not attributed to it
+    rlDrawRenderBatchActive();
+    glQueryCounter(queries[writeSet][0], GL_TIMESTAMP);
+
+    currentFrame = &pendingFrames[writeSet];
+    currentFrame->scopeCount = 0;
+    currentFrame->frameIndex = frameCounter++;
+    currentFrame->cpuStartMs = CpuNowMs();
+    stackDepth = 0;
+}
+
+void ProfilerEndFrame() {
+    if (currentFrame == NULL) return;
+
+    rlDrawRenderBatchActive();
+    glQueryCounter(queries[writeSet][1], GL_TIMESTAMP);
+    currentFrame->cpuFrameMs = CpuNowMs() - currentFrame->cpuStartMs;
+    currentFrame = NULL;
+
+    int set = writeSet;
+    pending[set] = true;
+    writeSet = (writeSet + 1) % PROFILER_QUERY_BUFFERS;
+
+    if (profilerBlockingResolve) {
+        ResolveQuerySet(set, true);
+    } else {
+        // Pick up older frames as soon as they are ready
+        for (int i = 1; i < PROFILER_QUERY_BUFFERS; i++) {
+            ResolveQuerySet((set + i) % PROFILER_QUERY_BUFFERS, false);
+        }
+    }
+}
+
+void ProfilerBeginScope(const char* name) {
+    if (currentFrame == NULL || stackDepth >= PROFILER_MAX_DEPTH) return;
+
+    int index = -1;
+    if (currentFrame->scopeCount < PROFILER_MAX_SCOPES) {
+        index = currentFrame->scopeCount++;
+
+        ProfilerScope* scope = &currentFrame->scopes[index];
+        snprintf(scope->name, sizeof(scope->name), "%s", name);
+        scope->depth = stackDepth;
+        scope->cpuMs = 0.0;
+        scope->gpuMs = 0.0;
+
+        // raylib batches draws, so flush before stamping to time only this scope's work
+        rlDrawRenderBatchActive();
+        glQueryCounter(queries[writeSet][2 + index * 2], GL_TIMESTAMP);
+        scope->cpuStartMs = CpuNowMs();
+    } else if (!warnedScopeLimit) {
+        // Still pushed, so the matching ProfilerEndScope pops it
+        TraceLog(LOG_WARNING, "PROFILER: More than %d scopes in frame %u, %s and later scopes are not timed",
+                 PROFILER_MAX_SCOPES, currentFrame->frameIndex, name);
+        warnedScopeLimit = true;
+    }
+
+    scopeStack[stackDepth++] = index;
+}
+
+void ProfilerEndScope() {
+    if (currentFrame == NULL || stackDepth == 0) return;
+
+    int index = scopeStack[--stackDepth];
+    if (index < 0) return;
+
+    rlDrawRenderBatchActive();
+    glQueryCounter(queries[writeSet][2 + index * 2 + 1], GL_TIMESTAMP);
+
+    ProfilerScope* scope = &currentFrame->scopes[index];
+    scope->cpuMs = CpuNowMs() - scope->cpuStartMs;
+}
+
+const ProfilerFrame* ProfilerGetLastFrame() {
+    return &lastFrame;
+}
+
+static void WriteTraceEvent(FILE* file, bool* first, const char* name, int tid, double startMs, double durationMs) {
+    fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+            *first ? "" : ",", name, tid, startMs * 1000.0, durationMs * 1000.0);
+    *first = false;
+}
+
+// Write the frame history in chrome://tracing (Trace Event) JSON format; CPU on thread 1, GPU on thread 2
+bool ProfilerExportTrace(const char* fileName) {
+    FILE* file = fopen(fileName, "w");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "PROFILER: Failed to open %s for writing", fileName);
+        return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[");
+    fprintf(file, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}}");
+    fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+    bool first = false;
+    for (int i = 0; i < historyCount; i++) {
+        const ProfilerFrame* frame = HistoryAt(i);
+
+        char frameName[PROFILER_NAME_LENGTH];
+        snprintf(frameName, sizeof(frameName), "frame_%u", frame->frameIndex);
+        WriteTraceEvent(file, &first, frameName, 1, frame->cpuStartMs, frame->cpuFrameMs);
+        WriteTraceEvent(file, &first, frameName, 2, frame->gpuStartMs, frame->gpuFrameMs);
+
+        for (int s = 0; s < frame->scopeCount; s++) {
+            const ProfilerScope* scope = &frame->scopes[s];
+            WriteTraceEvent(file, &first, scope->name, 1, scope->cpuStartMs, scope->cpuMs);
+            WriteTraceEvent(file, &first, scope->name, 2, scope->gpuStartMs, scope->gpuMs);
+        }
+    }
+
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+
+    TraceLog(LOG_INFO, "PROFILER: Wrote %d frames to %s", historyCount, fileName);
+    return true;
+}
+
+// Rolling CPU/GPU graphs for the frame and every scope of the last resolved frame
+void DrawProfilerUI() {
+    if (ImGui::Begin("Profiler")) {
+        ImGui::Checkbox("Enabled", &profilerEnabled);
+        ImGui::SameLine();
+        if (ImGui::Button("Export Trace (F9)")) {
+            ProfilerExportTrace("profiler_trace.json");
+        }
+        ImGui::Text("Frame: %.3f ms CPU / %.3f ms GPU", lastFrame.cpuFrameMs, lastFrame.gpuFrameMs);
+        ImGui::Text("History: %d frames, dropped: %u", historyCount, droppedFrames);
+
+        static float values[PROFILER_HISTORY_FRAMES];
+        for (int i = 0; i < historyCount; i++) values[i] = (float)HistoryAt(i)->cpuFrameMs;
+        ImGui::PlotLines("CPU ms", values, historyCount, 0, NULL, 0.0f, 3.4e38f, ImVec2(0, 40));
+        for (int i = 0; i < historyCount; i++) values[i] = (float)HistoryAt(i)->gpuFrameMs;
+        ImGui::PlotLines("GPU ms", values, historyCount, 0, NULL, 0.0f, 3.4e38f, ImVec2(0, 40));
+
+        ImGui::Separator();
+        for (int s = 0; s < lastFrame.scopeCount; s++) {
+            const ProfilerScope* scope = &lastFrame.scopes[s];
+            ImGui::Text("%*s%-20s cpu %7.3f  gpu %7.3f", scope->depth * 2, "", scope->name, scope->cpuMs, scope->gpuMs);
+
+            // Graph top-level passes only; nested scopes are covered by their parent
+            if (scope->depth != 0) continue;
+            for (int i = 0; i < historyCount; i++) {
+                const ProfilerScope* past = FindScope(HistoryAt(i), s, scope->name);
+                values[i] = (past != NULL) ? (float)past->gpuMs : 0.0f;
+            }
+            char label[PROFILER_NAME_LENGTH + 2];
+            snprintf(label, sizeof(label), "##%s", scope->name);
+            ImGui::PlotLines(label, values, historyCount, 0, NULL, 0.0f, 3.4e38f, ImVec2(0, 24));
+        }
+    }
+    ImGui::End();
+}
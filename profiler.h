@@ -0,0 +1,42 @@
+#pragma once
+
+#define PROFILER_MAX_SCOPES 128       // per frame; scopes past it are not timed, with one warning
+#define PROFILER_NAME_LENGTH 32
+#define PROFILER_QUERY_BUFFERS 2      // timer query sets in flight, resolved without stalling
+#define PROFILER_HISTORY_FRAMES 300   // frames kept for graphs and trace export
+
+// CPU and GPU timings of one instrumented pass
+typedef struct {
+    char name[PROFILER_NAME_LENGTH];
+    int depth;
+    double cpuStartMs;   // relative to profiler start
+    double cpuMs;
+    double gpuStartMs;   // relative to the first resolved GPU timestamp
+    double gpuMs;
+} ProfilerScope;
+
+// Timings of every pass recorded during one frame
+typedef struct {
+    ProfilerScope scopes[PROFILER_MAX_SCOPES];
+    int scopeCount;
+    unsigned int frameIndex;
+    double cpuStartMs;
+    double cpuFrameMs;
+    double gpuStartMs;
+    double gpuFrameMs;
+} ProfilerFrame;
+
+// Scopes are no-ops while the profiler is disabled
+extern bool profilerEnabled;
+// Wait for GPU results at the end of every frame instead of reading them a frame later
+extern bool profilerBlockingResolve;
+
+void InitializeProfiler();
+void UnloadProfiler();
+void ProfilerBeginFrame();
+void ProfilerEndFrame();
+void ProfilerBeginScope(const char* name);
+void ProfilerEndScope();
+const ProfilerFrame* ProfilerGetLastFrame();
+bool ProfilerExportTrace(const char* fileName);
+void DrawProfilerUI();
@@ -0,0 +1,214 @@
+#include "render_queue.h"
+#include "draw_constants.h"
+#include "external/glad.h"
+#include <vector>
+#include <algorithm>
+
+// raylib's MAX_MATERIAL_MAPS lives in its private config.h; the public map enum ends at BRDF
+#define QUEUE_MATERIAL_MAPS (MATERIAL_MAP_BRDF + 1)
+
+bool enableMaterialSort = true;
+
+// Sort key: shader (16 bits) | diffuse texture (24 bits) | material (24 bits). Shaders and textures
+// enter as dense per-queue indices: their GL names can outgrow the fields, the count in one queue cannot.
+typedef struct {
+    uint64_t key;
+    int mesh;
+    int material;
+} DrawItem;
+
+static std::vector<DrawItem> queueItems;
+static Model queueModel;
+static Shader queueShader;
+static bool queueHasOverride = false;
+static std::vector<unsigned int> queueShaderIds, queueTextureIds;   // index -> GL name, in order of first use
+static RenderQueueStats queueStats = { 0 };
+
+// Texture currently bound to each material map slot while a queue or batch is submitted
+static unsigned int boundTextures[QUEUE_MATERIAL_MAPS];
+
+void BeginRenderQueue(Model model, const Shader* shaderOverride) {
+    queueItems.clear();
+    queueShaderIds.clear();
+    queueTextureIds.clear();
+    queueModel = model;
+    queueHasOverride = (shaderOverride != NULL);
+    if (queueHasOverride) queueShader = *shaderOverride;
+}
+
+// A queue sees a few dozen distinct ids at most, so a linear search is enough
+static uint64_t DenseIndex(std::vector<unsigned int>* ids, unsigned int id) {
+    for (size_t i = 0; i < ids->size(); i++) {
+        if ((*ids)[i] == id) return i;
+    }
+    ids->push_back(id);
+    return ids->size() - 1;
+}
+
+void PushDrawItem(int meshIndex) {
+    int material = queueModel.meshMaterial[meshIndex];
+    Shader shader = queueHasOverride ? queueShader : queueModel.materials[material].shader;
+    unsigned int texture = queueModel.materials[material].maps[MATERIAL_MAP_DIFFUSE].texture.id;
+
+    DrawItem item;
+    item.key = (DenseIndex(&queueShaderIds, shader.id) << 48) | (DenseIndex(&queueTextureIds, texture) << 24) | (uint64_t)material;
+    item.mesh = meshIndex;
+    item.material = material;
+    queueItems.push_back(item);
+}
+
+// View/projection are per shader; model-dependent matrices are set per draw
+static void BindShader(Shader shader, Matrix view, Matrix projection) {
+    rlEnableShader(shader.id);
+    if (shader.locs[SHADER_LOC_MATRIX_VIEW] != -1) rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_VIEW], view);
+    if (shader.locs[SHADER_LOC_MATRIX_PROJECTION] != -1) rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_PROJECTION], projection);
+    for (int i = 0; i < QUEUE_MATERIAL_MAPS; i++) boundTextures[i] = 0;
+    queueStats.shaderBinds++;
+}
+
+// Same map bindings DrawMesh makes, skipping textures already bound to their slot
+static void BindMaterial(Shader shader, const Material* material) {
+    if (shader.locs[SHADER_LOC_COLOR_DIFFUSE] != -1) {
+        Color color = material->maps[MATERIAL_MAP_DIFFUSE].color;
+        float values[4] = { color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f };
+        rlSetUniform(shader.locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+    }
+
+    for (int i = 0; i < QUEUE_MATERIAL_MAPS; i++) {
+        int location = shader.locs[SHADER_LOC_MAP_DIFFUSE + i];
+        unsigned int texture = material->maps[i].texture.id;
+        if (location == -1 || texture == 0 || boundTextures[i] == texture) continue;
+
+        rlActiveTextureSlot(i);
+        if (i == MATERIAL_MAP_IRRADIANCE || i == MATERIAL_MAP_PREFILTER || i == MATERIAL_MAP_CUBEMAP) rlEnableTextureCubemap(texture);
+        else rlEnableTexture(texture);
+        rlSetUniform(location, &i, SHADER_UNIFORM_INT, 1);
+        boundTextures[i] = texture;
+        queueStats.textureBinds++;
+    }
+    queueStats.materialBinds++;
+}
+
+static void UnbindTextures() {
+    for (int i = 0; i < QUEUE_MATERIAL_MAPS; i++) {
+        if (boundTextures[i] == 0) continue;
+        rlActiveTextureSlot(i);
+        if (i == MATERIAL_MAP_IRRADIANCE || i == MATERIAL_MAP_PREFILTER || i == MATERIAL_MAP_CUBEMAP) rlDisableTextureCubemap();
+        else rlDisableTexture();
+        boundTextures[i] = 0;
+    }
+    rlActiveTextureSlot(0);
+}
+
+// Sort and draw the queued meshes (inside BeginMode3D), rebinding only what changes between items.
+// Queue shaders read their matrices from DrawBlock (default.vs, depth.vs).
+void FlushRenderQueue() {
+    if (queueItems.empty()) return;
+
+    if (enableMaterialSort) {
+        std::sort(queueItems.begin(), queueItems.end(), [](const DrawItem& a, const DrawItem& b) { return a.key < b.key; });
+    }
+
+    rlDrawRenderBatchActive();
+    Matrix view = rlGetMatrixModelview();
+    Matrix projection = rlGetMatrixProjection();
+
+    // Every mesh of the model shares one transform: one DrawBlock serves the whole queue
+    PushDrawConstants(MatrixMultiply(queueModel.transform, rlGetMatrixTransform()), view, projection);
+
+    unsigned int currentShader = 0;
+    int currentMaterial = -1;
+    for (int i = 0; i < (int)queueItems.size(); i++) {
+        const DrawItem* item = &queueItems[i];
+        const Material* material = &queueModel.materials[item->material];
+        Shader shader = queueHasOverride ? queueShader : material->shader;
+
+        if (shader.id != currentShader) {
+            UnbindTextures();
+            BindShader(shader, view, projection);
+            currentShader = shader.id;
+            currentMaterial = -1;
+        }
+        if (item->material != currentMaterial) {
+            BindMaterial(shader, material);
+            currentMaterial = item->material;
+        }
+
+        const Mesh* mesh = &queueModel.meshes[item->mesh];
+        rlEnableVertexArray(mesh->vaoId);
+        if (mesh->indices != NULL) rlDrawVertexArrayElements(0, mesh->triangleCount * 3, 0);
+        else rlDrawVertexArray(0, mesh->vertexCount);
+        queueStats.draws++;
+    }
+
+    rlDisableVertexArray();
+    UnbindTextures();
+    rlDisableShader();
+    queueItems.clear();
+}
+
+// Attach a per-instance vertex buffer of vec4Attributes vec4s to the mesh's VAO
+InstanceBatch LoadInstanceBatch(Mesh mesh, int capacity, int instanceStride, int vec4Attributes) {
+    InstanceBatch batch = { 0 };
+    batch.mesh = mesh;
+    batch.capacity = capacity;
+    batch.stride = instanceStride;
+
+    glGenBuffers(1, &batch.vbo);
+    glBindVertexArray(mesh.vaoId);
+    glBindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * instanceStride, NULL, GL_DYNAMIC_DRAW);
+    for (int i = 0; i < vec4Attributes; i++) {
+        GLuint location = INSTANCE_ATTRIB_LOCATION + i;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, instanceStride, (const void*)(size_t)(i * 4 * sizeof(float)));
+        glVertexAttribDivisor(location, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return batch;
+}
+
+void UnloadInstanceBatch(InstanceBatch* batch) {
+    glDeleteBuffers(1, &batch->vbo);
+    batch->vbo = 0;
+}
+
+// Stream the instance data and draw every instance in one call (inside BeginMode3D)
+void DrawInstanceBatch(InstanceBatch* batch, Material material, const void* instances, int count) {
+    if (count <= 0) return;
+    if (count > batch->capacity) count = batch->capacity;
+
+    rlDrawRenderBatchActive();
+
+    // Orphan the previous contents so the upload never waits on last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, batch->vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)batch->capacity * batch->stride, NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)count * batch->stride, instances);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    Shader shader = material.shader;
+    BindShader(shader, rlGetMatrixModelview(), rlGetMatrixProjection());
+    BindMaterial(shader, &material);
+
+    rlEnableVertexArray(batch->mesh.vaoId);
+    if (batch->mesh.indices != NULL) rlDrawVertexArrayElementsInstanced(0, batch->mesh.triangleCount * 3, 0, count);
+    else rlDrawVertexArrayInstanced(0, batch->mesh.vertexCount, count);
+    rlDisableVertexArray();
+
+    UnbindTextures();
+    rlDisableShader();
+
+    queueStats.draws++;
+    queueStats.instancedDraws++;
+    queueStats.instances += count;
+}
+
+void ResetRenderQueueStats() {
+    queueStats = RenderQueueStats{ 0 };
+}
+
+const RenderQueueStats* GetRenderQueueStats() {
+    return &queueStats;
+}
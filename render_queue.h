@@ -0,0 +1,38 @@
+#pragma once
+
+#include "renderer.h"
+#include <stdint.h>
+
+#define INSTANCE_ATTRIB_LOCATION 10   // first vertex attribute used for per-instance vec4s, clear of raylib's defaults
+
+// State changes made by the render queue since the last reset
+typedef struct {
+    int draws;
+    int shaderBinds;
+    int materialBinds;
+    int textureBinds;
+    int instancedDraws;
+    int instances;
+} RenderQueueStats;
+
+// Shared mesh drawn once per instance, with instance data streamed into its own vertex buffer
+typedef struct {
+    Mesh mesh;
+    unsigned int vbo;
+    int capacity;
+    int stride;
+} InstanceBatch;
+
+extern bool enableMaterialSort;
+
+// Collect a model's meshes, then submit them sorted by shader, texture and material
+void BeginRenderQueue(Model model, const Shader* shaderOverride);
+void PushDrawItem(int meshIndex);
+void FlushRenderQueue();
+
+InstanceBatch LoadInstanceBatch(Mesh mesh, int capacity, int instanceStride, int vec4Attributes);
+void UnloadInstanceBatch(InstanceBatch* batch);
+void DrawInstanceBatch(InstanceBatch* batch, Material material, const void* instances, int count);
+
+void ResetRenderQueueStats();
+const RenderQueueStats* GetRenderQueueStats();
@@ -0,0 +1,714 @@
+#include "renderer.h"
+#include "asset_loader.h"
+#include "shadow_atlas.h"
+#include "light_buffer.h"
+#include "light_animation.h"
+#include "rlgl.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Render service: renders one image per JSON request line on stdin and answers with one JSON line on stdout.
+// Requests that arrive together are grouped by output size so the render targets are only reallocated
+// between groups, and the readback and PNG encoding of one request overlap the rendering of the next.
+//
+// Request:  {"id": "a", "width": 320, "height": 180, "camera": {"position": [x, y, z], "target": [x, y, z], "fovy": 45},
+//            "lights": 8, "light_overrides": [{"index": 0, "position": [x, y, z], "color": [r, g, b], "intensity": 2, "range": 4}],
+//            "output": "thumbs/a.png"}
+// Response: {"id": "a", "status": "ok", "cached": false, "output": "thumbs/a.png", "width": 320, "height": 180,
+//            "latency_ms": 41.2, "render_ms": 12.0, "encode_ms": 9.5}
+// Every field but id is optional; without an output the image goes to <out dir>/<request hash>.png.
+// Usage: raylib_render_service [--batch N] [--out DIR]   (run from the directory that holds resources/)
+
+#define SERVICE_MAX_SIZE 4096
+#define SERVICE_CACHE_ENTRIES 32       // encoded results kept by request hash
+#define SERVICE_MAX_LINE (64 * 1024)
+
+typedef struct {
+    int batchSize;
+    const char* outDir;
+} ServiceOptions;
+
+// Light override fields present in the request
+enum {
+    OVERRIDE_POSITION = 1,
+    OVERRIDE_COLOR = 2,
+    OVERRIDE_INTENSITY = 4,
+    OVERRIDE_RANGE = 8
+};
+
+typedef struct {
+    int index;
+    int fields;
+    Vector3 position;
+    Vector3 color;
+    float intensity;
+    float range;
+} LightOverride;
+
+struct RenderRequest {
+    std::string id;
+    std::string output;
+    std::string error;    // set when the line could not be used
+    int width = 512;
+    int height = 512;
+    Vector3 position = { -8.0f, 2.0f, 0.0f };
+    Vector3 target = { 0.0f, 1.8f, 0.0f };
+    float fovy = 45.0f;
+    int lights = DEFAULT_LIGHTS;
+    std::vector<LightOverride> overrides;
+    uint64_t hash = 0;
+    double receivedMs = 0.0;
+};
+
+// A readback in flight: the request's pixels land in pbo once fence signals
+struct Readback {
+    GLuint pbo = 0;
+    int bytes = 0;
+    GLsync fence = NULL;
+    RenderRequest request;
+    double renderMs = 0.0;
+};
+
+struct EncodeJob {
+    RenderRequest request;
+    std::vector<unsigned char> pixels;   // bottom-up RGBA rows
+    double renderMs;
+};
+
+struct CachedResult {
+    uint64_t hash;
+    std::vector<unsigned char> png;
+};
+
+static std::mutex requestMutex;
+static std::condition_variable requestWake;
+static std::deque<RenderRequest> pendingRequests;
+static bool inputClosed = false;
+
+static std::mutex encodeMutex;
+static std::condition_variable encodeWake;
+static std::deque<EncodeJob> encodeJobs;
+static bool encodeStopping = false;
+
+static std::mutex cacheMutex;
+static std::deque<CachedResult> cache;   // oldest first
+
+static std::mutex outputMutex;
+
+static int requestsServed = 0;
+static int cacheHits = 0;
+static int renders = 0;
+static int sizeChanges = 0;
+static double latencyTotalMs = 0.0;
+
+static double NowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- JSON -----------------------------------------------------------------------------------------------
+
+typedef enum { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT } JsonType;
+
+struct JsonValue {
+    JsonType type = JSON_NULL;
+    double number = 0.0;
+    std::string text;
+    std::vector<std::string> keys;   // objects: keys[i] names items[i]
+    std::vector<JsonValue> items;
+};
+
+static void SkipSpace(const char** cursor) {
+    while (**cursor == ' ' || **cursor == '\t' || **cursor == '\r' || **cursor == '\n') (*cursor)++;
+}
+
+static bool ParseJsonString(const char** cursor, std::string* out) {
+    if (**cursor != '"') return false;
+    (*cursor)++;
+    out->clear();
+    while (**cursor != '"') {
+        char c = **cursor;
+        if (c == '\0') return false;
+        (*cursor)++;
+        if (c != '\\') {
+            out->push_back(c);
+            continue;
+        }
+        char escape = **cursor;
+        (*cursor)++;
+        switch (escape) {
+        case '"': case '\\': case '/': out->push_back(escape); break;
+        case 'n': out->push_back('\n'); break;
+        case 't': out->push_back('\t'); break;
+        case 'r': out->push_back('\r'); break;
+        case 'b': out->push_back('\b'); break;
+        case 'f': out->push_back('\f'); break;
+        case 'u': {
+            // Only ASCII survives; ids and paths are expected to be plain
+            unsigned int code = 0;
+            for (int i = 0; i < 4; i++) {
+                char h = **cursor;
+                if (h == '\0') return false;
+                (*cursor)++;
+                code = code * 16 + (unsigned int)((h >= 'a') ? h - 'a' + 10 : (h >= 'A') ? h - 'A' + 10 : h - '0');
+            }
+            out->push_back(code < 128 ? (char)code : '?');
+            break;
+        }
+        default: return false;
+        }
+    }
+    (*cursor)++;
+    return true;
+}
+
+static bool ParseJsonValue(const char** cursor, JsonValue* out, int depth) {
+    if (depth > 16) return false;
+    SkipSpace(cursor);
+    const char* p = *cursor;
+
+    if (*p == '{' || *p == '[') {
+        bool object = (*p == '{');
+        char close = object ? '}' : ']';
+        out->type = object ? JSON_OBJECT : JSON_ARRAY;
+        (*cursor)++;
+        SkipSpace(cursor);
+        if (**cursor == close) {
+            (*cursor)++;
+            return true;
+        }
+        for (;;) {
+            if (object) {
+                SkipSpace(cursor);
+                std::string key;
+                if (!ParseJsonString(cursor, &key)) return false;
+                SkipSpace(cursor);
+                if (**cursor != ':') return false;
+                (*cursor)++;
+                out->keys.push_back(key);
+            }
+            out->items.emplace_back();
+            if (!ParseJsonValue(cursor, &out->items.back(), depth + 1)) return false;
+            SkipSpace(cursor);
+            if (**cursor == ',') {
+                (*cursor)++;
+                continue;
+            }
+            if (**cursor != close) return false;
+            (*cursor)++;
+            return true;
+        }
+    }
+    if (*p == '"') {
+        out->type = JSON_STRING;
+        return ParseJsonString(cursor, &out->text);
+    }
+    if (strncmp(p, "true", 4) == 0 || strncmp(p, "false", 5) == 0) {
+        out->type = JSON_BOOL;
+        out->number = (*p == 't') ? 1.0 : 0.0;
+        *cursor += (*p == 't') ? 4 : 5;
+        return true;
+    }
+    if (strncmp(p, "null", 4) == 0) {
+        out->type = JSON_NULL;
+        *cursor += 4;
+        return true;
+    }
+    char* end = NULL;
+    out->number = strtod(p, &end);
+    if (end == p) return false;
+    out->type = JSON_NUMBER;
+    *cursor = end;
+    return true;
+}
+
+static const JsonValue* JsonMember(const JsonValue* object, const char* key) {
+    if (object == NULL || object->type != JSON_OBJECT) return NULL;
+    for (size_t i = 0; i < object->keys.size(); i++) {
+        if (object->keys[i] == key) return &object->items[i];
+    }
+    return NULL;
+}
+
+static bool JsonNumber(const JsonValue* value, float* out) {
+    if (value == NULL || value->type != JSON_NUMBER) return false;
+    *out = (float)value->number;
+    return true;
+}
+
+static bool JsonVector3(const JsonValue* value, Vector3* out) {
+    if (value == NULL || value->type != JSON_ARRAY || value->items.size() != 3) return false;
+    float v[3];
+    for (int i = 0; i < 3; i++) {
+        if (!JsonNumber(&value->items[i], &v[i])) return false;
+    }
+    *out = Vector3{ v[0], v[1], v[2] };
+    return true;
+}
+
+static void AppendJsonString(std::string* out, const std::string& text) {
+    out->push_back('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') out->push_back('\\');
+        if ((unsigned char)c < 0x20) {
+            out->push_back('?');
+            continue;
+        }
+        out->push_back(c);
+    }
+    out->push_back('"');
+}
+
+// ---- Requests -------------------------------------------------------------------------------------------
+
+// FNV-1a, 64-bit
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Everything that changes the image, and nothing that does not (id, output path)
+static uint64_t HashRequest(const RenderRequest& request) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = HashBytes(hash, &request.width, sizeof(request.width));
+    hash = HashBytes(hash, &request.height, sizeof(request.height));
+    hash = HashBytes(hash, &request.position, sizeof(request.position));
+    hash = HashBytes(hash, &request.target, sizeof(request.target));
+    hash = HashBytes(hash, &request.fovy, sizeof(request.fovy));
+    hash = HashBytes(hash, &request.lights, sizeof(request.lights));
+    for (const LightOverride& light : request.overrides) {
+        hash = HashBytes(hash, &light.index, sizeof(light.index));
+        hash = HashBytes(hash, &light.fields, sizeof(light.fields));
+        if (light.fields & OVERRIDE_POSITION) hash = HashBytes(hash, &light.position, sizeof(light.position));
+        if (light.fields & OVERRIDE_COLOR) hash = HashBytes(hash, &light.color, sizeof(light.color));
+        if (light.fields & OVERRIDE_INTENSITY) hash = HashBytes(hash, &light.intensity, sizeof(light.intensity));
+        if (light.fields & OVERRIDE_RANGE) hash = HashBytes(hash, &light.range, sizeof(light.range));
+    }
+    return hash;
+}
+
+static RenderRequest ParseRequest(const std::string& line, int lineNumber, const char* outDir) {
+    RenderRequest request;
+    request.receivedMs = NowMs();
+    request.id = std::to_string(lineNumber);
+
+    JsonValue root;
+    const char* cursor = line.c_str();
+    if (!ParseJsonValue(&cursor, &root, 0) || root.type != JSON_OBJECT) {
+        request.error = "invalid JSON";
+        return request;
+    }
+
+    const JsonValue* id = JsonMember(&root, "id");
+    if (id != NULL && id->type == JSON_STRING) request.id = id->text;
+    else if (id != NULL && id->type == JSON_NUMBER) request.id = std::to_string((long long)id->number);
+
+    float number;
+    if (JsonNumber(JsonMember(&root, "width"), &number)) request.width = (int)number;
+    if (JsonNumber(JsonMember(&root, "height"), &number)) request.height = (int)number;
+    if (JsonNumber(JsonMember(&root, "lights"), &number)) request.lights = (int)number;
+    if (request.width < 1 || request.height < 1 || request.width > SERVICE_MAX_SIZE || request.height > SERVICE_MAX_SIZE) {
+        request.error = "width and height must be 1.." + std::to_string(SERVICE_MAX_SIZE);
+        return request;
+    }
+    if (request.lights < 1 || request.lights > GetLightCapacity()) {
+        request.error = "lights must be 1.." + std::to_string(GetLightCapacity());
+        return request;
+    }
+
+    const JsonValue* camera = JsonMember(&root, "camera");
+    JsonVector3(JsonMember(camera, "position"), &request.position);
+    JsonVector3(JsonMember(camera, "target"), &request.target);
+    JsonNumber(JsonMember(camera, "fovy"), &request.fovy);
+
+    const JsonValue* overrides = JsonMember(&root, "light_overrides");
+    if (overrides != NULL && overrides->type == JSON_ARRAY) {
+        for (const JsonValue& item : overrides->items) {
+            LightOverride light = { 0 };
+            float index;
+            if (!JsonNumber(JsonMember(&item, "index"), &index) || index < 0.0f || (int)index >= request.lights) {
+                request.error = "light override index out of range";
+                return request;
+            }
+            light.index = (int)index;
+            if (JsonVector3(JsonMember(&item, "position"), &light.position)) light.fields |= OVERRIDE_POSITION;
+            if (JsonVector3(JsonMember(&item, "color"), &light.color)) light.fields |= OVERRIDE_COLOR;
+            if (JsonNumber(JsonMember(&item, "intensity"), &light.intensity)) light.fields |= OVERRIDE_INTENSITY;
+            if (JsonNumber(JsonMember(&item, "range"), &light.range)) light.fields |= OVERRIDE_RANGE;
+            request.overrides.push_back(light);
+        }
+    }
+
+    request.hash = HashRequest(request);
+    const JsonValue* output = JsonMember(&root, "output");
+    if (output != NULL && output->type == JSON_STRING && !output->text.empty()) {
+        request.output = output->text;
+    } else {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%016llx.png", outDir, (unsigned long long)request.hash);
+        request.output = path;
+    }
+    return request;
+}
+
+static void Respond(const RenderRequest& request, bool cached, double renderMs, double encodeMs, const char* error) {
+    double latencyMs = NowMs() - request.receivedMs;
+    std::string line = "{\"id\": ";
+    AppendJsonString(&line, request.id);
+    char numbers[256];
+    if (error != NULL) {
+        line += ", \"status\": \"error\", \"error\": ";
+        AppendJsonString(&line, error);
+        snprintf(numbers, sizeof(numbers), ", \"latency_ms\": %.2f}\n", latencyMs);
+    } else {
+        snprintf(numbers, sizeof(numbers), ", \"status\": \"ok\", \"cached\": %s, \"output\": ", cached ? "true" : "false");
+        line += numbers;
+        AppendJsonString(&line, request.output);
+        snprintf(numbers, sizeof(numbers), ", \"width\": %d, \"height\": %d, \"latency_ms\": %.2f, \"render_ms\": %.2f, \"encode_ms\": %.2f}\n",
+                 request.width, request.height, latencyMs, renderMs, encodeMs);
+    }
+    line += numbers;
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+    fputs(line.c_str(), stdout);
+    fflush(stdout);
+    requestsServed++;
+    latencyTotalMs += latencyMs;
+}
+
+// Lines are parsed as they arrive, so the render loop can take whatever has queued up as one batch
+static void ReaderMain(const char* outDir) {
+    std::string line;
+    char chunk[4096];
+    int lineNumber = 0;
+    bool reading = true;
+    while (reading) {
+        line.clear();
+        bool complete = false;
+        while (!complete) {
+            if (fgets(chunk, sizeof(chunk), stdin) == NULL) {
+                reading = false;
+                break;
+            }
+            line += chunk;
+            complete = !line.empty() && line.back() == '\n';
+            if (line.size() > SERVICE_MAX_LINE) break;
+        }
+        if (line.find_first_not_of(" \t\r\n") == std::string::npos) continue;
+
+        lineNumber++;
+        RenderRequest request = ParseRequest(line, lineNumber, outDir);
+        if (line.size() > SERVICE_MAX_LINE) {
+            request.error = "request line too long";
+            while (!complete && fgets(chunk, sizeof(chunk), stdin) != NULL) complete = strchr(chunk, '\n') != NULL;
+        }
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            pendingRequests.push_back(request);
+        }
+        requestWake.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(requestMutex);
+    inputClosed = true;
+    requestWake.notify_one();
+}
+
+// Everything queued so far, up to maxCount; blocks only while nothing is queued. Empty once input is closed.
+static std::vector<RenderRequest> TakeBatch(int maxCount) {
+    std::unique_lock<std::mutex> lock(requestMutex);
+    requestWake.wait(lock, [] { return inputClosed || !pendingRequests.empty(); });
+    std::vector<RenderRequest> batch;
+    while (!pendingRequests.empty() && (int)batch.size() < maxCount) {
+        batch.push_back(pendingRequests.front());
+        pendingRequests.pop_front();
+    }
+    return batch;
+}
+
+// ---- Result cache ---------------------------------------------------------------------------------------
+
+static bool LookupCache(uint64_t hash, std::vector<unsigned char>* png) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (const CachedResult& entry : cache) {
+        if (entry.hash != hash) continue;
+        *png = entry.png;
+        return true;
+    }
+    return false;
+}
+
+static void StoreCache(uint64_t hash, const unsigned char* png, int size) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cache.size() >= SERVICE_CACHE_ENTRIES) cache.pop_front();
+    cache.push_back(CachedResult{ hash, std::vector<unsigned char>(png, png + size) });
+}
+
+// ---- Encoding -------------------------------------------------------------------------------------------
+
+static void EncodeAndWrite(EncodeJob* job) {
+    double startMs = NowMs();
+    RenderRequest& request = job->request;
+    int rowBytes = request.width * 4;
+    unsigned char* pixels = job->pixels.data();
+
+    // GL rows run bottom-up; alpha is whatever the last pass left
+    std::vector<unsigned char> row(rowBytes);
+    for (int y = 0; y < request.height / 2; y++) {
+        unsigned char* top = pixels + (size_t)y * rowBytes;
+        unsigned char* bottom = pixels + (size_t)(request.height - 1 - y) * rowBytes;
+        memcpy(row.data(), top, rowBytes);
+        memcpy(top, bottom, rowBytes);
+        memcpy(bottom, row.data(), rowBytes);
+    }
+    for (size_t i = 3; i < job->pixels.size(); i += 4) pixels[i] = 255;
+
+    Image image = { pixels, request.width, request.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    int size = 0;
+    unsigned char* png = ExportImageToMemory(image, ".png", &size);
+    if (png == NULL) {
+        Respond(request, false, job->renderMs, NowMs() - startMs, "PNG encoding failed");
+        return;
+    }
+    StoreCache(request.hash, png, size);
+    bool saved = SaveFileData(request.output.c_str(), png, size);
+    MemFree(png);
+    Respond(request, false, job->renderMs, NowMs() - startMs, saved ? NULL : "could not write output");
+}
+
+static void EncoderMain() {
+    std::unique_lock<std::mutex> lock(encodeMutex);
+    for (;;) {
+        encodeWake.wait(lock, [] { return encodeStopping || !encodeJobs.empty(); });
+        if (encodeJobs.empty()) break;
+
+        EncodeJob job = std::move(encodeJobs.front());
+        encodeJobs.pop_front();
+        lock.unlock();
+        EncodeAndWrite(&job);
+        lock.lock();
+    }
+}
+
+// ---- Rendering ------------------------------------------------------------------------------------------
+
+static Readback readbacks[2];
+static int nextReadback = 0;
+static RenderTexture2D output = { 0 };
+static Light baselineLights[MAX_LIGHTS];
+
+// Wait for a readback (normally landed already: a whole request was rendered after it) and hand it to the encoder
+static void FinishReadback(Readback* readback) {
+    if (readback->fence == NULL) return;
+    glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+    glDeleteSync(readback->fence);
+    readback->fence = NULL;
+
+    EncodeJob job;
+    job.request = readback->request;
+    job.renderMs = readback->renderMs;
+    job.pixels.resize(readback->bytes);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback->bytes, GL_MAP_READ_BIT);
+    if (pixels != NULL) {
+        memcpy(job.pixels.data(), pixels, readback->bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (pixels == NULL) {
+        Respond(job.request, false, job.renderMs, 0.0, "readback failed");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(encodeMutex);
+        encodeJobs.push_back(std::move(job));
+    }
+    encodeWake.notify_one();
+}
+
+static void ResizeTargets(int width, int height) {
+    hdr = CreateRenderTextures(width, height, hdr, bright);
+    if (output.id != 0) UnloadRenderTexture(output);
+    output = LoadRenderTexture(width, height);
+    sizeChanges++;
+}
+
+static void ApplyRequest(const RenderRequest& request) {
+    cam.position = request.position;
+    cam.target = request.target;
+    cam.up = Vector3{ 0.0f, 1.0f, 0.0f };
+    cam.fovy = request.fovy;
+    cam.projection = CAMERA_PERSPECTIVE;
+
+    // The baseline copy undoes the last request's overrides; both sets go up through the dirty list
+    static std::vector<int> overridden;
+    memcpy(lights, baselineLights, sizeof(lights));
+    for (int index : overridden) MarkLightDirty(index);
+    overridden.clear();
+
+    SetLightCount(request.lights);
+    for (const LightOverride& light : request.overrides) {
+        Light* target = &lights[light.index];
+        MarkLightDirty(light.index);
+        overridden.push_back(light.index);
+        if (light.fields & OVERRIDE_POSITION) target->position = light.position;
+        if (light.fields & OVERRIDE_COLOR) target->color = light.color;
+        if (light.fields & OVERRIDE_INTENSITY) target->intensity = light.intensity;
+        if (light.fields & OVERRIDE_RANGE) target->range = light.range;
+    }
+}
+
+// Render one request and start its readback; the previous request's readback is collected after this
+// frame is queued, so the GPU works on this one while the CPU copies and encodes the last
+static void RenderRequestImage(const RenderRequest& request) {
+    if (output.id == 0 || output.texture.width != request.width || output.texture.height != request.height) {
+        ResizeTargets(request.width, request.height);
+    }
+
+    double startMs = NowMs();
+    ApplyRequest(request);
+    UpdateShaderUniforms();
+    RenderScene(request.width, request.height);
+    BeginTextureMode(output);
+        DrawFinalPass(request.width, request.height);
+    EndTextureMode();
+
+    Readback* readback = &readbacks[nextReadback];
+    int bytes = request.width * request.height * 4;
+    if (readback->pbo == 0) glGenBuffers(1, &readback->pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    if (readback->bytes != bytes) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+        readback->bytes = bytes;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, output.id);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(0, 0, request.width, request.height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback->request = request;
+    readback->renderMs = NowMs() - startMs;
+    renders++;
+
+    nextReadback ^= 1;
+    FinishReadback(&readbacks[nextReadback]);
+}
+
+static void ServeBatch(std::vector<RenderRequest>* batch) {
+    // Group by size, starting with the size the targets already have
+    int currentWidth = output.texture.width;
+    int currentHeight = output.texture.height;
+    std::stable_sort(batch->begin(), batch->end(), [currentWidth, currentHeight](const RenderRequest& a, const RenderRequest& b) {
+        bool aCurrent = a.width == currentWidth && a.height == currentHeight;
+        bool bCurrent = b.width == currentWidth && b.height == currentHeight;
+        if (aCurrent != bCurrent) return aCurrent;
+        if (a.width != b.width) return a.width < b.width;
+        return a.height < b.height;
+    });
+
+    for (const RenderRequest& request : *batch) {
+        if (!request.error.empty()) {
+            Respond(request, false, 0.0, 0.0, request.error.c_str());
+            continue;
+        }
+
+        std::vector<unsigned char> png;
+        if (LookupCache(request.hash, &png)) {
+            cacheHits++;
+            bool saved = SaveFileData(request.output.c_str(), png.data(), (int)png.size());
+            Respond(request, true, 0.0, 0.0, saved ? NULL : "could not write output");
+            continue;
+        }
+        RenderRequestImage(request);
+    }
+
+    // Nothing else is queued behind the last image, so collect it now rather than with the next batch
+    FinishReadback(&readbacks[nextReadback ^ 1]);
+}
+
+static void PrintUsage(const char* exe) {
+    fprintf(stderr, "Usage: %s [--batch N] [--out DIR]   (one JSON request per line on stdin)\n", exe);
+}
+
+static bool ParseOptions(int argc, char** argv, ServiceOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (strcmp(arg, "--batch") == 0 && hasValue) options->batchSize = atoi(argv[++i]);
+        else if (strcmp(arg, "--out") == 0 && hasValue) options->outDir = argv[++i];
+        else {
+            PrintUsage(argv[0]);
+            return false;
+        }
+    }
+
+    return options->batchSize > 0;
+}
+
+int main(int argc, char** argv) {
+    ServiceOptions options = { 16, "renders" };
+    if (!ParseOptions(argc, argv, &options)) return 2;
+
+    // stdout carries responses only
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(W, H, "Raylib - Render Service");
+    SetTargetFPS(0);
+    InitializeCamera();
+
+    hdr = CreateRenderTextures(W, H, hdr, bright);
+    LoadResources();
+    FinishAssetLoading();
+    MakeDirectory(options.outDir);
+
+    // Requests start from the same lights, and every image gets all of its shadow faces
+    SetLightCount(GetLightCapacity());
+    memcpy(baselineLights, lights, sizeof(baselineLights));
+    SetLightCount(DEFAULT_LIGHTS);
+    shadowFaceBudget = 6 * MAX_SHADOW_LIGHTS;
+
+    std::thread reader(ReaderMain, options.outDir);
+    std::thread encoder(EncoderMain);
+
+    double startMs = NowMs();
+    for (;;) {
+        std::vector<RenderRequest> batch = TakeBatch(options.batchSize);
+        if (batch.empty()) break;
+        ServeBatch(&batch);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(encodeMutex);
+        encodeStopping = true;
+    }
+    encodeWake.notify_all();
+    encoder.join();
+    reader.join();
+
+    double elapsedMs = NowMs() - startMs;
+    fprintf(stderr, "SERVICE: %d requests in %.0f ms, %d rendered, %d from cache, %d target resizes, mean latency %.2f ms\n",
+            requestsServed, elapsedMs, renders, cacheHits, sizeChanges, requestsServed > 0 ? latencyTotalMs / requestsServed : 0.0);
+
+    for (int i = 0; i < 2; i++) glDeleteBuffers(1, &readbacks[i].pbo);
+    if (output.id != 0) UnloadRenderTexture(output);
+    UnloadResources();
+    CloseWindow();
+    return 0;
+}
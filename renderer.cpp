@@ -0,0 +1,972 @@
+#include "renderer.h"
+#include "profiler.h"
+#include "light_buffer.h"
+#include "light_animation.h"
+#include "draw_constants.h"
+#include "shadow_atlas.h"
+#include "frame_capture.h"
+#include "light_clusters.h"
+#include "job_system.h"
+#include "deferred.h"
+#include "depth_prepass.h"
+#include "scene_culling.h"
+#include "occlusion_culling.h"
+#include "render_queue.h"
+#include "bloom.h"
+#include "frame_graph.h"
+#include "dynamic_resolution.h"
+#include "light_probe.h"
+#include "irradiance_grid.h"
+#include "asset_loader.h"
+#include "scene_cache.h"
+#include "shader_cache.h"
+#include "shader_permutations.h"
+#include "imgui.h"
+#include "rlImGui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+// Global variables
+Camera3D cam;
+Shader sh, shEmis, shSky, shHDR, shFXAA, shTonemapFXAA;
+Model skyModel, sponzaModel;
+Model orbitModel;
+static InstanceBatch orbInstances;
+Light lights[MAX_LIGHTS];
+int lightCount = 0;
+TextureCubemap skyTex;
+Texture2D sunTex;
+RenderTexture2D hdr, bright;
+
+// Frustum culling results of the main camera this frame
+static VisibleMeshes cameraVisible;
+
+
+// UI variables
+bool showLightDetails = false;
+int selectedLight = 0;
+bool enableFXAA = true;
+bool enableLeanPost = false;
+static int captureFormat = CAPTURE_PNG;
+
+// Shader uniforms
+Vector3 ambientColor = { 0.008f, 0.008f, 0.008f };
+Vector3 specularColor = { 1.0f, 1.0f, 1.0f };
+float shininess = 32.0f;
+float exposure = 1.0f;
+float hdrGamma = 2.2f;
+float bloomThreshold = 1.0f;   // soft-knee threshold of the bloom prefilter
+
+// Shader uniform locations
+int locEyePos, locAmb, locSpec, locShine;
+int locOrbScale;
+int locRotView, locProjection;
+int locHdrGamma, locHdrExposure, locHdrBloomStrength;
+int locBloomCutoff;
+int locFXAATexelStep;
+int locFusedGamma, locFusedExposure, locFusedBloomStrength, locFusedTexelStep;
+
+// Target traffic of the last frame built in each post mode (standard, lean), for comparison
+static long long postTargetBytes[2] = { 0, 0 };
+
+void InitializeWindow() {
+    // Initialize window
+    InitWindow(W, H, "Raylib - Demo");
+    SetWindowState(FLAG_WINDOW_RESIZABLE);
+    SetTargetFPS(60);
+    
+    // Initialize ImGui
+    rlImGuiSetup(true);
+    
+    InitializeCamera();
+}
+
+// Reset the camera to its startup pose
+void InitializeCamera() {
+    cam = { 0 };
+    cam.position = Vector3{ -1.0f, 2.0f, -0.5f };
+    cam.target   = Vector3{ 0.0f, 0.0f, 0.0f };
+    cam.up       = Vector3{ 0.0f, 1.0f, 0.0f };
+    cam.fovy     = 45.0f;
+    cam.projection = CAMERA_PERSPECTIVE;
+}
+
+// Scene color format: packed R11G11B10 floats in lean post mode (alpha is never read), half floats otherwise
+static int SceneColorFormat() {
+    return enableLeanPost ? FRAME_GRAPH_FORMAT_R11G11B10F : RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16;
+}
+
+int GetSceneDrawBuffers() {
+    return enableLeanPost ? 1 : 2;
+}
+
+// Create the persistent HDR targets; post-processing targets come from the frame graph's pool
+RenderTexture2D CreateRenderTextures(int width, int height, RenderTexture2D& hdr, RenderTexture2D& bright) {
+    // Clean up existing textures if they exist
+    if (hdr.id != 0) {
+        UnloadTexture(hdr.texture);
+        UnloadRenderTexture(hdr);
+    }
+    if (bright.texture.id != 0) {
+        UnloadTexture(bright.texture);
+    }
+
+    // Create HDR render texture, with a sampleable depth texture for temporal reprojection
+    hdr = RenderTexture2D{ 0 };
+    hdr.id = rlLoadFramebuffer();
+    hdr.texture.id = LoadColorTexture(width, height, SceneColorFormat());
+    hdr.texture.width = width;
+    hdr.texture.height = height;
+    hdr.texture.mipmaps = 1;
+    hdr.texture.format = SceneColorFormat();
+    SetTextureFilter(hdr.texture, TEXTURE_FILTER_BILINEAR);   // the temporal upscale samples between texels
+    hdr.depth.id = rlLoadTextureDepth(width, height, false);
+    hdr.depth.width = width;
+    hdr.depth.height = height;
+    hdr.depth.mipmaps = 1;
+    hdr.depth.format = DEPTH_TEXTURE_FORMAT;
+
+    // Create bright texture; it is only ever rendered as hdr's second attachment, so it has no FBO of its own.
+    // Lean post mode thresholds hdr at bloom resolution instead, leaving a black 1x1 stand-in for the bloom input.
+    static const unsigned short black[4] = { 0, 0, 0, 0 };
+    int brightWidth = enableLeanPost ? 1 : width;
+    int brightHeight = enableLeanPost ? 1 : height;
+    bright = RenderTexture2D{ 0 };
+    bright.texture.id = rlLoadTexture(enableLeanPost ? black : NULL, brightWidth, brightHeight, RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16, 1);
+    bright.texture.width = brightWidth;
+    bright.texture.height = brightHeight;
+    bright.texture.mipmaps = 1;
+    bright.texture.format = RL_PIXELFORMAT_UNCOMPRESSED_R16G16B16A16;
+    SetTextureFilter(bright.texture, TEXTURE_FILTER_BILINEAR);   // bloom downsample taps between texels
+
+    // Bind the same FBO and attach both to it
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, hdr.id);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, hdr.id);
+        rlFramebufferAttach(hdr.id, hdr.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+        if (!enableLeanPost) rlFramebufferAttach(hdr.id, bright.texture.id, RL_ATTACHMENT_COLOR_CHANNEL1, RL_ATTACHMENT_TEXTURE2D, 0);
+        rlFramebufferAttach(hdr.id, hdr.depth.id, RL_ATTACHMENT_DEPTH, RL_ATTACHMENT_TEXTURE2D, 0);
+    
+    // Activate the scene's draw color buffers
+    rlActiveDrawBuffers(GetSceneDrawBuffers());
+
+    // Unbind buffers
+    rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, 0);
+    rlBindFramebuffer(RL_READ_FRAMEBUFFER, 0);
+
+    // G-buffer for the deferred path (shares the hdr/bright color targets)
+    CreateGBuffer(width, height);
+
+    return hdr;
+}
+
+// Skybox faces as they decode, and the cross atlas built from them
+static Image skyFaces[6];
+static Image skyAtlas;
+static Image sunImage;
+
+// Decode images and read the model on loader threads; GL uploads happen on the main thread a few per frame
+static void QueueSourceSceneAssets() {
+    std::vector<int> faceAssets;
+    for (int i = 0; i < 6; i++) {
+        const char* faceFile = sceneSourceFiles[1 + i];
+        faceAssets.push_back(QueueAsset(GetFileName(faceFile), [i, faceFile] { skyFaces[i] = LoadImage(faceFile); }, nullptr));
+    }
+
+    QueueAsset("skybox atlas", [] {
+        Image px = skyFaces[0], nx = skyFaces[1], py = skyFaces[2], ny = skyFaces[3], pz = skyFaces[4], nz = skyFaces[5];
+
+        int fw = px.width;
+        int fh = px.height;
+
+        float fwF = static_cast<float>(fw);
+        float fhF = static_cast<float>(fh);
+
+        // Create an image atlas for the cubemap
+        skyAtlas = GenImageColor(fw*4, fh*3, BLANK);
+
+        // Common source-rect
+        Rectangle srcRec{ 0.0f, 0.0f, fwF, fhF };
+
+        // Build all the destination rects with floats
+        Rectangle dstRecs[6] = {
+            { 0*fwF, 1*fhF, fwF, fhF },
+            { 2*fwF, 1*fhF, fwF, fhF },
+            { 1*fwF, 0*fhF, fwF, fhF },
+            { 1*fwF, 2*fhF, fwF, fhF },
+            { 1*fwF, 1*fhF, fwF, fhF },
+            { 3*fwF, 1*fhF, fwF, fhF }
+        };
+
+        Image faces[6] = { nx, px, py, ny, pz, nz };
+
+        for (int i = 0; i < 6; i++) {
+            ImageDraw(&skyAtlas, faces[i], srcRec, dstRecs[i], WHITE);
+            UnloadImage(skyFaces[i]);
+        }
+    }, [] {
+        skyTex = LoadTextureCubemap(skyAtlas, CUBEMAP_LAYOUT_CROSS_FOUR_BY_THREE);
+        skyModel.materials[0].maps[MATERIAL_MAP_CUBEMAP].texture = skyTex;
+        UnloadImage(skyAtlas);
+    }, faceAssets);
+
+    // The file is read ahead; glTF parsing and mesh/texture creation need GL, so they run in the upload.
+    // Mipmaps follow as one small upload per material.
+    static const char* sponzaFile = sceneSourceFiles[0];
+    QueueAsset("sponza.glb", [] {
+        int size = 0;
+        unsigned char* data = ReadAssetFile(sponzaFile, &size);
+        ProvideFileData(sponzaFile, data, size);
+    }, [] {
+        sponzaModel = LoadModel(sponzaFile);
+        AssignLitVariants(&sponzaModel);
+        QueueLitVariantBuilds(&sponzaModel);
+        for (int i = 0; i < sponzaModel.materialCount; i++) {
+            char name[ASSET_NAME_LENGTH];
+            snprintf(name, sizeof(name), "sponza mipmaps %d", i);
+            QueueAsset(name, nullptr, [i] { GenTextureMipmaps(&sponzaModel.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture); });
+        }
+        BuildSceneBvh(sponzaModel);
+        BuildOccluders(sponzaModel);
+    });
+
+    // Decoded once, for the orb emission texture
+    QueueAsset("sun.jpg", [] { sunImage = LoadImage(sceneSourceFiles[7]); }, [] {
+        sunTex = LoadTextureFromImage(sunImage);
+        orbitModel.materials[0].maps[MATERIAL_MAP_EMISSION].texture = sunTex;
+        UnloadImage(sunImage);
+    });
+}
+
+// Cooked scene: loader threads page the mapped blocks in, uploads read them straight from the mapping
+static void QueueCachedSceneAssets() {
+    std::vector<int> textureAssets;
+    for (int i = 0; i < GetSceneCacheTextureCount(); i++) {
+        char name[ASSET_NAME_LENGTH];
+        snprintf(name, sizeof(name), "cached texture %d", i);
+        textureAssets.push_back(QueueAsset(name, [i] { PrefetchSceneCacheTexture(i); }, [i] { UploadSceneCacheTexture(i); }));
+    }
+
+    QueueAsset("cached skybox", [] { PrefetchSceneCacheSkybox(); }, [] {
+        skyTex = UploadSceneCacheSkybox();
+        skyModel.materials[0].maps[MATERIAL_MAP_CUBEMAP].texture = skyTex;
+    });
+
+    QueueAsset("cached sun", [] { PrefetchSceneCacheSun(); }, [] {
+        sunTex = UploadSceneCacheSun();
+        orbitModel.materials[0].maps[MATERIAL_MAP_EMISSION].texture = sunTex;
+    });
+
+    QueueAsset("cached sponza", [] { PrefetchSceneCacheGeometry(); }, [] {
+        sponzaModel = UploadSceneCacheModel();
+        AssignLitVariants(&sponzaModel);
+        QueueLitVariantBuilds(&sponzaModel);
+        BuildSceneBvh(sponzaModel);
+        BuildOccluders(sponzaModel);
+    }, textureAssets);
+}
+
+static void QueueSceneAssets() {
+    if (OpenSceneCache(SCENE_CACHE_PATH)) {
+        QueueCachedSceneAssets();
+    } else {
+        QueueSourceSceneAssets();
+    }
+}
+
+// Load all resources (shaders, textures, models)
+void LoadResources() {
+    // Lights live in one uniform buffer shared by every lit shader, culled per cluster
+    InitializeJobSystem();
+    InitializeLightBuffer();
+    InitializeLightClusters();
+
+    // Per-draw matrices of the mesh shaders, streamed through a uniform buffer ring
+    InitializeDrawConstants();
+
+    // Load shaders through the program binary cache; each callback runs again after a hot reload.
+    // sh is the lit shader with every feature; cheaper variants are built as materials need them.
+    static std::string litDefines = GetLitVariantDefines(LIT_ALL_FEATURES, LIT_LIGHT_BUCKETS - 1);
+    LoadWatchedShader(&sh, "resources/shaders/default.vs", "resources/shaders/phong.fs", [](unsigned int previousId) {
+        locEyePos    = GetShaderLocation(sh, "u_eyePos");
+        locAmb       = GetShaderLocation(sh, "u_ambientColor");
+        locSpec      = GetShaderLocation(sh, "u_specularColor");
+        locShine     = GetShaderLocation(sh, "u_shininess");
+        sh.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(sh, "diffuseMap");
+        sh.locs[SHADER_LOC_MAP_NORMAL] = GetShaderLocation(sh, "normalMap");
+        locBloomCutoff = GetShaderLocation(sh, "u_bloomCutoff");
+        BindLightBuffer(sh);
+        BindDrawConstants(sh);
+        BindShadowAtlas(sh);
+        BindLightClusters(sh, previousId);
+        BindIrradianceGrid(sh, previousId);
+        for (int i = 0; i < sponzaModel.materialCount; i++) {
+            if (sponzaModel.materials[i].shader.id == previousId) sponzaModel.materials[i].shader = sh;
+        }
+    }, litDefines.c_str());
+    InitializeDeferred();
+    InitializeDepthPrepass();
+    InitializeShadowAtlas();
+
+    LoadWatchedShader(&shEmis, "resources/shaders/emissive.vs", "resources/shaders/emissive.fs", [](unsigned int) {
+        locOrbScale = GetShaderLocation(shEmis, "u_instanceScale");
+        shEmis.locs[SHADER_LOC_MAP_EMISSION] = GetShaderLocation(shEmis, "emissionMap");
+        float orbScale = 0.2f;
+        SetShaderValue(shEmis, locOrbScale, &orbScale, SHADER_UNIFORM_FLOAT);
+        for (int i = 0; i < orbitModel.materialCount; i++) orbitModel.materials[i].shader = shEmis;
+    });
+
+    LoadWatchedShader(&shSky, "resources/shaders/skybox.vs", "resources/shaders/skybox.fs", [](unsigned int) {
+        locRotView    = GetShaderLocation(shSky, "rotView");
+        locProjection = GetShaderLocation(shSky, "matProjection");
+        shSky.locs[SHADER_LOC_MAP_CUBEMAP] = GetShaderLocation(shSky, "cubemap");
+        for (int i = 0; i < skyModel.materialCount; i++) skyModel.materials[i].shader = shSky;
+    });
+
+    LoadWatchedShader(&shHDR, NULL, "resources/shaders/hdr.fs", [](unsigned int) {
+        locHdrGamma = GetShaderLocation(shHDR, "u_gamma");
+        locHdrExposure = GetShaderLocation(shHDR, "u_exposure");
+        locHdrBloomStrength = GetShaderLocation(shHDR, "u_bloomStrength");
+        shHDR.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shHDR, "hdrBuffer");
+        shHDR.locs[SHADER_LOC_MAP_EMISSION] = GetShaderLocation(shHDR, "bloomBlur");
+    });
+
+    InitializeBloom();
+    InitializeFrameGraph();
+    InitializeDynamicResolution();
+
+    LoadWatchedShader(&shFXAA, NULL, "resources/shaders/fxaa.fs", [](unsigned int) {
+        locFXAATexelStep = GetShaderLocation(shFXAA, "u_texelStep");
+        shFXAA.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shFXAA, "texture0");
+    });
+
+    LoadWatchedShader(&shTonemapFXAA, NULL, "resources/shaders/tonemap_fxaa.fs", [](unsigned int) {
+        locFusedGamma = GetShaderLocation(shTonemapFXAA, "u_gamma");
+        locFusedExposure = GetShaderLocation(shTonemapFXAA, "u_exposure");
+        locFusedBloomStrength = GetShaderLocation(shTonemapFXAA, "u_bloomStrength");
+        locFusedTexelStep = GetShaderLocation(shTonemapFXAA, "u_texelStep");
+        shTonemapFXAA.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shTonemapFXAA, "hdrBuffer");
+        shTonemapFXAA.locs[SHADER_LOC_MAP_EMISSION] = GetShaderLocation(shTonemapFXAA, "bloomBlur");
+    });
+    const ShaderCacheStats* shaderStats = GetShaderCacheStats();
+    TraceLog(LOG_INFO, "SHADERS: %d programs in %.1f ms, %d from cached binaries", shaderStats->programs, shaderStats->loadMs, shaderStats->binaryHits);
+
+    // Skybox cube and the orb model shared by all lights; their textures arrive with the assets below
+    skyModel = LoadModelFromMesh(GenMeshCube(1.0f, 1.0f, 1.0f));
+    skyModel.materials[0].shader = shSky;
+
+    orbitModel = LoadModelFromMesh(GenMeshSphere(0.2f, 64, 64));
+    orbitModel.materials[0].shader = shEmis;
+
+    // Each Light is two vec4s (position/range, color/intensity), streamed as instance data
+    orbInstances = LoadInstanceBatch(orbitModel.meshes[0], MAX_LIGHTS, sizeof(Light), 2);
+
+    // Textures and the model finish in the background; main waits on UpdateAssetLoading
+    QueueSceneAssets();
+    StartAssetLoading();
+
+    // Initialize lights
+    lightCount = 0;
+    SetLightCount(DEFAULT_LIGHTS);
+    
+    // Initialize light probe
+    InitializeLightProbe(Vector3{0.0f, 2.0f, 0.0f}, 512);
+
+    // Baked diffuse lighting, if a grid has been baked
+    InitializeIrradianceGrid();
+}
+
+// Unload all resources
+void UnloadResources() {
+    StopFrameCapture();
+    UnloadLitVariants();
+    UnloadWatchedShader(&sh);
+    UnloadWatchedShader(&shEmis);
+    UnloadWatchedShader(&shSky);
+    UnloadWatchedShader(&shHDR);
+    UnloadDynamicResolution();
+    UnloadFrameGraph();
+    UnloadBloom();
+    UnloadWatchedShader(&shFXAA);
+    UnloadWatchedShader(&shTonemapFXAA);
+    UnloadLightBuffer();
+    UnloadDrawConstants();
+    UnloadShadowAtlas();
+    UnloadLightClusters();
+    UnloadDeferred();
+    UnloadDepthPrepass();
+    ShutdownJobSystem();
+    
+    UnloadInstanceBatch(&orbInstances);
+    UnloadModel(orbitModel);
+    
+    UnloadSceneBvh();
+    UnloadOccluders();
+    CloseSceneCache(&sponzaModel);
+    UnloadModel(sponzaModel);
+    UnloadModel(skyModel);
+    UnloadTexture(sunTex);
+    UnloadTexture(skyTex);
+    
+    UnloadTexture(hdr.texture);
+    UnloadTexture(bright.texture);
+    
+    UnloadRenderTexture(hdr);
+    
+    UnloadLightProbe();
+    UnloadIrradianceGrid();
+}
+
+// Update all shader uniform values
+void UpdateShaderUniforms() {
+    ProfilerBeginScope("update_uniforms");
+
+    // Upload only the lights that changed since last frame
+    int dirtyCount = 0;
+    const int* dirty = GetLightDirtyList(&dirtyCount);
+    UpdateLightBufferDirty(lights, lightCount, dirty, dirtyCount);
+    ClearLightDirtyList();
+    UpdateLitVariants(&sponzaModel);
+
+    // Set other shader uniforms
+    SetShaderValue(sh, locEyePos, &cam.position, SHADER_UNIFORM_VEC3);
+    SetShaderValue(sh, locAmb, &ambientColor, SHADER_UNIFORM_VEC3);
+    SetShaderValue(sh, locSpec, &specularColor, SHADER_UNIFORM_VEC3);
+    SetShaderValue(sh, locShine, &shininess, SHADER_UNIFORM_FLOAT);
+    UpdateIrradianceGridUniforms();
+    float bloomCutoff = GetBloomCutoff();
+    SetShaderValue(sh, locBloomCutoff, &bloomCutoff, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shHDR, locHdrGamma, &hdrGamma, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shHDR, locHdrExposure, &exposure, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shTonemapFXAA, locFusedGamma, &hdrGamma, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shTonemapFXAA, locFusedExposure, &exposure, SHADER_UNIFORM_FLOAT);
+    
+    // Update view matrix for skybox
+    Matrix view = GetCameraMatrix(cam);
+    view.m12 = view.m13 = view.m14 = 0.0f;
+    SetShaderValueMatrix(shSky, locRotView, view);
+    
+    // Update projection matrix for skybox
+    float aspect = (float)GetScreenWidth() / (float)GetScreenHeight();
+    Matrix projection = MatrixPerspective(cam.fovy * DEG2RAD, aspect, 0.1f, 1000.0f);
+    SetShaderValueMatrix(shSky, locProjection, projection);
+
+    ProfilerEndScope();
+}
+
+// Draw every light as an emissive orb in one instanced call (inside BeginMode3D)
+void DrawLightOrbs() {
+    DrawInstanceBatch(&orbInstances, orbitModel.materials[0], lights, lightCount);
+}
+
+// Update light positions and properties
+void UpdateLights(float dt) {
+    UpdateLightAnimation(dt);
+}
+
+// Deterministic 0..1 value per (light, channel) so added lights are stable across runs
+float LightHash(int index, int channel) {
+    unsigned int h = (unsigned int)index * 747796405u + (unsigned int)channel * 2891336453u;
+    h = ((h >> ((h >> 28u) + 4u)) ^ h) * 277803737u;
+    h = (h >> 22u) ^ h;
+    return (float)(h & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+// Grow or shrink the active light set; new lights keep the original 8 defaults, extras are scattered over the scene
+void SetLightCount(int count) {
+    if (count < 1) count = 1;
+    if (count > GetLightCapacity()) count = GetLightCapacity();
+
+    Vector3 starts[DEFAULT_LIGHTS] = {
+        {8.3f, 1.7f, 0.0f},
+        {4.3f, 1.7f, 0.0f},
+        {0.3f, 1.7f, 0.0f},
+        {-4.3f, 1.7f, 0.0f}
+    };
+    BoundingBox bounds = GetModelBoundingBox(sponzaModel);
+
+    for (int i = lightCount; i < count; i++) {
+        if (i < DEFAULT_LIGHTS) {
+            lights[i].color = { 1.0f, 1.0f, 1.0f }; // Default color
+            lights[i].position = starts[i];
+            lights[i].intensity = 1.0f; // Default intensity
+            lights[i].range = 4.0f; // Default range value
+        } else {
+            lights[i].position = Vector3{
+                Lerp(bounds.min.x, bounds.max.x, LightHash(i, 0)),
+                Lerp(bounds.min.y, bounds.max.y * 0.5f, LightHash(i, 1)),
+                Lerp(bounds.min.z, bounds.max.z, LightHash(i, 2))
+            };
+            Color c = ColorFromHSV(360.0f * LightHash(i, 3), 0.6f, 1.0f);
+            lights[i].color = { c.r / 255.0f, c.g / 255.0f, c.b / 255.0f };
+            lights[i].intensity = 1.0f;
+            lights[i].range = 1.5f + 2.5f * LightHash(i, 4);
+        }
+        MarkLightDirty(i);
+    }
+
+    lightCount = count;
+    if (selectedLight >= lightCount) selectedLight = lightCount - 1;
+}
+
+// Tone map the scene color plus bloom onto the current target, with FXAA applied in the same pass when fused
+static void DrawTonemap(Texture2D sceneColor, FgResource bloomResource, int currentWidth, int currentHeight, bool fusedFXAA) {
+    // Every pyramid level adds roughly the bright energy once
+    Texture2D bloomTexture = bright.texture;
+    float bloomStrength = 0.0f;
+    if (bloomResource >= 0) {
+        bloomTexture = FrameGraphTarget(bloomResource).texture;
+        bloomStrength = 2.0f / (float)GetBloomMipCount();
+    }
+    Shader shader = fusedFXAA ? shTonemapFXAA : shHDR;
+    SetShaderValue(shader, fusedFXAA ? locFusedBloomStrength : locHdrBloomStrength, &bloomStrength, SHADER_UNIFORM_FLOAT);
+    if (fusedFXAA) {
+        Vector2 texelStep = { 1.0f / (float)currentWidth, 1.0f / (float)currentHeight };
+        SetShaderValue(shader, locFusedTexelStep, &texelStep, SHADER_UNIFORM_VEC2);
+    }
+    BeginShaderMode(shader);
+        SetShaderValueTexture(shader, shader.locs[SHADER_LOC_MAP_DIFFUSE], sceneColor);
+        SetShaderValueTexture(shader, shader.locs[SHADER_LOC_MAP_EMISSION], bloomTexture);
+        Rectangle hdrRect = { 0, 0, (float)currentWidth, -(float)currentHeight };
+        Vector2 hdrPosition = { 0, 0 };
+        DrawTextureRec(sceneColor, hdrRect, hdrPosition, WHITE);
+    EndShaderMode();
+}
+
+// Declare this frame's passes. Nothing that only feeds a disabled consumer is run or allocated:
+// clusters are skipped on the deferred path, the bloom pyramid when bloom is off, and the LDR
+// target when FXAA is off (tone mapping then writes the backbuffer directly).
+// Lean post mode drops the full-resolution bright target (the bloom prefilter thresholds hdr at half
+// resolution) and the LDR target (tone mapping and FXAA run as one pass onto the backbuffer).
+// The scene passes run at the dynamic render size; everything after the temporal upscale at output size.
+static void BuildFrameGraph(int currentWidth, int currentHeight) {
+    FrameGraphBegin();
+
+    const DynamicResolutionState* resolution = GetDynamicResolutionState();
+    int renderWidth = resolution->renderWidth;
+    int renderHeight = resolution->renderHeight;
+
+    FgResource hdrResource = FrameGraphImport("hdr", hdr);
+    FgResource brightResource = FrameGraphImport("bright", bright);
+    RenderTexture2D backbufferTarget = { 0 };
+    backbufferTarget.texture = Texture2D{ 0, currentWidth, currentHeight, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };   // sized for the traffic count
+    FgResource backbuffer = FrameGraphImport("backbuffer", backbufferTarget);
+    FgResource clusters = FrameGraphCreateVirtual("clusters");
+    FgResource visibleMeshes = FrameGraphCreateVirtual("visible_meshes");
+    FgResource unoccludedMeshes = FrameGraphCreateVirtual("unoccluded_meshes");
+    FgResource shadows = FrameGraphCreateVirtual("shadow_atlas");
+
+    // Bin lights into the camera's clusters (the deferred path rasterizes light volumes instead)
+    int pass = FrameGraphAddPass("light_clusters", FRAME_GRAPH_PHASE_OFFSCREEN, [renderWidth, renderHeight]() {
+        UpdateLightClusters(cam, renderWidth, renderHeight, lights, lightCount);
+    });
+    FrameGraphWrite(pass, clusters);
+
+    // Only meshes intersecting the camera frustum are submitted
+    pass = FrameGraphAddPass("frustum_cull", FRAME_GRAPH_PHASE_OFFSCREEN, [currentWidth, currentHeight]() {
+        CullScene(cam, (float)currentWidth / (float)currentHeight, &cameraVisible);
+    });
+    FrameGraphWrite(pass, visibleMeshes);
+
+    // Then drop the survivors hidden behind the big occluders, rasterized on the CPU
+    pass = FrameGraphAddPass("occlusion_cull", FRAME_GRAPH_PHASE_OFFSCREEN, [currentWidth, currentHeight]() {
+        CullOccludedMeshes(cam, (float)currentWidth / (float)currentHeight, &cameraVisible);
+    });
+    FrameGraphRead(pass, visibleMeshes);
+    FrameGraphWrite(pass, unoccludedMeshes);
+
+    // Re-render the stale shadow faces of the lights that matter most on screen, within the face budget
+    pass = FrameGraphAddPass("shadow_atlas", FRAME_GRAPH_PHASE_OFFSCREEN, [currentWidth, currentHeight]() {
+        UpdateShadowAtlas(cam, (float)currentWidth / (float)currentHeight);
+    });
+    FrameGraphWrite(pass, shadows);
+
+    // Main scene rendering
+    pass = FrameGraphAddPass("hdr_scene", FRAME_GRAPH_PHASE_OFFSCREEN, [renderWidth, renderHeight]() {
+        if (shadingPath == SHADING_DEFERRED) {
+            RenderSceneDeferred(&cameraVisible, renderWidth, renderHeight);
+            return;
+        }
+
+        BeginTextureMode(GetSceneViewport(hdr));
+            rlActiveDrawBuffers(GetSceneDrawBuffers());
+            ClearBackground(BLACK);
+            BeginSceneMode3D(cam);
+                // Draw skybox
+                BeginShaderMode(shSky);
+                    rlDisableBackfaceCulling();
+                    rlDisableDepthMask();
+                    DrawModel(skyModel, cam.position, 1.0f, WHITE);
+                    rlEnableBackfaceCulling();
+                    rlEnableDepthMask();
+                EndShaderMode();
+
+                // Draw scene models
+                DrawOpaqueScene(&cameraVisible, renderWidth, renderHeight, true);
+
+                // Draw light sources
+                DrawLightOrbs();
+
+                // Draw light probe visualization (optional)
+                if (showLightProbe) {
+                    DrawCubeWires(lightProbe.position, 0.5f, 0.5f, 0.5f, GREEN);
+                }
+            EndMode3D();
+        EndTextureMode();
+    });
+    FrameGraphRead(pass, unoccludedMeshes);
+    FrameGraphRead(pass, shadows);
+    if (shadingPath == SHADING_FORWARD) FrameGraphRead(pass, clusters);
+    FrameGraphWrite(pass, hdrResource);
+    if (!enableLeanPost) FrameGraphWrite(pass, brightResource);
+
+    // Reconstruct output resolution from the jittered render region
+    FgResource sceneColor = hdrResource;
+    Texture2D sceneColorTexture = hdr.texture;
+    if (enableDynamicResolution) {
+        Texture2D depth = (shadingPath == SHADING_DEFERRED) ? GetGBufferDepth() : hdr.depth;
+        sceneColor = AddTemporalUpscalePass(hdrResource, hdr.texture, depth, currentWidth, currentHeight);
+        sceneColorTexture = FrameGraphTarget(sceneColor).texture;
+    }
+
+    // Apply bloom effect
+    FgResource bloomResource = -1;
+    if (enableBloom) {
+        FgResource bloomSource = enableLeanPost ? hdrResource : brightResource;
+        bloomResource = AddBloomPasses(bloomSource, renderWidth, renderHeight, currentWidth, currentHeight);
+    }
+
+    // Apply HDR tone mapping, into an LDR target for FXAA or straight onto the backbuffer
+    bool fusedFXAA = enableFXAA && enableLeanPost;
+    FgResource ldr = backbuffer;
+    int tonemapPhase = FRAME_GRAPH_PHASE_PRESENT;
+    if (enableFXAA && !fusedFXAA) {
+        ldr = FrameGraphCreate("ldr", currentWidth, currentHeight, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        tonemapPhase = FRAME_GRAPH_PHASE_OFFSCREEN;
+    }
+    pass = FrameGraphAddPass(fusedFXAA ? "tonemap_fxaa" : "tonemap", tonemapPhase, [=]() {
+        if (ldr == backbuffer) {
+            DrawTonemap(sceneColorTexture, bloomResource, currentWidth, currentHeight, fusedFXAA);
+            return;
+        }
+        BeginTextureMode(FrameGraphTarget(ldr));
+            DrawTonemap(sceneColorTexture, bloomResource, currentWidth, currentHeight, false);
+        EndTextureMode();
+    });
+    FrameGraphRead(pass, sceneColor);
+    if (bloomResource >= 0) FrameGraphRead(pass, bloomResource);
+    FrameGraphWrite(pass, ldr);
+
+    if (enableFXAA && !fusedFXAA) {
+        pass = FrameGraphAddPass("fxaa", FRAME_GRAPH_PHASE_PRESENT, [ldr, currentWidth, currentHeight]() {
+            Texture2D ldrTexture = FrameGraphTarget(ldr).texture;
+            Vector2 texelStep = { 1.0f / (float)currentWidth, 1.0f / (float)currentHeight };
+            SetShaderValue(shFXAA, locFXAATexelStep, &texelStep, SHADER_UNIFORM_VEC2);
+
+            BeginShaderMode(shFXAA);
+                SetShaderValueTexture(shFXAA, shFXAA.locs[SHADER_LOC_MAP_DIFFUSE], ldrTexture);
+                Rectangle fxaaRect = { 0, 0, (float)currentWidth, -(float)currentHeight };
+                Vector2 fxaaPosition = { 0, 0 };
+                DrawTextureRec(ldrTexture, fxaaRect, fxaaPosition, WHITE);
+            EndShaderMode();
+        });
+        FrameGraphRead(pass, ldr);
+        FrameGraphWrite(pass, backbuffer);
+    }
+
+    FrameGraphCompile();
+}
+
+// Render the scene and its post-processing chain into offscreen targets
+void RenderScene(int currentWidth, int currentHeight) {
+    ResetRenderQueueStats();
+    ResetDrawConstantStats();
+
+    // Pick this frame's render scale from the last GPU frame time the profiler resolved (held while it is off)
+    double gpuFrameMs = profilerEnabled ? ProfilerGetLastFrame()->gpuFrameMs : 0.0;
+    UpdateDynamicResolution(currentWidth, currentHeight, gpuFrameMs);
+
+    // The post mode picks the scene color format, so a switch reallocates the HDR targets
+    if (hdr.texture.format != SceneColorFormat()) hdr = CreateRenderTextures(hdr.texture.width, hdr.texture.height, hdr, bright);
+
+    BuildFrameGraph(currentWidth, currentHeight);
+    postTargetBytes[enableLeanPost ? 1 : 0] = GetFrameGraphStats()->targetBytes;
+    FrameGraphExecute(FRAME_GRAPH_PHASE_OFFSCREEN);
+}
+
+long long GetPostTargetBytes(bool lean) {
+    return postTargetBytes[lean ? 1 : 0];
+}
+
+// Run the passes that draw onto the current framebuffer (call between BeginDrawing/EndDrawing)
+void DrawFinalPass(int currentWidth, int currentHeight) {
+    // While capturing, the final passes draw into the capture target, which is read back before the UI goes on top
+    bool capturing = BeginCapturedFrame(currentWidth, currentHeight);
+    FrameGraphExecute(FRAME_GRAPH_PHASE_PRESENT);
+    if (capturing) EndCapturedFrame();
+}
+
+// Shown while assets stream in: progress bar and the asset that finished last
+void DrawLoadingScreen() {
+    const AssetLoadProgress* progress = GetAssetLoadProgress();
+    int width = GetScreenWidth();
+    int height = GetScreenHeight();
+    float fraction = (progress->total > 0) ? (float)progress->ready / (float)progress->total : 0.0f;
+
+    ClearBackground(BLACK);
+    Rectangle bar = { width * 0.25f, height * 0.5f, width * 0.5f, 12.0f };
+    DrawRectangleLinesEx(bar, 1.0f, GRAY);
+    DrawRectangleRec(Rectangle{ bar.x, bar.y, bar.width * fraction, bar.height }, RAYWHITE);
+    DrawText(TextFormat("Loading %d / %d", progress->ready, progress->total), (int)bar.x, (int)bar.y - 28, 20, RAYWHITE);
+    if (progress->lastReady != NULL) {
+        DrawText(TextFormat("%s (%.0f ms)", progress->lastReady, progress->elapsedMs), (int)bar.x, (int)(bar.y + bar.height) + 8, 10, GRAY);
+    }
+}
+
+// Draw UI elements using ImGui
+void DrawUI() {
+    ProfilerBeginScope("draw_ui");
+    rlImGuiBegin();
+    
+    if (ImGui::Begin("Controls")) {
+        ImGui::DragFloat3("Camera Pos", (float*)&cam.position, 0.01f, -10.0f, 10.0f);
+        ImGui::DragFloat3("Ambient Color", (float*)&ambientColor, 0.01f, 0.0f, 2.0f);
+        ImGui::DragFloat3("Specular Color", (float*)&specularColor, 0.01f, 0.0f, 2.0f);
+        ImGui::DragFloat("Gamma", &hdrGamma, 0.01f, 1.0f, 3.0f);
+        ImGui::Checkbox("Enable FXAA", &enableFXAA);
+        ImGui::Checkbox("Enable Bloom", &enableBloom);
+        ImGui::Checkbox("Lean Post Chain", &enableLeanPost);
+        ImGui::Checkbox("Dynamic Resolution", &enableDynamicResolution);
+        if (enableDynamicResolution) {
+            const DynamicResolutionState* resolution = GetDynamicResolutionState();
+            ImGui::DragFloat("GPU Budget (ms)", &resolutionBudgetMs, 0.1f, 4.0f, 50.0f);
+            ImGui::SliderFloat("Min Render Scale", &resolutionMinScale, 0.25f, DYNRES_MAX_SCALE);
+            ImGui::Text("Render scale: %.2f (%dx%d), GPU %.2f / %.2f ms", resolution->scale,
+                        resolution->renderWidth, resolution->renderHeight, resolution->smoothedGpuMs, resolutionBudgetMs);
+        }
+        ImGui::DragFloat("Bloom Threshold", &bloomThreshold, 0.01f, 0.0f, 10.0f);
+        ImGui::DragFloat("Bloom Radius", &bloomRadius, 0.01f, 0.5f, 3.0f);
+        const char* bloomQualities[] = { "Low (270p)", "Medium (540p)", "High (1080p)" };
+        ImGui::Combo("Bloom Quality", &bloomQuality, bloomQualities, 3);
+        ImGui::Text("Bloom mips: %d", GetBloomMipCount());
+        const FrameGraphStats* graph = GetFrameGraphStats();
+        ImGui::Text("Frame graph: %d/%d passes run, %d transient targets",
+                    graph->passes - graph->passesCulled, graph->passes, graph->transientResources);
+        ImGui::Text("Target pool: %d targets, %.1f MB (%.1f MB unaliased)", graph->pooledTargets,
+                    (double)graph->pooledBytes / (1024.0 * 1024.0), (double)graph->unaliasedBytes / (1024.0 * 1024.0));
+        ImGui::Text("Target traffic: %.1f MB/frame standard, %.1f MB/frame lean (last frame built in each)",
+                    (double)GetPostTargetBytes(false) / (1024.0 * 1024.0), (double)GetPostTargetBytes(true) / (1024.0 * 1024.0));
+        const char* shadingPaths[] = { "Forward (clustered)", "Deferred" };
+        ImGui::Combo("Shading Path", &shadingPath, shadingPaths, 2);
+        ImGui::Checkbox("Depth Pre-pass", &enableDepthPrepass);
+        if (shadingPath == SHADING_FORWARD) {
+            const OverdrawStats* overdraw = GetOverdrawStats();
+            if (overdraw->prepassActive) {
+                ImGui::Text("Overdraw: %.2f shaded/px (%.2f without pre-pass)",
+                            overdraw->litFragmentsPerPixel, overdraw->prepassFragmentsPerPixel);
+            } else {
+                ImGui::Text("Overdraw: %.2f shaded/px", overdraw->litFragmentsPerPixel);
+            }
+        }
+        
+        ImGui::Separator();
+        ImGui::Checkbox("Show Light Details", &showLightDetails);
+
+        int requestedLights = lightCount;
+        if (ImGui::SliderInt("Light Count", &requestedLights, 1, GetLightCapacity())) {
+            SetLightCount(requestedLights);
+        }
+        ImGui::Checkbox("Animate Lights", &enableLightAnimation);
+        if (enableLightAnimation) {
+            const LightAnimationStats* animation = GetLightAnimationStats();
+            ImGui::Text("Animated: %d lights, %d uploaded, %.3f ms (%.0f lights/ms)", animation->lights, animation->dirty,
+                        animation->animateMs + animation->writeMs, animation->lightsPerMs);
+        }
+        ImGui::Checkbox("Cluster Heatmap", &showClusterHeatmap);
+        const ClusterStats* clusterStats = GetClusterStats();
+        ImGui::Text("Clusters: %d active, %d indices, max %d lights",
+                    clusterStats->activeClusters, clusterStats->indexCount, clusterStats->maxLightsPerCluster);
+        ImGui::Text("Visible lights: %d / %d, binning %.3f ms",
+                    clusterStats->visibleLights, clusterStats->lightCount, clusterStats->buildMs);
+
+        ImGui::Separator();
+        ImGui::Checkbox("Shadows", &enableShadows);
+        ImGui::SliderInt("Shadow Faces / Frame", &shadowFaceBudget, 0, 6 * MAX_SHADOW_LIGHTS);
+        const ShadowAtlasStats* shadowStats = GetShadowAtlasStats();
+        ImGui::Text("Shadowed: %d of %d on screen (%d off screen)", shadowStats->shadowedLights, shadowStats->candidates, shadowStats->offscreenLights);
+        ImGui::Text("Faces: %d rendered, %d cached, %d pending, %.3f ms",
+                    shadowStats->facesRendered, shadowStats->facesCached, shadowStats->facesPending, shadowStats->updateMs);
+        
+        ImGui::Separator();
+        ImGui::Checkbox("Frustum Culling", &enableFrustumCulling);
+        const CullStats* cameraCull = &cameraVisible.stats;
+        ImGui::Text("Camera: %d / %d meshes, %d / %d tris, %.3f ms",
+                    cameraCull->meshesVisible, cameraCull->meshesTotal,
+                    cameraCull->trianglesVisible, cameraCull->trianglesTotal, cameraCull->cullMs);
+        const CullStats* probeCull = GetProbeCullStats();
+        ImGui::Text("Probe (%d faces): %d / %d meshes, %d / %d tris",
+                    probeCull->views, probeCull->meshesVisible, probeCull->meshesTotal,
+                    probeCull->trianglesVisible, probeCull->trianglesTotal);
+        ImGui::Checkbox("Occlusion Culling", &enableOcclusionCulling);
+        const OccluderInfo* occluders = GetOccluderInfo();
+        ImGui::Text("Occluders: %d meshes, %d tris (%d front-facing)", occluders->meshes, occluders->triangles, cameraCull->occluderTriangles);
+        ImGui::Text("Occluded: camera %d meshes, %d tris, %.3f ms; probe %d meshes",
+                    cameraCull->meshesOccluded, cameraCull->trianglesOccluded, cameraCull->occlusionMs, probeCull->meshesOccluded);
+        ImGui::Checkbox("Sort By Material", &enableMaterialSort);
+        const RenderQueueStats* queue = GetRenderQueueStats();
+        ImGui::Text("Draws: %d (%d instanced, %d instances)", queue->draws, queue->instancedDraws, queue->instances);
+        ImGui::Text("Binds: %d shader, %d material, %d texture", queue->shaderBinds, queue->materialBinds, queue->textureBinds);
+        const DrawConstantStats* drawConstants = GetDrawConstantStats();
+        ImGui::Text("Draw constants: %d blocks, %d bytes, %d ring wraps", drawConstants->blocks, drawConstants->bytes, drawConstants->wraps);
+
+        ImGui::Separator();
+        ImGui::Text("Light Probe:");
+        ImGui::Checkbox("Enable Light Probe", &enableLightProbe);
+        ImGui::Checkbox("Show Light Probe", &showLightProbe);
+        ImGui::DragFloat3("Light Probe Position", (float*)&lightProbe.position, 0.1f, -20.0f, 20.0f);
+        if (ImGui::Button("Update Light Probe")) {
+            lightProbe.needsUpdate = true;
+        }
+        ImGui::SliderInt("Probe Faces / Frame", &probeFacesPerFrame, 1, PROBE_FACES);
+        ImGui::SliderInt("Probe Mip Faces / Frame", &probeMipFacesPerFrame, 1, 24);
+        const ProbeUpdateStats* probeUpdate = GetProbeUpdateStats();
+        if (probeUpdate->dirtyFaces > 0 || probeUpdate->prefilterPending > 0) {
+            ImGui::Text("Probe: %d faces dirty, %d mip faces to filter", probeUpdate->dirtyFaces, probeUpdate->prefilterPending);
+        } else {
+            ImGui::Text("Probe: current for %d frames", probeUpdate->framesSinceChange);
+        }
+
+        // Staging target still holds the most recently rendered face
+        if (showLightProbe) {
+            const char* faceNames[PROBE_FACES] = {"Right (+X)", "Left (-X)", "Up (+Y)", "Down (-Y)", "Forward (+Z)", "Back (-Z)"};
+            ImGui::Text("Last Rendered Face: %s", faceNames[probeUpdate->lastFace]);
+            ImGui::Image((ImTextureID)(intptr_t)lightProbe.staging.texture.id, ImVec2(128, 128), ImVec2(0, 1), ImVec2(1, 0));
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Irradiance Grid:");
+        ImGui::Checkbox("Enable Irradiance Grid", &enableIrradianceGrid);
+        ImGui::SliderFloat("Irradiance Strength", &irradianceStrength, 0.0f, 4.0f);
+        if (ImGui::Button("Bake Irradiance Grid")) {
+            irradianceBakeRequested = true;
+        }
+        const IrradianceGridInfo* grid = GetIrradianceGridInfo();
+        if (grid->loaded) {
+            ImGui::Text("Grid: %dx%dx%d probes, %.1f KB, loaded in %.2f ms", grid->dims[0], grid->dims[1], grid->dims[2],
+                        (double)grid->fileBytes / 1024.0, grid->loadMs);
+        } else {
+            ImGui::Text("Grid: not baked (flat ambient)");
+        }
+        if (grid->bakeMs > 0.0) {
+            ImGui::Text("Last bake: %.0f ms (%.0f ms SH projection)", grid->bakeMs, grid->projectMs);
+        }
+
+        ImGui::Separator();
+        const SceneCacheInfo* sceneCache = GetSceneCacheInfo();
+        if (sceneCache->used) {
+            ImGui::Text("Startup: warm, scene cache (%.1f MB), ready in %.0f ms", (double)sceneCache->bytes / (1024.0 * 1024.0), sceneCache->startupMs);
+        } else {
+            ImGui::Text("Startup: cold, %s, ready in %.0f ms", sceneCache->stale ? "stale cache" : "no cache", sceneCache->startupMs);
+        }
+        const TextureMemory* textureMemory = &sceneCache->textureMemory;
+        ImGui::Text("Textures: %.1f MB on the GPU, %.1f MB as RGBA8", (double)textureMemory->gpuBytes / (1024.0 * 1024.0),
+                    (double)textureMemory->uncompressedBytes / (1024.0 * 1024.0));
+        ImGui::Text("%d of %d block-compressed", textureMemory->compressed, textureMemory->textures);
+
+        const ShaderCacheStats* shaderStats = GetShaderCacheStats();
+        ImGui::Text("Shaders: %d programs in %.1f ms, %d from cached binaries%s", shaderStats->programs, shaderStats->loadMs,
+                    shaderStats->binaryHits, shaderStats->binariesSupported ? "" : " (unsupported)");
+        ImGui::Checkbox("Hot Reload Shaders", &enableShaderHotReload);
+        if (shaderStats->reloads > 0 || shaderStats->failedReloads > 0) {
+            ImGui::Text("Reloads: %d (last %.1f ms), %d failed", shaderStats->reloads, shaderStats->lastReloadMs, shaderStats->failedReloads);
+        }
+
+        const LitVariantStats* variantStats = GetLitVariantStats();
+        ImGui::Checkbox("Shader Variants", &enableLitVariants);
+        ImGui::Text("Lit variants: %d in use, %d built in %.1f ms, %d-light bucket", variantStats->inUse, variantStats->compiled,
+                    variantStats->compileMs, variantStats->capacity);
+
+        const char* captureFormats[] = { "PNG sequence", "Raw RGBA stream" };
+        if (IsFrameCaptureActive()) {
+            if (ImGui::Button("Stop Capture")) StopFrameCapture();
+        } else {
+            ImGui::Combo("Capture Format", &captureFormat, captureFormats, 2);
+            if (ImGui::Button("Start Capture")) StartFrameCapture(CAPTURE_DIR, (CaptureFormat)captureFormat);
+        }
+        const FrameCaptureStats* capture = GetFrameCaptureStats();
+        if (capture->framesIssued > 0) {
+            ImGui::Text("Capture: %d frames written, %.1f frames/s, %d in flight, %d queued", capture->framesWritten,
+                        capture->captureFps, capture->framesInFlight, capture->framesQueued);
+            ImGui::Text("Ring waits: %d, writer waits: %d, copy %.2f ms", capture->ringWaits, capture->writerWaits, capture->copyMs);
+        }
+        if (sceneCache->decodedTextures > 0) {
+            ImGui::Text("%d decoded on the CPU (no driver support)", sceneCache->decodedTextures);
+        }
+    }
+    ImGui::End();
+
+    // Light Details Window
+    if (showLightDetails) {
+        if (ImGui::Begin("Light Details", &showLightDetails)) {
+            // Light selection list
+            ImGui::Text("Lights:");
+            if (ImGui::BeginListBox("##LightList", ImVec2(-1, 100))) {
+                for (int i = 0; i < lightCount; i++) {
+                    char lightName[32];
+                    snprintf(lightName, sizeof(lightName), "Light %d", i);
+                    
+                    bool isSelected = (selectedLight == i);
+                    if (ImGui::Selectable(lightName, isSelected)) {
+                        selectedLight = i;
+                    }
+                }
+                ImGui::EndListBox();
+            }
+            
+            ImGui::Separator();
+            
+            // Selected light properties
+            if (selectedLight >= 0 && selectedLight < lightCount) {
+                ImGui::Text("Light %d Properties:", selectedLight);
+                
+                // While animating, intensity and position edits move the values the animation runs around
+                Vector3 anchor;
+                float baseIntensity;
+                bool animated = enableLightAnimation && GetAnimatedLight(selectedLight, &anchor, &baseIntensity);
+                const char* motionNames[LIGHT_MOTION_KINDS] = { "Static", "Orbit", "Flicker", "Path" };
+                if (animated) ImGui::Text("Motion: %s", motionNames[GetLightMotion(selectedLight)]);
+
+                // Color
+                bool edited = ImGui::ColorEdit3("Color", (float*)&lights[selectedLight].color);
+                
+                // Intensity
+                if (animated) {
+                    edited |= ImGui::DragFloat("Base Intensity", &baseIntensity, 0.1f, 0.0f, 10.0f);
+                } else {
+                    edited |= ImGui::DragFloat("Intensity", &lights[selectedLight].intensity, 0.1f, 0.0f, 10.0f);
+                }
+                
+                // Range
+                edited |= ImGui::DragFloat("Range", &lights[selectedLight].range, 0.5f, 0.1f, 50.0f, "%.1f");
+
+                // Position
+                if (animated) {
+                    edited |= ImGui::DragFloat3("Anchor", (float*)&anchor, 0.1f, -20.0f, 20.0f);
+                } else {
+                    edited |= ImGui::DragFloat3("Position", (float*)&lights[selectedLight].position, 0.1f, -20.0f, 20.0f);
+                }
+
+                // Edits reach the light buffer through the dirty list
+                if (edited && animated) SetAnimatedLight(selectedLight, anchor, baseIntensity);
+                else if (edited) MarkLightDirty(selectedLight);
+            }
+        }
+        ImGui::End();
+    }
+
+    DrawProfilerUI();
+    
+    rlImGuiEnd();
+    ProfilerEndScope();
+}
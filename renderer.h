@@ -0,0 +1,73 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <stddef.h>
+
+#define W 1000
+#define H 650
+#define MAX_LIGHTS 1024      // capacity of the light array and LightBlock
+#define DEFAULT_LIGHTS 8
+#define DEPTH_TEXTURE_FORMAT 19   // raylib has no PixelFormat for depth; LoadRenderTexture tags its 24-bit depth texture 19
+
+typedef struct  {
+    Vector3 color;
+} Orbit;
+
+// Field order matches the std140 layout of Light in LightBlock (phong.fs), so the array uploads as-is
+typedef struct {
+    Vector3 position;
+    float range;
+    Vector3 color;
+    float intensity;
+} Light;
+
+static_assert(offsetof(Light, position) == 0, "Light.position must be at std140 offset 0");
+static_assert(offsetof(Light, range) == 12, "Light.range must pack into position's vec4 slot");
+static_assert(offsetof(Light, color) == 16, "Light.color must be at std140 offset 16");
+static_assert(offsetof(Light, intensity) == 28, "Light.intensity must pack into color's vec4 slot");
+static_assert(sizeof(Light) == 32, "Light must match the std140 array stride of 32 bytes");
+
+// Global variables
+extern Camera3D cam;
+extern Shader sh, shEmis, shSky, shHDR, shFXAA, shTonemapFXAA;
+extern Model skyModel, sponzaModel;
+extern Model orbitModel;   // one orb mesh shared by every light
+extern Light lights[MAX_LIGHTS];
+extern int lightCount;
+extern TextureCubemap skyTex;
+extern Texture2D sunTex;
+extern RenderTexture2D hdr, bright;
+
+// UI variables
+extern bool showLightDetails;
+extern int selectedLight;
+extern bool enableFXAA;
+extern bool enableLeanPost;   // packed float scene color, half-resolution bright pass, tone mapping fused with FXAA
+
+// Shader uniforms
+extern Vector3 ambientColor;
+extern Vector3 specularColor;
+extern float shininess;
+extern float exposure;
+extern float hdrGamma;
+extern float bloomThreshold;
+
+// Function declarations
+void InitializeWindow();
+void InitializeCamera();
+RenderTexture2D CreateRenderTextures(int width, int height, RenderTexture2D& hdr, RenderTexture2D& bright);
+int GetSceneDrawBuffers();   // color attachments the scene passes write: hdr, plus bright outside lean post mode
+void LoadResources();
+void UnloadResources();
+void UpdateShaderUniforms();
+void RenderScene(int currentWidth, int currentHeight);
+void DrawFinalPass(int currentWidth, int currentHeight);
+long long GetPostTargetBytes(bool lean);   // frame graph target traffic of the last frame built in that post mode
+void DrawUI();
+void DrawLoadingScreen();
+void DrawLightOrbs();
+void UpdateLights(float dt);
+void SetLightCount(int count);
+float LightHash(int index, int channel);
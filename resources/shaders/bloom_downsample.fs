@@ -0,0 +1,69 @@
+#version 330
+
+out vec4 fragColor;
+
+in vec2 fragTexCoord;
+
+uniform sampler2D source;
+uniform vec2 u_texelSize;      // of the source level
+uniform int u_prefilter;       // first level: threshold and firefly suppression
+uniform float u_threshold;
+uniform float u_knee;
+
+float Luminance(vec3 c) {
+    return dot(c, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// quadratic soft knee around the threshold, keeps only the energy above it
+vec3 SoftThreshold(vec3 color) {
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - u_threshold + u_knee, 0.0, 2.0 * u_knee);
+    soft = soft * soft / (4.0 * u_knee + 0.0001);
+    float contribution = max(soft, brightness - u_threshold) / max(brightness, 0.0001);
+    return color * contribution;
+}
+
+// Karis average: weight each 2x2 block by inverse luminance so single hot texels don't flicker
+vec3 KarisAverage(vec3 a, vec3 b, vec3 c, vec3 d) {
+    float wa = 1.0 / (1.0 + Luminance(a));
+    float wb = 1.0 / (1.0 + Luminance(b));
+    float wc = 1.0 / (1.0 + Luminance(c));
+    float wd = 1.0 / (1.0 + Luminance(d));
+    return (a * wa + b * wb + c * wc + d * wd) / (wa + wb + wc + wd);
+}
+
+void main() {
+    // 13 bilinear taps covering a 6x6 texel footprint (Jimenez, "Next Generation Post Processing in Call of Duty")
+    vec2 t = u_texelSize;
+    vec3 a = texture(source, fragTexCoord + t * vec2(-2.0,  2.0)).rgb;
+    vec3 b = texture(source, fragTexCoord + t * vec2( 0.0,  2.0)).rgb;
+    vec3 c = texture(source, fragTexCoord + t * vec2( 2.0,  2.0)).rgb;
+    vec3 d = texture(source, fragTexCoord + t * vec2(-2.0,  0.0)).rgb;
+    vec3 e = texture(source, fragTexCoord).rgb;
+    vec3 f = texture(source, fragTexCoord + t * vec2( 2.0,  0.0)).rgb;
+    vec3 g = texture(source, fragTexCoord + t * vec2(-2.0, -2.0)).rgb;
+    vec3 h = texture(source, fragTexCoord + t * vec2( 0.0, -2.0)).rgb;
+    vec3 i = texture(source, fragTexCoord + t * vec2( 2.0, -2.0)).rgb;
+    vec3 j = texture(source, fragTexCoord + t * vec2(-1.0,  1.0)).rgb;
+    vec3 k = texture(source, fragTexCoord + t * vec2( 1.0,  1.0)).rgb;
+    vec3 l = texture(source, fragTexCoord + t * vec2(-1.0, -1.0)).rgb;
+    vec3 m = texture(source, fragTexCoord + t * vec2( 1.0, -1.0)).rgb;
+
+    vec3 result;
+    if (u_prefilter == 1) {
+        // the five overlapping 2x2 blocks, each Karis-averaged
+        result  = KarisAverage(j, k, l, m) * 0.5;
+        result += KarisAverage(a, b, d, e) * 0.125;
+        result += KarisAverage(b, c, e, f) * 0.125;
+        result += KarisAverage(d, e, g, h) * 0.125;
+        result += KarisAverage(e, f, h, i) * 0.125;
+        result = SoftThreshold(result);
+    } else {
+        result  = e * 0.125;
+        result += (a + c + g + i) * 0.03125;
+        result += (b + d + f + h) * 0.0625;
+        result += (j + k + l + m) * 0.125;
+    }
+
+    fragColor = vec4(max(result, vec3(0.0)), 1.0);
+}
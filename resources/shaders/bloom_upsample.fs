@@ -0,0 +1,25 @@
+#version 330
+
+out vec4 fragColor;
+
+in vec2 fragTexCoord;
+
+uniform sampler2D source;
+uniform vec2 u_texelSize;   // of the smaller source level
+uniform float u_radius;     // tent radius in source texels
+
+void main() {
+    // 3x3 tent filter from 9 bilinear taps, added onto the larger level by the blend state
+    vec2 r = u_texelSize * u_radius;
+    vec3 result = texture(source, fragTexCoord).rgb * 4.0;
+    result += (texture(source, fragTexCoord + vec2(-r.x, 0.0)).rgb +
+               texture(source, fragTexCoord + vec2( r.x, 0.0)).rgb +
+               texture(source, fragTexCoord + vec2(0.0, -r.y)).rgb +
+               texture(source, fragTexCoord + vec2(0.0,  r.y)).rgb) * 2.0;
+    result += texture(source, fragTexCoord + vec2(-r.x, -r.y)).rgb +
+              texture(source, fragTexCoord + vec2( r.x, -r.y)).rgb +
+              texture(source, fragTexCoord + vec2(-r.x,  r.y)).rgb +
+              texture(source, fragTexCoord + vec2( r.x,  r.y)).rgb;
+
+    fragColor = vec4(result / 16.0, 1.0);
+}
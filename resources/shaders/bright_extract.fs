@@ -0,0 +1,15 @@
+#version 330
+
+out vec4 fragColor;
+
+in vec2 fragTexCoord;
+
+uniform sampler2D texture0;
+uniform float u_bloomCutoff;
+
+void main() {
+    // same cutoff the forward pass applies in phong.fs
+    vec3 color = texture(texture0, fragTexCoord).rgb;
+    float brightness = max(color.r, max(color.g, color.b));
+    fragColor = (brightness > u_bloomCutoff) ? vec4(color, 1.0) : vec4(0.0, 0.0, 0.0, 1.0);
+}
@@ -5,21 +5,26 @@ layout(location = 1) in vec2 vertexTexCoord;
 layout(location = 2) in vec3 vertexNormal;
 layout(location = 3) in vec4 vertexTangent;
  
-uniform mat4 matModel;
-uniform mat4 matView;
-uniform mat4 matProjection;
+// per-draw constants computed on the CPU, see draw_constants.cpp
+layout(std140, row_major) uniform DrawBlock {
+    mat4 u_model;
+    mat4 u_normal;      // transpose(inverse(model))
+    mat4 u_mvp;
+};
 
 out vec3 fragPos;
 out vec2 fragTexCoord;
 out mat3 TBN;
 
+// depth.vs computes the same position for the depth pre-pass
+invariant gl_Position;
+
 void main() {
     // World-space position
-    vec4 worldPos = matModel * vec4(vertexPosition, 1.0);
+    vec4 worldPos = u_model * vec4(vertexPosition, 1.0);
     fragPos = worldPos.xyz;
 
-    // Build normal matrix
-    mat3 normalMatrix = transpose(inverse(mat3(matModel)));
+    mat3 normalMatrix = mat3(u_normal);
     vec3 worldNormal = normalize(normalMatrix * vertexNormal);
 
     // Derive a tangent & bitangent
@@ -33,5 +38,5 @@ void main() {
     fragTexCoord = vertexTexCoord;
 
     // Final clip position
-    gl_Position = matProjection * matView * worldPos;
+    gl_Position = u_mvp * vec4(vertexPosition, 1.0);
 }
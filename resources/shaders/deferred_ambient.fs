@@ -0,0 +1,71 @@
+#version 330
+
+// outputs
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out vec4 brightColor;
+
+in vec2 fragTexCoord;
+
+// G-buffer
+uniform sampler2D albedoMap;
+uniform sampler2D normalMap;
+uniform sampler2D depthMap;
+
+uniform mat4 u_invViewProj;
+uniform vec2 u_regionScale;   // render region / G-buffer size
+uniform vec3 u_ambientColor;
+
+// baked irradiance probe grid, see irradiance_grid.cpp: L2 SH coefficients stacked along z
+uniform sampler3D u_irradianceGrid;
+uniform vec3 u_irradianceMin;         // first and last probe positions
+uniform vec3 u_irradianceMax;
+uniform vec3 u_irradianceDims;        // probes per axis
+uniform float u_irradianceStrength;   // 0 when no grid is loaded
+
+vec3 SampleIrradiance(vec3 position, vec3 n) {
+    if (u_irradianceStrength <= 0.0) return vec3(0.0);
+
+    // probes sit on texel centres; z stays half a texel inside each coefficient's slab so filtering never mixes them
+    vec3 cell = clamp((position - u_irradianceMin) / (u_irradianceMax - u_irradianceMin), 0.0, 1.0) * (u_irradianceDims - 1.0) + 0.5;
+    vec2 xy = cell.xy / u_irradianceDims.xy;
+    float slabs = u_irradianceDims.z * 9.0;
+
+    float basis[9] = float[9](
+        0.282095,
+        0.488603 * n.y, 0.488603 * n.z, 0.488603 * n.x,
+        1.092548 * n.x * n.y, 1.092548 * n.y * n.z, 0.315392 * (3.0 * n.z * n.z - 1.0),
+        1.092548 * n.x * n.z, 0.546274 * (n.x * n.x - n.y * n.y));
+
+    vec3 irradiance = vec3(0.0);
+    for (int k = 0; k < 9; k++) {
+        float z = (float(k) * u_irradianceDims.z + cell.z) / slabs;
+        irradiance += texture(u_irradianceGrid, vec3(xy, z)).rgb * basis[k];
+    }
+    return max(irradiance, vec3(0.0)) * u_irradianceStrength;
+}
+
+// same octahedral decode as deferred_light.fs
+vec3 DecodeNormal(vec2 f) {
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main() {
+    // leave the skybox where nothing was rasterized
+    float depth = texture(depthMap, fragTexCoord).r;
+    if (depth >= 1.0) discard;
+
+    vec3 texColor = pow(texture(albedoMap, fragTexCoord).rgb, vec3(2.2)); // gamma correction
+    vec3 ambient = u_ambientColor;
+    if (u_irradianceStrength > 0.0) {
+        // reconstruct world position from depth
+        vec4 world = u_invViewProj * vec4(vec3(fragTexCoord / u_regionScale, depth) * 2.0 - 1.0, 1.0);
+        vec3 N = DecodeNormal(texture(normalMap, fragTexCoord).rg);
+        ambient += SampleIrradiance(world.xyz / world.w, N);
+    }
+
+    fragColor = vec4(ambient * texColor, 1.0);
+    brightColor = vec4(0.0, 0.0, 0.0, 1.0);
+}
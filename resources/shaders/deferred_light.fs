@@ -0,0 +1,117 @@
+#version 330
+#define MAX_LIGHTS 1024
+#ifndef LIGHT_CAPACITY
+#define LIGHT_CAPACITY MAX_LIGHTS   // defined by light_buffer.cpp: lights the driver lets LightBlock hold
+#endif
+#define MAX_SHADOW_LIGHTS 16   // shadow_atlas.h
+
+// outputs
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out vec4 brightColor;
+
+flat in int lightIndex;
+
+// light struct, std140 layout mirrored by Light in renderer.h
+struct Light {
+    vec3 position;
+    float range;
+    vec3 color;
+    float intensity;
+};
+
+layout(std140) uniform LightBlock {
+    ivec4 u_lightInfo;
+    Light u_lights[LIGHT_CAPACITY];
+};
+
+// G-buffer
+uniform sampler2D albedoMap;
+uniform sampler2D normalMap;
+uniform sampler2D depthMap;
+
+uniform mat4 u_invViewProj;
+uniform vec2 u_screenSize;    // render region in pixels
+uniform vec2 u_regionScale;   // render region / G-buffer size
+uniform vec3 u_eyePos;
+
+// material uniforms
+uniform vec3 u_specularColor;
+uniform float u_shininess;
+
+// omni shadow atlas, see shadow_atlas.cpp
+layout(std140, row_major) uniform ShadowBlock {
+    mat4 u_shadowFaces[MAX_SHADOW_LIGHTS * 6];   // world -> cube face clip space
+    vec4 u_shadowRects[MAX_SHADOW_LIGHTS * 6];   // face tile in the atlas: uv offset, uv scale
+    ivec4 u_shadowSlots[MAX_LIGHTS / 4];         // slot + 1 per light, 0 = unshadowed
+};
+uniform sampler2DShadow u_shadowAtlas;
+
+float SampleShadow(int lightIndex, vec3 lightPos, vec3 position, vec3 normal) {
+    int slot = u_shadowSlots[lightIndex >> 2][lightIndex & 3] - 1;
+    if (slot < 0) return 1.0;
+
+    // the face is the major axis of the light-to-fragment direction
+    vec3 d = position - lightPos;
+    vec3 a = abs(d);
+    int face = (a.x >= a.y && a.x >= a.z) ? (d.x > 0.0 ? 0 : 1) : (a.y >= a.z ? (d.y > 0.0 ? 2 : 3) : (d.z > 0.0 ? 4 : 5));
+    int index = slot * 6 + face;
+    vec4 rect = u_shadowRects[index];
+
+    // offset along the normal by about a texel at this distance against acne
+    vec2 atlasSize = vec2(textureSize(u_shadowAtlas, 0));
+    float texelWorld = 2.0 * max(a.x, max(a.y, a.z)) / (rect.z * atlasSize.x);
+    vec4 clip = u_shadowFaces[index] * vec4(position + normal * texelWorld * 1.5, 1.0);
+    vec3 ndc = clip.xyz / clip.w;
+
+    // stay half a texel inside the tile so filtering never reads a neighbour
+    vec2 halfTexel = 0.5 / atlasSize;
+    vec2 uv = clamp(rect.xy + (ndc.xy * 0.5 + 0.5) * rect.zw, rect.xy + halfTexel, rect.xy + rect.zw - halfTexel);
+    return texture(u_shadowAtlas, vec3(uv, ndc.z * 0.5 + 0.5));
+}
+
+vec3 DecodeNormal(vec2 f) {
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main() {
+    vec2 screenUv = gl_FragCoord.xy / u_screenSize;
+    vec2 uv = screenUv * u_regionScale;
+    float depth = texture(depthMap, uv).r;
+    if (depth >= 1.0) discard;
+
+    // the volume's back face has to lie behind the surface (the depth test, done here on the sampled G-buffer depth)
+    if (gl_FragCoord.z < depth) discard;
+
+    // reconstruct world position from depth
+    vec4 world = u_invViewProj * vec4(vec3(screenUv, depth) * 2.0 - 1.0, 1.0);
+    vec3 fragPos = world.xyz / world.w;
+
+    vec3 N = DecodeNormal(texture(normalMap, uv).rg);
+    vec3 V = normalize(u_eyePos - fragPos);
+    vec3 texColor = pow(texture(albedoMap, uv).rgb, vec3(2.2)); // gamma correction
+
+    Light light = u_lights[lightIndex];
+    vec3 L = light.position - fragPos;
+    float dist = length(L);
+
+    // same attenuation as phong.fs
+    float rangeAttenuation = max(0.0, 1.0 - pow(dist/max(light.range, 0.001), 4.0));
+    rangeAttenuation = rangeAttenuation * rangeAttenuation;
+    float att = 1.0 / (1.0 + 0.09 * dist + 0.032 * dist * dist);
+    att *= rangeAttenuation;
+    if (att > 0.0) att *= SampleShadow(lightIndex, light.position, fragPos, N);
+
+    L = normalize(L);
+    float d = max(dot(N, L), 0.0);
+    vec3 diffuse = texColor * light.color * light.intensity * d * att;
+
+    vec3 R = reflect(-L, N);
+    float s = pow(max(dot(R, V), 0.0), u_shininess);
+    vec3 specular = s * u_specularColor * light.color * light.intensity * d * att;
+
+    fragColor = vec4(diffuse + specular, 1.0);
+    brightColor = vec4(0.0);
+}
@@ -0,0 +1,33 @@
+#version 330 core
+#define MAX_LIGHTS 1024
+#ifndef LIGHT_CAPACITY
+#define LIGHT_CAPACITY MAX_LIGHTS   // defined by light_buffer.cpp: lights the driver lets LightBlock hold
+#endif
+
+layout(location = 0) in vec3 vertexPosition;
+
+// light struct, std140 layout mirrored by Light in renderer.h
+struct Light {
+    vec3 position;
+    float range;
+    vec3 color;
+    float intensity;
+};
+
+layout(std140) uniform LightBlock {
+    ivec4 u_lightInfo;
+    Light u_lights[LIGHT_CAPACITY];
+};
+
+uniform mat4 u_viewProj;
+
+flat out int lightIndex;
+
+void main() {
+    // unit sphere scaled to the light's range; a little larger so the facets enclose it
+    Light light = u_lights[gl_InstanceID];
+    float scale = (light.intensity > 0.0) ? light.range * 1.1 : 0.0;
+
+    lightIndex = gl_InstanceID;
+    gl_Position = u_viewProj * vec4(light.position + vertexPosition * scale, 1.0);
+}
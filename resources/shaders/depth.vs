@@ -0,0 +1,16 @@
+#version 330 core
+
+layout(location = 0) in vec3 vertexPosition;
+
+layout(std140, row_major) uniform DrawBlock {
+    mat4 u_model;
+    mat4 u_normal;
+    mat4 u_mvp;
+};
+
+// must match default.vs bit for bit, the lit pass depth-tests with GL_EQUAL
+invariant gl_Position;
+
+void main() {
+    gl_Position = u_mvp * vec4(vertexPosition, 1.0);
+}
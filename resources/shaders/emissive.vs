@@ -0,0 +1,26 @@
+#version 330 core
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec2 vertexTexCoord;
+
+// per-instance Light, two vec4s: position/range and color/intensity
+layout(location = 10) in vec4 instancePosition;
+layout(location = 11) in vec4 instanceColor;
+
+uniform mat4 matView;
+uniform mat4 matProjection;
+uniform float u_instanceScale;
+
+out vec2 fragTexCoord;
+flat out vec3 emissiveColor;
+flat out float emissiveIntensity;
+
+void main() {
+    vec3 worldPos = instancePosition.xyz + vertexPosition * u_instanceScale;
+
+    fragTexCoord = vertexTexCoord;
+    emissiveColor = instanceColor.rgb;
+    emissiveIntensity = instanceColor.a;
+
+    gl_Position = matProjection * matView * vec4(worldPos, 1.0);
+}
@@ -0,0 +1,43 @@
+#version 330
+
+// HAS_NORMAL_MAP: sample the tangent-space normal map (else the interpolated normal);
+// deferred.cpp builds both variants and draws each material with the one that fits it
+
+// outputs
+layout (location = 0) out vec4 gAlbedo;
+layout (location = 1) out vec4 gNormal;
+
+// interpolated from vertex shader
+in vec3 fragPos;
+in vec2 fragTexCoord;
+in mat3 TBN;
+
+// material textures
+uniform sampler2D diffuseMap;
+uniform sampler2D normalMap;
+
+// octahedral normal encoding, [-1, 1] per component
+vec2 OctWrap(vec2 v) {
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 EncodeNormal(vec3 n) {
+    n /= (abs(n.x) + abs(n.y) + abs(n.z));
+    n.xy = (n.z >= 0.0) ? n.xy : OctWrap(n.xy);
+    return n.xy;
+}
+
+void main() {
+#ifdef HAS_NORMAL_MAP
+    // compute bumped normal; maps may be two-channel (BC5), so Z is rebuilt from X and Y
+    vec2 mapXY = texture(normalMap, fragTexCoord).rg * 2.0 - 1.0;
+    vec3 mapNormal = vec3(mapXY, sqrt(max(1.0 - dot(mapXY, mapXY), 0.0)));
+    vec3 N = normalize(TBN * mapNormal);
+#else
+    vec3 N = normalize(TBN[2]);
+#endif
+
+    // albedo stays gamma encoded, the lighting pass decodes it
+    gAlbedo = vec4(texture(diffuseMap, fragTexCoord).rgb, 1.0);
+    gNormal = vec4(EncodeNormal(N), 0.0, 1.0);
+}
@@ -6,13 +6,14 @@ in vec2 fragTexCoord;
 
 uniform float u_gamma;
 uniform float u_exposure;
+uniform float u_bloomStrength;
 
 uniform sampler2D hdrBuffer;
 uniform sampler2D bloomBlur;
 
 void main() {             
     vec3 hdrColor = texture(hdrBuffer, fragTexCoord).rgb;
-    vec3 bloomColor = texture(bloomBlur, fragTexCoord).rgb * 2.0;
+    vec3 bloomColor = texture(bloomBlur, fragTexCoord).rgb * u_bloomStrength;
     hdrColor += bloomColor;
 
     vec3 mapped = vec3(1.0) - exp(-hdrColor * u_exposure);
@@ -1,5 +1,15 @@
 #version 330
-#define MAX_LIGHTS 8
+#define MAX_LIGHTS 1024
+#define MAX_SHADOW_LIGHTS 16   // shadow_atlas.h
+
+// Permutation defines, injected by shader_permutations.cpp; the base program defines all of them
+//   HAS_NORMAL_MAP   sample the tangent-space normal map (else the interpolated normal)
+//   SRGB_DIFFUSE     sample the diffuse map and decode it (else raylib's white default texture)
+//   SPECULAR         Phong specular term
+//   LIGHT_CAPACITY   declared size of the light array, the active light count's bucket
+#ifndef LIGHT_CAPACITY
+#define LIGHT_CAPACITY MAX_LIGHTS
+#endif
 
 // outputs
 layout (location = 0) out vec4 fragColor;
@@ -10,46 +20,140 @@ in vec3 fragPos;
 in vec2 fragTexCoord;
 in mat3 TBN;
 
-// light struct
+// light struct, std140 layout mirrored by Light in renderer.h
 struct Light {
     vec3 position;
+    float range;  // maximum range of the light
     vec3 color;
     float intensity;
-    float range;  // maximum range of the light
 };
 
+// shared light buffer (x = active light count)
+layout(std140) uniform LightBlock {
+    ivec4 u_lightInfo;
+    Light u_lights[LIGHT_CAPACITY];
+};
+
+// clustered light lists, see light_clusters.cpp
+uniform usamplerBuffer u_clusterGrid;    // per cluster: offset, count
+uniform usamplerBuffer u_clusterLights;  // light indices
+uniform ivec3 u_clusterDims;
+uniform vec2 u_clusterDepth;             // slice = log(depth) * x + y
+uniform vec2 u_screenSize;
+uniform vec3 u_viewDir;
+uniform int u_clusterDebug;
+
 // scene uniforms
-uniform Light u_lights[MAX_LIGHTS];
 uniform vec3 u_eyePos;
 
 // material uniforms
 uniform vec3 u_ambientColor;
 uniform vec3 u_specularColor;
 uniform float u_shininess;
+uniform float u_bloomCutoff;   // lower edge of the bloom prefilter's soft knee
 
 // moon texture
 uniform sampler2D diffuseMap;
 uniform sampler2D normalMap;
 
-void main() {
-    // compute bumped normal
-    vec3 mapNormal = texture(normalMap, fragTexCoord).rgb * 2.0 - 1.0;
+// omni shadow atlas, see shadow_atlas.cpp
+layout(std140, row_major) uniform ShadowBlock {
+    mat4 u_shadowFaces[MAX_SHADOW_LIGHTS * 6];   // world -> cube face clip space
+    vec4 u_shadowRects[MAX_SHADOW_LIGHTS * 6];   // face tile in the atlas: uv offset, uv scale
+    ivec4 u_shadowSlots[MAX_LIGHTS / 4];         // slot + 1 per light, 0 = unshadowed
+};
+uniform sampler2DShadow u_shadowAtlas;
+
+float SampleShadow(int lightIndex, vec3 lightPos, vec3 position, vec3 normal) {
+    int slot = u_shadowSlots[lightIndex >> 2][lightIndex & 3] - 1;
+    if (slot < 0) return 1.0;
+
+    // the face is the major axis of the light-to-fragment direction
+    vec3 d = position - lightPos;
+    vec3 a = abs(d);
+    int face = (a.x >= a.y && a.x >= a.z) ? (d.x > 0.0 ? 0 : 1) : (a.y >= a.z ? (d.y > 0.0 ? 2 : 3) : (d.z > 0.0 ? 4 : 5));
+    int index = slot * 6 + face;
+    vec4 rect = u_shadowRects[index];
+
+    // offset along the normal by about a texel at this distance against acne
+    vec2 atlasSize = vec2(textureSize(u_shadowAtlas, 0));
+    float texelWorld = 2.0 * max(a.x, max(a.y, a.z)) / (rect.z * atlasSize.x);
+    vec4 clip = u_shadowFaces[index] * vec4(position + normal * texelWorld * 1.5, 1.0);
+    vec3 ndc = clip.xyz / clip.w;
+
+    // stay half a texel inside the tile so filtering never reads a neighbour
+    vec2 halfTexel = 0.5 / atlasSize;
+    vec2 uv = clamp(rect.xy + (ndc.xy * 0.5 + 0.5) * rect.zw, rect.xy + halfTexel, rect.xy + rect.zw - halfTexel);
+    return texture(u_shadowAtlas, vec3(uv, ndc.z * 0.5 + 0.5));
+}
 
-    // normalize inputs
+// baked irradiance probe grid, see irradiance_grid.cpp: L2 SH coefficients stacked along z
+uniform sampler3D u_irradianceGrid;
+uniform vec3 u_irradianceMin;         // first and last probe positions
+uniform vec3 u_irradianceMax;
+uniform vec3 u_irradianceDims;        // probes per axis
+uniform float u_irradianceStrength;   // 0 when no grid is loaded
+
+vec3 SampleIrradiance(vec3 position, vec3 n) {
+    if (u_irradianceStrength <= 0.0) return vec3(0.0);
+
+    // probes sit on texel centres; z stays half a texel inside each coefficient's slab so filtering never mixes them
+    vec3 cell = clamp((position - u_irradianceMin) / (u_irradianceMax - u_irradianceMin), 0.0, 1.0) * (u_irradianceDims - 1.0) + 0.5;
+    vec2 xy = cell.xy / u_irradianceDims.xy;
+    float slabs = u_irradianceDims.z * 9.0;
+
+    float basis[9] = float[9](
+        0.282095,
+        0.488603 * n.y, 0.488603 * n.z, 0.488603 * n.x,
+        1.092548 * n.x * n.y, 1.092548 * n.y * n.z, 0.315392 * (3.0 * n.z * n.z - 1.0),
+        1.092548 * n.x * n.z, 0.546274 * (n.x * n.x - n.y * n.y));
+
+    vec3 irradiance = vec3(0.0);
+    for (int k = 0; k < 9; k++) {
+        float z = (float(k) * u_irradianceDims.z + cell.z) / slabs;
+        irradiance += texture(u_irradianceGrid, vec3(xy, z)).rgb * basis[k];
+    }
+    return max(irradiance, vec3(0.0)) * u_irradianceStrength;
+}
+
+void main() {
+    vec3 surfaceNormal = normalize(TBN[2]);   // unbumped, for the shadow lookup
+#ifdef HAS_NORMAL_MAP
+    // compute bumped normal; maps may be two-channel (BC5), so Z is rebuilt from X and Y
+    vec2 mapXY = texture(normalMap, fragTexCoord).rg * 2.0 - 1.0;
+    vec3 mapNormal = vec3(mapXY, sqrt(max(1.0 - dot(mapXY, mapXY), 0.0)));
     vec3 N = normalize(TBN * mapNormal);
+#else
+    vec3 N = surfaceNormal;
+#endif
+
+#ifdef SPECULAR
     vec3 V = normalize(u_eyePos - fragPos);
+#endif
 
     // texture
+#ifdef SRGB_DIFFUSE
     vec3 texColor = texture(diffuseMap, fragTexCoord).rgb;
-
     texColor = pow(texColor, vec3(2.2)); // gamma correction
+#else
+    vec3 texColor = vec3(1.0);
+#endif
+
+    // find this fragment's cluster
+    float viewDepth = dot(fragPos - u_eyePos, u_viewDir);
+    int slice = clamp(int(log(max(viewDepth, 1e-4)) * u_clusterDepth.x + u_clusterDepth.y), 0, u_clusterDims.z - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / u_screenSize * vec2(u_clusterDims.xy)), ivec2(0), u_clusterDims.xy - 1);
+    int cluster = tile.x + u_clusterDims.x * (tile.y + u_clusterDims.y * slice);
+    uvec2 lightRange = texelFetch(u_clusterGrid, cluster).xy;
 
     // accumulators
-    vec3 ambientAccum = vec3(0.0);
+    vec3 ambientAccum = (u_ambientColor + SampleIrradiance(fragPos, N)) * texColor;
     vec3 diffuseAccum = vec3(0.0);
     vec3 specularAccum = vec3(0.0);
 
-    for (int i = 0; i < MAX_LIGHTS; i++) {
+    for (uint c = 0u; c < lightRange.y; c++) {
+        int i = int(texelFetch(u_clusterLights, int(lightRange.x + c)).r);
+        if (i >= LIGHT_CAPACITY) continue;   // light count grew past this variant's bucket until it is swapped
         vec3 L = u_lights[i].position - fragPos;
 
         // inverse-square attenuation
@@ -67,26 +171,34 @@ void main() {
         
         // Combine both attenuation types
         att *= rangeAttenuation;
+        if (att > 0.0) att *= SampleShadow(i, u_lights[i].position, fragPos, surfaceNormal);
         
         L = normalize(L);
 
-        // ambient
-        ambientAccum += u_ambientColor * texColor;
-
         // diffuse
         float d = max(dot(N, L), 0.0);
         diffuseAccum += texColor * u_lights[i].color * u_lights[i].intensity * d * att;
 
+#ifdef SPECULAR
         // specular
         vec3 R = reflect(-L, N);
         float s = pow(max(dot(R, V), 0.0), u_shininess);
         specularAccum += s * u_specularColor * u_lights[i].color * u_lights[i].intensity * d * att;
+#endif
     }
 
     fragColor = vec4(ambientAccum + diffuseAccum + specularAccum, 1.0);
 
-    float brightness = dot(fragColor.rgb, vec3(0.2126, 0.7152, 0.0722));
-    if (brightness > 2.5) 
+    // lights-per-cluster heatmap: blue (few) to red (many)
+    if (u_clusterDebug == 1) {
+        float heat = clamp(float(lightRange.y) / 32.0, 0.0, 1.0);
+        fragColor = vec4(mix(vec3(0.0, 0.2, 1.0), vec3(1.0, 0.1, 0.0), heat) * (lightRange.y > 0u ? 4.0 : 0.2), 1.0);
+        brightColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    float brightness = max(fragColor.r, max(fragColor.g, fragColor.b));
+    if (brightness > u_bloomCutoff)
         brightColor = vec4(fragColor.rgb, 1.0);
     else 
         brightColor = vec4(0.0, 0.0, 0.0, 1.0);
@@ -0,0 +1,42 @@
+#version 330
+#define TAPS 16
+
+out vec4 fragColor;
+
+uniform samplerCube environmentMap;   // restricted to the mip above the one being written
+uniform int u_face;
+uniform float u_faceSize;
+uniform float u_coneAngle;            // half-angle of the filter cone in radians
+
+// Direction through a texel of a cubemap face, in GL's face orientation
+vec3 FaceDirection(int face, vec2 uv) {
+    vec2 c = uv * 2.0 - 1.0;
+    if (face == 0) return vec3(1.0, -c.y, -c.x);
+    if (face == 1) return vec3(-1.0, -c.y, c.x);
+    if (face == 2) return vec3(c.x, 1.0, c.y);
+    if (face == 3) return vec3(c.x, -1.0, -c.y);
+    if (face == 4) return vec3(c.x, -c.y, 1.0);
+    return vec3(-c.x, -c.y, -1.0);
+}
+
+void main() {
+    vec3 N = normalize(FaceDirection(u_face, gl_FragCoord.xy / u_faceSize));
+    vec3 up = abs(N.y) < 0.999 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 T = normalize(cross(up, N));
+    vec3 B = cross(N, T);
+
+    // gaussian-weighted golden-angle spiral over the cone; each mip widens the previous one's blur
+    float spread = tan(u_coneAngle);
+    vec3 sum = textureLod(environmentMap, N, 0.0).rgb;
+    float weight = 1.0;
+    for (int i = 0; i < TAPS; i++) {
+        float r = sqrt((float(i) + 0.5) / float(TAPS));
+        float a = float(i) * 2.39996323;
+        vec2 offset = vec2(cos(a), sin(a)) * r * spread;
+        float w = exp(-2.0 * r * r);
+        sum += textureLod(environmentMap, normalize(N + T * offset.x + B * offset.y), 0.0).rgb * w;
+        weight += w;
+    }
+
+    fragColor = vec4(sum / weight, 1.0);
+}
@@ -0,0 +1,60 @@
+#version 330
+
+out vec4 fragColor;
+
+in vec2 fragTexCoord;   // output-resolution uv
+
+uniform sampler2D historyMap;     // last frame's resolve, output resolution
+uniform sampler2D currentColor;   // this frame's HDR color, rendered into the top-left region
+uniform sampler2D depthMap;       // this frame's depth, same region
+
+uniform vec2 u_regionScale;   // render region size / target size
+uniform vec2 u_texelSize;     // one texel of currentColor
+uniform vec2 u_jitter;        // projection jitter in uv units
+uniform mat4 u_invViewProj;   // unjittered, this frame
+uniform mat4 u_prevViewProj;  // unjittered, last frame
+uniform float u_feedback;
+uniform int u_historyValid;
+
+float Luma(vec3 color) {
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+void main() {
+    // undo the jitter and map into the render region, staying a half texel inside it
+    vec2 regionMax = u_regionScale - u_texelSize * 0.5;
+    vec2 uv = clamp((fragTexCoord + u_jitter) * u_regionScale, u_texelSize * 0.5, regionMax);
+    vec3 current = texture(currentColor, uv).rgb;
+
+    // neighbourhood bounds the history may not leave, so disocclusions and moving orbs do not ghost
+    vec3 minColor = current;
+    vec3 maxColor = current;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            if (x == 0 && y == 0) continue;
+            vec2 tap = clamp(uv + vec2(x, y) * u_texelSize, u_texelSize * 0.5, regionMax);
+            vec3 neighbour = texture(currentColor, tap).rgb;
+            minColor = min(minColor, neighbour);
+            maxColor = max(maxColor, neighbour);
+        }
+    }
+
+    // reproject through the camera matrices; the scene is static apart from the orbs
+    float depth = texture(depthMap, uv).r;
+    vec4 world = u_invViewProj * vec4(vec3(fragTexCoord, depth) * 2.0 - 1.0, 1.0);
+    vec4 previous = u_prevViewProj * vec4(world.xyz / world.w, 1.0);
+    vec2 previousUv = previous.xy / previous.w * 0.5 + 0.5;
+
+    bool offscreen = any(lessThan(previousUv, vec2(0.0))) || any(greaterThan(previousUv, vec2(1.0)));
+    if (u_historyValid == 0 || offscreen) {
+        fragColor = vec4(current, 1.0);
+        return;
+    }
+
+    vec3 history = clamp(texture(historyMap, previousUv).rgb, minColor, maxColor);
+
+    // luma-weighted blend keeps single bright samples from smearing across frames
+    float currentWeight = (1.0 - u_feedback) / (1.0 + Luma(current));
+    float historyWeight = u_feedback / (1.0 + Luma(history));
+    fragColor = vec4((current * currentWeight + history * historyWeight) / (currentWeight + historyWeight), 1.0);
+}
@@ -0,0 +1,75 @@
+#version 330
+
+out vec4 fragColor;
+
+in vec2 fragTexCoord;
+
+uniform float u_gamma;
+uniform float u_exposure;
+uniform float u_bloomStrength;
+uniform vec2 u_texelStep;
+
+uniform sampler2D hdrBuffer;
+uniform sampler2D bloomBlur;
+
+// FXAA settings, as in fxaa.fs
+#define FXAA_REDUCE_MIN   (1.0/ 128.0)
+#define FXAA_REDUCE_MUL   (1.0 / 8.0)
+#define FXAA_SPAN_MAX     8.0
+
+// hdr.fs for one tap: scene plus bloom, exposure and gamma
+vec3 Tonemap(vec2 uv) {
+    vec3 hdrColor = texture(hdrBuffer, uv).rgb + texture(bloomBlur, uv).rgb * u_bloomStrength;
+    vec3 mapped = vec3(1.0) - exp(-hdrColor * u_exposure);
+    return pow(mapped, vec3(1.0 / u_gamma));
+}
+
+// Tone mapped color in rgb, its luma in a, so each tap is mapped and weighed once
+vec4 TonemapLuma(vec2 uv) {
+    vec3 color = Tonemap(uv);
+    return vec4(color, dot(color, vec3(0.299, 0.587, 0.114)));
+}
+
+void main() {
+    // fxaa.fs on tone mapped taps: no LDR target is written and read back in between
+    vec2 texelStep = u_texelStep;
+    float lumaNW = TonemapLuma(fragTexCoord + vec2(-1.0, -1.0) * texelStep).a;
+    float lumaNE = TonemapLuma(fragTexCoord + vec2(1.0, -1.0) * texelStep).a;
+    float lumaSW = TonemapLuma(fragTexCoord + vec2(-1.0, 1.0) * texelStep).a;
+    float lumaSE = TonemapLuma(fragTexCoord + vec2(1.0, 1.0) * texelStep).a;
+    vec4 center  = TonemapLuma(fragTexCoord);
+    float lumaM  = center.a;
+
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+    // Flat neighborhoods keep the center tap as it is
+    if (lumaMax - lumaMin < FXAA_REDUCE_MIN) {
+        fragColor = vec4(center.rgb, 1.0);
+        return;
+    }
+
+    vec2 dir;
+    dir.x = -((lumaNW + lumaNE) - (lumaSW + lumaSE));
+    dir.y =  ((lumaNW + lumaSW) - (lumaNE + lumaSE));
+
+    float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 * FXAA_REDUCE_MUL), FXAA_REDUCE_MIN);
+
+    float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+
+    dir = min(vec2(FXAA_SPAN_MAX, FXAA_SPAN_MAX),
+          max(vec2(-FXAA_SPAN_MAX, -FXAA_SPAN_MAX),
+          dir * rcpDirMin)) * texelStep;
+
+    vec3 rgbA = 0.5 * (
+        Tonemap(fragTexCoord + dir * (1.0/3.0 - 0.5)) +
+        Tonemap(fragTexCoord + dir * (2.0/3.0 - 0.5)));
+
+    vec3 rgbB = rgbA * 0.5 + 0.25 * (
+        Tonemap(fragTexCoord + dir * (0.0/3.0 - 0.5)) +
+        Tonemap(fragTexCoord + dir * (3.0/3.0 - 0.5)));
+
+    float lumaB = dot(rgbB, vec3(0.299, 0.587, 0.114));
+
+    fragColor = ((lumaB < lumaMin) || (lumaB > lumaMax)) ? vec4(rgbA, 1.0) : vec4(rgbB, 1.0);
+}
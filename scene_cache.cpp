@@ -0,0 +1,488 @@
+#include "scene_cache.h"
+#include "mapped_file.h"
+#include "texture_compression.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+
+#define SCENE_CACHE_ALIGNMENT 16
+#define SCENE_CACHE_PAGE 4096
+
+const char* sceneSourceFiles[SCENE_SOURCE_COUNT] = {
+    "resources/objects/sponza.glb",
+    "resources/textures/right.jpg", "resources/textures/left.jpg", "resources/textures/top.jpg",
+    "resources/textures/bottom.jpg", "resources/textures/front.jpg", "resources/textures/back.jpg",
+    "resources/textures/sun.jpg"
+};
+
+// What a source file looked like when the cache was cooked
+typedef struct {
+    int64_t size;
+    int64_t modTime;
+} SceneCacheSource;
+
+// Block-compressed mip chain, level 0 first, each level right after the previous one
+typedef struct {
+    int32_t width;
+    int32_t height;
+    int32_t mipmaps;
+    int32_t codec;            // TextureCodec
+    uint64_t offset;
+    uint64_t size;
+} CachedTexture;
+
+// File layout: header, then tables and data blocks at 16-byte aligned absolute offsets
+typedef struct {
+    char magic[4];            // "SCNC"
+    uint32_t version;
+    SceneCacheSource sources[SCENE_SOURCE_COUNT];
+    uint32_t textureCount;
+    uint32_t materialCount;
+    uint32_t meshCount;
+    uint32_t skyboxSize;      // face edge in pixels
+    int32_t skyboxCodec;      // TextureCodec of every face
+    uint32_t padding;
+    uint64_t texturesOffset;  // CachedTexture[textureCount]
+    uint64_t materialsOffset; // CachedMaterial[materialCount]
+    uint64_t meshesOffset;    // CachedMesh[meshCount]
+    uint64_t skyboxOffset;    // six encoded faces back to back, cubemap order
+    CachedTexture sun;        // orb emission texture
+    uint64_t fileSize;
+} SceneCacheHeader;
+
+typedef struct {
+    int32_t diffuseTexture;   // -1 keeps raylib's default texture
+    int32_t normalTexture;    // -1 leaves the map empty, like the glTF loader
+    uint8_t diffuseColor[4];
+} CachedMaterial;
+
+// raylib Mesh arrays exactly as UploadMesh takes them; offset 0 means absent
+typedef struct {
+    int32_t vertexCount;
+    int32_t triangleCount;
+    int32_t material;
+    int32_t padding;
+    uint64_t vertices;        // float3
+    uint64_t texcoords;       // float2
+    uint64_t normals;         // float3
+    uint64_t tangents;        // float4
+    uint64_t colors;          // ubyte4
+    uint64_t indices;         // ushort, three per triangle
+} CachedMesh;
+
+static MappedFile cacheFile = { 0 };
+static const SceneCacheHeader* header = NULL;
+static std::vector<Texture2D> cacheTextures;
+static SceneCacheInfo info = { 0 };
+
+static bool StatSource(const char* path, SceneCacheSource* source) {
+    struct stat status;
+    if (stat(path, &status) != 0) return false;
+    source->size = (int64_t)status.st_size;
+    source->modTime = (int64_t)status.st_mtime;
+    return true;
+}
+
+// Sizes of a mesh's arrays, shared by the writer and the bounds check
+static void MeshArraySizes(int vertexCount, int triangleCount, uint64_t* sizes) {
+    sizes[0] = (uint64_t)vertexCount * 3 * sizeof(float);
+    sizes[1] = (uint64_t)vertexCount * 2 * sizeof(float);
+    sizes[2] = (uint64_t)vertexCount * 3 * sizeof(float);
+    sizes[3] = (uint64_t)vertexCount * 4 * sizeof(float);
+    sizes[4] = (uint64_t)vertexCount * 4;
+    sizes[5] = (uint64_t)triangleCount * 3 * sizeof(unsigned short);
+}
+
+// Aligned space at the end of the file being cooked, optionally filled
+static uint64_t Append(std::vector<unsigned char>& file, const void* data, size_t size) {
+    size_t offset = (file.size() + SCENE_CACHE_ALIGNMENT - 1) & ~(size_t)(SCENE_CACHE_ALIGNMENT - 1);
+    file.resize(offset + size);
+    if (data != NULL) memcpy(&file[offset], data, size);
+    return (uint64_t)offset;
+}
+
+// Mipmap an RGBA8 image on the CPU and append it block-compressed
+static CachedTexture AppendTexture(std::vector<unsigned char>& file, Image* image, TextureCodec codec, size_t* uncompressedBytes) {
+    ImageMipmaps(image);
+    size_t size = GetCompressedChainSize(codec, image->width, image->height, image->mipmaps);
+    CachedTexture cached = { image->width, image->height, image->mipmaps, codec, Append(file, NULL, size), size };
+    EncodeTextureChain(*image, codec, &file[cached.offset]);
+    *uncompressedBytes += GetCompressedChainSize(TEXTURE_CODEC_NONE, image->width, image->height, image->mipmaps);
+    return cached;
+}
+
+// Color maps with any transparency keep their alpha in BC3, the rest go to BC1
+static TextureCodec ColorCodec(Image image) {
+    const unsigned char* pixels = (const unsigned char*)image.data;
+    for (int i = 0; i < image.width * image.height; i++) {
+        if (pixels[i * 4 + 3] < 255) return TEXTURE_CODEC_BC3;
+    }
+    return TEXTURE_CODEC_BC1;
+}
+
+bool CookSceneCache(const char* path, Model model, const Image* skyFaces, Image sun) {
+    int faceSize = skyFaces[0].width;
+    for (int i = 0; i < 6; i++) {
+        if (skyFaces[i].width != faceSize || skyFaces[i].height != faceSize || skyFaces[i].format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+            TraceLog(LOG_WARNING, "COOK: Skybox faces must be square RGBA8 images of one size");
+            return false;
+        }
+    }
+    if (sun.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        TraceLog(LOG_WARNING, "COOK: The sun texture must be an RGBA8 image");
+        return false;
+    }
+
+    SceneCacheHeader fileHeader = { 0 };
+    memcpy(fileHeader.magic, "SCNC", 4);
+    fileHeader.version = SCENE_CACHE_VERSION;
+    for (int i = 0; i < SCENE_SOURCE_COUNT; i++) {
+        if (!StatSource(sceneSourceFiles[i], &fileHeader.sources[i])) {
+            TraceLog(LOG_WARNING, "COOK: Missing source %s", sceneSourceFiles[i]);
+            return false;
+        }
+    }
+
+    std::vector<unsigned char> file(sizeof(SceneCacheHeader));
+    size_t uncompressedBytes = 0;
+
+    // Textures are shared between materials; each is read back once, mipmapped and encoded
+    // on the CPU. Normal maps keep only X and Y (BC5), the shaders rebuild Z.
+    std::vector<unsigned int> textureIds;
+    std::vector<CachedTexture> textures;
+    auto cookTexture = [&](Texture2D texture, bool normalMap) -> int {
+        if (texture.id == 0 || texture.id == rlGetTextureIdDefault()) return -1;
+        for (size_t i = 0; i < textureIds.size(); i++) {
+            if (textureIds[i] == texture.id) return (int)i;
+        }
+
+        Image image = LoadImageFromTexture(texture);
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        TextureCodec codec = normalMap ? TEXTURE_CODEC_BC5 : ColorCodec(image);
+        CachedTexture cached = AppendTexture(file, &image, codec, &uncompressedBytes);
+        UnloadImage(image);
+
+        textureIds.push_back(texture.id);
+        textures.push_back(cached);
+        return (int)textures.size() - 1;
+    };
+
+    std::vector<CachedMaterial> materials(model.materialCount);
+    for (int i = 0; i < model.materialCount; i++) {
+        const MaterialMap* maps = model.materials[i].maps;
+        Color color = maps[MATERIAL_MAP_DIFFUSE].color;
+        materials[i].diffuseTexture = cookTexture(maps[MATERIAL_MAP_DIFFUSE].texture, false);
+        materials[i].normalTexture = cookTexture(maps[MATERIAL_MAP_NORMAL].texture, true);
+        materials[i].diffuseColor[0] = color.r;
+        materials[i].diffuseColor[1] = color.g;
+        materials[i].diffuseColor[2] = color.b;
+        materials[i].diffuseColor[3] = color.a;
+    }
+
+    std::vector<CachedMesh> meshes(model.meshCount);
+    for (int i = 0; i < model.meshCount; i++) {
+        const Mesh* mesh = &model.meshes[i];
+        uint64_t sizes[6];
+        MeshArraySizes(mesh->vertexCount, mesh->triangleCount, sizes);
+
+        CachedMesh* cached = &meshes[i];
+        cached->vertexCount = mesh->vertexCount;
+        cached->triangleCount = mesh->triangleCount;
+        cached->material = model.meshMaterial[i];
+        cached->vertices = mesh->vertices ? Append(file, mesh->vertices, sizes[0]) : 0;
+        cached->texcoords = mesh->texcoords ? Append(file, mesh->texcoords, sizes[1]) : 0;
+        cached->normals = mesh->normals ? Append(file, mesh->normals, sizes[2]) : 0;
+        cached->tangents = mesh->tangents ? Append(file, mesh->tangents, sizes[3]) : 0;
+        cached->colors = mesh->colors ? Append(file, mesh->colors, sizes[4]) : 0;
+        cached->indices = mesh->indices ? Append(file, mesh->indices, sizes[5]) : 0;
+    }
+
+    // Six BC1 faces in one contiguous block; the sky has no mips and no alpha
+    size_t faceBytes = GetCompressedLevelSize(TEXTURE_CODEC_BC1, faceSize, faceSize);
+    fileHeader.skyboxSize = (uint32_t)faceSize;
+    fileHeader.skyboxCodec = TEXTURE_CODEC_BC1;
+    fileHeader.skyboxOffset = Append(file, NULL, faceBytes * 6);
+    for (int i = 0; i < 6; i++) {
+        Image face = skyFaces[i];
+        face.mipmaps = 1;
+        EncodeTextureChain(face, TEXTURE_CODEC_BC1, &file[fileHeader.skyboxOffset + faceBytes * i]);
+        uncompressedBytes += GetCompressedLevelSize(TEXTURE_CODEC_NONE, faceSize, faceSize);
+    }
+
+    Image sunCopy = ImageCopy(sun);
+    fileHeader.sun = AppendTexture(file, &sunCopy, ColorCodec(sunCopy), &uncompressedBytes);
+    UnloadImage(sunCopy);
+
+    fileHeader.textureCount = (uint32_t)textures.size();
+    fileHeader.materialCount = (uint32_t)materials.size();
+    fileHeader.meshCount = (uint32_t)meshes.size();
+    fileHeader.texturesOffset = Append(file, textures.data(), textures.size() * sizeof(CachedTexture));
+    fileHeader.materialsOffset = Append(file, materials.data(), materials.size() * sizeof(CachedMaterial));
+    fileHeader.meshesOffset = Append(file, meshes.data(), meshes.size() * sizeof(CachedMesh));
+    fileHeader.fileSize = file.size();
+    memcpy(file.data(), &fileHeader, sizeof(fileHeader));
+
+    FILE* output = fopen(path, "wb");
+    if (output == NULL) {
+        TraceLog(LOG_WARNING, "COOK: Could not write %s", path);
+        return false;
+    }
+    bool written = fwrite(file.data(), 1, file.size(), output) == file.size();
+    fclose(output);
+
+    TraceLog(LOG_INFO, "COOK: %s: %d meshes, %d materials, %d textures, %dpx skybox, %.1f MB",
+             path, (int)meshes.size(), (int)materials.size(), (int)textures.size(), faceSize, (double)file.size() / (1024.0 * 1024.0));
+    size_t compressedBytes = faceBytes * 6 + fileHeader.sun.size;
+    for (const CachedTexture& texture : textures) compressedBytes += texture.size;
+    TraceLog(LOG_INFO, "COOK: Textures %.1f MB block-compressed, %.1f MB as RGBA8", (double)compressedBytes / (1024.0 * 1024.0),
+             (double)uncompressedBytes / (1024.0 * 1024.0));
+    return written;
+}
+
+static bool InFile(uint64_t offset, uint64_t size) {
+    return offset <= cacheFile.size && size <= cacheFile.size - offset;
+}
+
+static bool ValidTexture(const CachedTexture* texture) {
+    if (texture->codec <= TEXTURE_CODEC_NONE || texture->codec > TEXTURE_CODEC_BC5 || texture->width <= 0 || texture->height <= 0 || texture->mipmaps <= 0) return false;
+    return texture->size == GetCompressedChainSize((TextureCodec)texture->codec, texture->width, texture->height, texture->mipmaps) &&
+           InFile(texture->offset, texture->size);
+}
+
+static uint64_t SkyboxBytes() {
+    return GetCompressedLevelSize((TextureCodec)header->skyboxCodec, (int)header->skyboxSize, (int)header->skyboxSize) * 6;
+}
+
+static const CachedTexture* Textures() {
+    return (const CachedTexture*)(cacheFile.data + header->texturesOffset);
+}
+
+static const CachedMesh* Meshes() {
+    return (const CachedMesh*)(cacheFile.data + header->meshesOffset);
+}
+
+// Every table and block lies inside the mapping
+static bool ValidateLayout() {
+    if (header->fileSize != cacheFile.size) return false;
+    if (!InFile(header->texturesOffset, (uint64_t)header->textureCount * sizeof(CachedTexture)) ||
+        !InFile(header->materialsOffset, (uint64_t)header->materialCount * sizeof(CachedMaterial)) ||
+        !InFile(header->meshesOffset, (uint64_t)header->meshCount * sizeof(CachedMesh))) return false;
+    if (header->skyboxCodec <= TEXTURE_CODEC_NONE || header->skyboxCodec > TEXTURE_CODEC_BC5 ||
+        !InFile(header->skyboxOffset, SkyboxBytes()) || !ValidTexture(&header->sun)) return false;
+
+    for (uint32_t i = 0; i < header->textureCount; i++) {
+        if (!ValidTexture(&Textures()[i])) return false;
+    }
+
+    const CachedMaterial* materials = (const CachedMaterial*)(cacheFile.data + header->materialsOffset);
+    for (uint32_t i = 0; i < header->materialCount; i++) {
+        if (materials[i].diffuseTexture >= (int32_t)header->textureCount || materials[i].normalTexture >= (int32_t)header->textureCount) return false;
+    }
+
+    for (uint32_t i = 0; i < header->meshCount; i++) {
+        const CachedMesh* mesh = &Meshes()[i];
+        if (mesh->vertexCount < 0 || mesh->triangleCount < 0 || mesh->material < 0 || mesh->material >= (int32_t)header->materialCount) return false;
+
+        uint64_t sizes[6];
+        MeshArraySizes(mesh->vertexCount, mesh->triangleCount, sizes);
+        const uint64_t offsets[6] = { mesh->vertices, mesh->texcoords, mesh->normals, mesh->tangents, mesh->colors, mesh->indices };
+        for (int a = 0; a < 6; a++) {
+            if (offsets[a] != 0 && !InFile(offsets[a], sizes[a])) return false;
+        }
+    }
+    return true;
+}
+
+bool OpenSceneCache(const char* path) {
+    info = SceneCacheInfo{ 0 };
+
+    if (!MapFile(path, &cacheFile)) {
+        TraceLog(LOG_INFO, "SCENE CACHE: None at %s, loading source assets (build the cook target to create it)", path);
+        return false;
+    }
+
+    header = (const SceneCacheHeader*)cacheFile.data;
+    bool valid = cacheFile.size >= sizeof(SceneCacheHeader) && memcmp(header->magic, "SCNC", 4) == 0 &&
+                 header->version == SCENE_CACHE_VERSION;
+    const char* reason = valid ? NULL : "older cache version";
+
+    for (int i = 0; valid && i < SCENE_SOURCE_COUNT; i++) {
+        SceneCacheSource source;
+        if (!StatSource(sceneSourceFiles[i], &source) || source.size != header->sources[i].size || source.modTime != header->sources[i].modTime) {
+            valid = false;
+            reason = sceneSourceFiles[i];
+        }
+    }
+    if (valid && !ValidateLayout()) {
+        valid = false;
+        reason = "truncated or corrupt";
+    }
+
+    if (!valid) {
+        TraceLog(LOG_WARNING, "SCENE CACHE: %s is stale (%s), loading source assets; rebuild the cook target", path, reason);
+        UnmapFile(&cacheFile);
+        header = NULL;
+        info.stale = true;
+        return false;
+    }
+
+    cacheTextures.assign(header->textureCount, Texture2D{ 0 });
+    info.used = true;
+    info.bytes = cacheFile.size;
+    return true;
+}
+
+void CloseSceneCache(Model* model) {
+    if (!info.used || header == NULL) return;
+
+    // The mesh arrays are views into the mapping; keep UnloadModel from freeing them
+    for (int i = 0; i < model->meshCount; i++) {
+        Mesh* mesh = &model->meshes[i];
+        mesh->vertices = NULL;
+        mesh->texcoords = NULL;
+        mesh->normals = NULL;
+        mesh->tangents = NULL;
+        mesh->colors = NULL;
+        mesh->indices = NULL;
+    }
+
+    // UnloadModel leaves textures alone; these belong to the cache
+    for (size_t i = 0; i < cacheTextures.size(); i++) {
+        if (cacheTextures[i].id != 0) UnloadTexture(cacheTextures[i]);
+    }
+    cacheTextures.clear();
+
+    UnmapFile(&cacheFile);
+    header = NULL;
+}
+
+// Fault a range of the mapping in ahead of the upload that reads it
+static void TouchPages(uint64_t offset, uint64_t size) {
+    volatile unsigned char sink = 0;
+    for (uint64_t at = 0; at < size; at += SCENE_CACHE_PAGE) sink ^= cacheFile.data[offset + at];
+    (void)sink;
+}
+
+int GetSceneCacheTextureCount() {
+    return header ? (int)header->textureCount : 0;
+}
+
+void PrefetchSceneCacheTexture(int index) {
+    TouchPages(Textures()[index].offset, Textures()[index].size);
+}
+
+void PrefetchSceneCacheGeometry() {
+    for (uint32_t i = 0; i < header->meshCount; i++) {
+        const CachedMesh* mesh = &Meshes()[i];
+        uint64_t sizes[6];
+        MeshArraySizes(mesh->vertexCount, mesh->triangleCount, sizes);
+        const uint64_t offsets[6] = { mesh->vertices, mesh->texcoords, mesh->normals, mesh->tangents, mesh->colors, mesh->indices };
+        for (int a = 0; a < 6; a++) {
+            if (offsets[a] != 0) TouchPages(offsets[a], sizes[a]);
+        }
+    }
+}
+
+void PrefetchSceneCacheSkybox() {
+    TouchPages(header->skyboxOffset, SkyboxBytes());
+}
+
+void PrefetchSceneCacheSun() {
+    TouchPages(header->sun.offset, header->sun.size);
+}
+
+static Texture2D UploadTexture(const CachedTexture* cached) {
+    return LoadCompressedTexture(cacheFile.data + cached->offset, cached->width, cached->height, cached->mipmaps, (TextureCodec)cached->codec);
+}
+
+void UploadSceneCacheTexture(int index) {
+    cacheTextures[index] = UploadTexture(&Textures()[index]);
+}
+
+Texture2D UploadSceneCacheSun() {
+    return UploadTexture(&header->sun);
+}
+
+Model UploadSceneCacheModel() {
+    const CachedMaterial* materials = (const CachedMaterial*)(cacheFile.data + header->materialsOffset);
+
+    // Arrays UnloadModel frees come from raylib's allocator
+    Model model = { 0 };
+    model.transform = MatrixIdentity();
+    model.materialCount = (int)header->materialCount;
+    model.materials = (Material*)MemAlloc(sizeof(Material) * header->materialCount);
+    for (int i = 0; i < model.materialCount; i++) {
+        model.materials[i] = LoadMaterialDefault();
+        if (materials[i].diffuseTexture >= 0) model.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture = cacheTextures[materials[i].diffuseTexture];
+        if (materials[i].normalTexture >= 0) model.materials[i].maps[MATERIAL_MAP_NORMAL].texture = cacheTextures[materials[i].normalTexture];
+        const uint8_t* color = materials[i].diffuseColor;
+        model.materials[i].maps[MATERIAL_MAP_DIFFUSE].color = Color{ color[0], color[1], color[2], color[3] };
+    }
+
+    // Vertex arrays point straight into the mapping: UploadMesh reads them from there,
+    // and bounds queries keep reading them for the lifetime of the scene
+    model.meshCount = (int)header->meshCount;
+    model.meshes = (Mesh*)MemAlloc(sizeof(Mesh) * header->meshCount);
+    model.meshMaterial = (int*)MemAlloc(sizeof(int) * header->meshCount);
+    unsigned char* base = (unsigned char*)cacheFile.data;
+    for (int i = 0; i < model.meshCount; i++) {
+        const CachedMesh* cached = &Meshes()[i];
+        Mesh mesh = { 0 };
+        mesh.vertexCount = cached->vertexCount;
+        mesh.triangleCount = cached->triangleCount;
+        mesh.vertices = cached->vertices ? (float*)(base + cached->vertices) : NULL;
+        mesh.texcoords = cached->texcoords ? (float*)(base + cached->texcoords) : NULL;
+        mesh.normals = cached->normals ? (float*)(base + cached->normals) : NULL;
+        mesh.tangents = cached->tangents ? (float*)(base + cached->tangents) : NULL;
+        mesh.colors = cached->colors ? (unsigned char*)(base + cached->colors) : NULL;
+        mesh.indices = cached->indices ? (unsigned short*)(base + cached->indices) : NULL;
+        UploadMesh(&mesh, false);
+
+        model.meshes[i] = mesh;
+        model.meshMaterial[i] = cached->material;
+    }
+
+    return model;
+}
+
+TextureCubemap UploadSceneCacheSkybox() {
+    return LoadCompressedCubemap(cacheFile.data + header->skyboxOffset, (int)header->skyboxSize, (TextureCodec)header->skyboxCodec);
+}
+
+// Scene textures as they ended up on the GPU; materials share textures, so each id counts once
+static void MeasureSceneTextures() {
+    info.textureMemory = TextureMemory{ 0 };
+    std::vector<unsigned int> counted;
+    for (int i = 0; i < sponzaModel.materialCount; i++) {
+        const Texture2D maps[2] = { sponzaModel.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture, sponzaModel.materials[i].maps[MATERIAL_MAP_NORMAL].texture };
+        for (const Texture2D& texture : maps) {
+            if (texture.id == 0 || texture.id == rlGetTextureIdDefault()) continue;
+            bool seen = false;
+            for (unsigned int id : counted) seen = seen || (id == texture.id);
+            if (seen) continue;
+            counted.push_back(texture.id);
+            AddTextureMemory(&info.textureMemory, texture, 1);
+        }
+    }
+    AddTextureMemory(&info.textureMemory, skyTex, 6);
+    AddTextureMemory(&info.textureMemory, sunTex, 1);
+    info.decodedTextures = GetTextureDecodeFallbackCount();
+}
+
+void ReportSceneStartup() {
+    info.startupMs = GetTime() * 1000.0;
+    const char* source = info.used ? "scene cache" : (info.stale ? "source assets, stale cache" : "source assets");
+    TraceLog(LOG_INFO, "STARTUP: %s start, scene ready %.0f ms after window creation (%s)",
+             info.used ? "Warm" : "Cold", info.startupMs, source);
+
+    MeasureSceneTextures();
+    const TextureMemory* memory = &info.textureMemory;
+    TraceLog(LOG_INFO, "TEXTURES: %.1f MB on the GPU, %.1f MB as RGBA8 (%d of %d block-compressed, %d decoded on the CPU)",
+             (double)memory->gpuBytes / (1024.0 * 1024.0), (double)memory->uncompressedBytes / (1024.0 * 1024.0),
+             memory->compressed, memory->textures, info.decodedTextures);
+}
+
+const SceneCacheInfo* GetSceneCacheInfo() {
+    return &info;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "renderer.h"
+#include "texture_compression.h"
+
+// Cooked Sponza and skybox, written by raylib_cook and memory-mapped at startup
+#define SCENE_CACHE_PATH "resources/scene_cache.bin"
+#define SCENE_CACHE_VERSION 2
+#define SCENE_SOURCE_COUNT 8
+
+typedef struct {
+    bool used;          // this run's scene came from the cache (warm start)
+    bool stale;         // a cache exists but its version or a source file differs
+    size_t bytes;
+    double startupMs;   // window creation to scene ready
+    TextureMemory textureMemory;   // Sponza, skybox and sun textures once the scene is ready
+    int decodedTextures;           // compressed in the cache but decoded for a driver without the format
+} SceneCacheInfo;
+
+// sponza.glb, the skybox faces in cubemap order (+X, -X, +Y, -Y, +Z, -Z), then sun.jpg
+extern const char* sceneSourceFiles[SCENE_SOURCE_COUNT];
+
+// Offline: write the model's meshes, its textures with full mip chains, six skybox faces and the
+// sun texture; every texture is block-compressed (BC1/BC3 color, BC5 normals). Images are RGBA8.
+bool CookSceneCache(const char* path, Model model, const Image* skyFaces, Image sun);
+
+// Map the cache and check it against the sources; false means load the sources instead
+bool OpenSceneCache(const char* path);
+void CloseSceneCache(Model* model);   // before UnloadModel: the meshes point into the mapping
+
+// Page a part of the mapping in (loader threads), then create GL objects from it (main thread)
+int GetSceneCacheTextureCount();
+void PrefetchSceneCacheTexture(int index);
+void PrefetchSceneCacheGeometry();
+void PrefetchSceneCacheSkybox();
+void PrefetchSceneCacheSun();
+void UploadSceneCacheTexture(int index);
+Model UploadSceneCacheModel();   // after every texture upload
+TextureCubemap UploadSceneCacheSkybox();
+Texture2D UploadSceneCacheSun();   // owned by the caller
+
+// Log and record the time to a ready scene, labelled warm (cache) or cold (sources),
+// and the scene's texture memory against its RGBA8 equivalent
+void ReportSceneStartup();
+const SceneCacheInfo* GetSceneCacheInfo();
@@ -0,0 +1,329 @@
+#include "scene_culling.h"
+#include "render_queue.h"
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CULLING_SSE 1
+#endif
+
+bool enableFrustumCulling = true;
+
+// AABB as center/half-extent, the form the plane test wants
+typedef struct {
+    Vector3 center;
+    Vector3 extent;
+} CullBounds;
+
+// Leaves reference [first, first + count) of meshOrder; inner nodes have count 0 and children left, left + 1
+typedef struct {
+    CullBounds bounds;
+    int left;
+    int first;
+    int count;
+} BvhNode;
+
+// The six frustum planes in SoA form, padded to two groups of four (padding repeats plane 0)
+typedef struct {
+    alignas(16) float nx[8];
+    alignas(16) float ny[8];
+    alignas(16) float nz[8];
+    alignas(16) float d[8];
+} FrustumPlanes;
+
+typedef enum {
+    CULL_OUTSIDE = 0,
+    CULL_INTERSECTS,
+    CULL_INSIDE
+} CullResult;
+
+static std::vector<BvhNode> bvhNodes;
+static std::vector<int> meshOrder;
+static std::vector<CullBounds> meshBounds;
+static std::vector<int> meshTriangles;
+static int sceneTriangles = 0;
+
+static CullBounds BoundsFromBox(BoundingBox box) {
+    CullBounds bounds;
+    bounds.center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    bounds.extent = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+    return bounds;
+}
+
+// Mesh box in model space, re-fitted around its 8 transformed corners
+static BoundingBox TransformBox(BoundingBox box, Matrix transform) {
+    BoundingBox result = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+    for (int i = 0; i < 8; i++) {
+        Vector3 corner = {
+            (i & 1) ? box.max.x : box.min.x,
+            (i & 2) ? box.max.y : box.min.y,
+            (i & 4) ? box.max.z : box.min.z
+        };
+        corner = Vector3Transform(corner, transform);
+        result.min = Vector3Min(result.min, corner);
+        result.max = Vector3Max(result.max, corner);
+    }
+    return result;
+}
+
+static BoundingBox MergeBoxes(BoundingBox a, BoundingBox b) {
+    return BoundingBox{ Vector3Min(a.min, b.min), Vector3Max(a.max, b.max) };
+}
+
+// Fill node with meshOrder[first, first + count), median-splitting on the longest centroid axis
+static void BuildNode(const std::vector<BoundingBox>& boxes, int nodeIndex, int first, int count) {
+    BoundingBox box = boxes[meshOrder[first]];
+    BoundingBox centroids = { box.min, box.min };
+    for (int i = first; i < first + count; i++) {
+        BoundingBox meshBox = boxes[meshOrder[i]];
+        Vector3 centroid = Vector3Scale(Vector3Add(meshBox.min, meshBox.max), 0.5f);
+        box = MergeBoxes(box, meshBox);
+        centroids = MergeBoxes(centroids, BoundingBox{ centroid, centroid });
+    }
+    bvhNodes[nodeIndex].bounds = BoundsFromBox(box);
+
+    if (count <= BVH_LEAF_SIZE) {
+        bvhNodes[nodeIndex].first = first;
+        bvhNodes[nodeIndex].count = count;
+        return;
+    }
+
+    Vector3 size = Vector3Subtract(centroids.max, centroids.min);
+    int axis = (size.x > size.y && size.x > size.z) ? 0 : (size.y > size.z ? 1 : 2);
+    int half = count / 2;
+    std::nth_element(meshOrder.begin() + first, meshOrder.begin() + first + half, meshOrder.begin() + first + count,
+        [&](int a, int b) {
+            float ca = ((const float*)&boxes[a].min)[axis] + ((const float*)&boxes[a].max)[axis];
+            float cb = ((const float*)&boxes[b].min)[axis] + ((const float*)&boxes[b].max)[axis];
+            return ca < cb;
+        });
+
+    // Children are allocated back to back so only the left index is stored
+    int left = (int)bvhNodes.size();
+    bvhNodes.resize(bvhNodes.size() + 2);
+    bvhNodes[nodeIndex].left = left;
+    bvhNodes[nodeIndex].count = 0;
+    BuildNode(boxes, left, first, half);
+    BuildNode(boxes, left + 1, first + half, count - half);
+}
+
+// Compute per-mesh bounds in world space and build the BVH over them
+void BuildSceneBvh(Model model) {
+    UnloadSceneBvh();
+
+    std::vector<BoundingBox> boxes(model.meshCount);
+    meshBounds.resize(model.meshCount);
+    meshTriangles.resize(model.meshCount);
+    meshOrder.resize(model.meshCount);
+    for (int i = 0; i < model.meshCount; i++) {
+        boxes[i] = TransformBox(GetMeshBoundingBox(model.meshes[i]), model.transform);
+        meshBounds[i] = BoundsFromBox(boxes[i]);
+        meshTriangles[i] = model.meshes[i].triangleCount;
+        meshOrder[i] = i;
+        sceneTriangles += meshTriangles[i];
+    }
+
+    if (model.meshCount > 0) {
+        bvhNodes.reserve(2 * model.meshCount);
+        bvhNodes.resize(1);
+        BuildNode(boxes, 0, 0, model.meshCount);
+    }
+    TraceLog(LOG_INFO, "CULLING: BVH with %i nodes over %i meshes", (int)bvhNodes.size(), model.meshCount);
+}
+
+void UnloadSceneBvh() {
+    bvhNodes.clear();
+    meshOrder.clear();
+    meshBounds.clear();
+    meshTriangles.clear();
+    sceneTriangles = 0;
+}
+
+// Gribb-Hartmann plane extraction from the view-projection matrix, normals pointing inward
+static FrustumPlanes ExtractFrustum(Matrix viewProj) {
+    const Matrix& m = viewProj;
+    float planes[6][4] = {
+        { m.m3 + m.m0, m.m7 + m.m4, m.m11 + m.m8, m.m15 + m.m12 },   // left
+        { m.m3 - m.m0, m.m7 - m.m4, m.m11 - m.m8, m.m15 - m.m12 },   // right
+        { m.m3 + m.m1, m.m7 + m.m5, m.m11 + m.m9, m.m15 + m.m13 },   // bottom
+        { m.m3 - m.m1, m.m7 - m.m5, m.m11 - m.m9, m.m15 - m.m13 },   // top
+        { m.m3 + m.m2, m.m7 + m.m6, m.m11 + m.m10, m.m15 + m.m14 },  // near
+        { m.m3 - m.m2, m.m7 - m.m6, m.m11 - m.m10, m.m15 - m.m14 }   // far
+    };
+
+    FrustumPlanes frustum;
+    for (int i = 0; i < 8; i++) {
+        const float* plane = planes[i < 6 ? i : 0];
+        float invLength = 1.0f / sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        frustum.nx[i] = plane[0] * invLength;
+        frustum.ny[i] = plane[1] * invLength;
+        frustum.nz[i] = plane[2] * invLength;
+        frustum.d[i] = plane[3] * invLength;
+    }
+    return frustum;
+}
+
+// Signed distance of the box center against each plane vs. the box's projected radius
+static CullResult TestBounds(const FrustumPlanes* frustum, const CullBounds* bounds) {
+#ifdef CULLING_SSE
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 cx = _mm_set1_ps(bounds->center.x), cy = _mm_set1_ps(bounds->center.y), cz = _mm_set1_ps(bounds->center.z);
+    __m128 ex = _mm_set1_ps(bounds->extent.x), ey = _mm_set1_ps(bounds->extent.y), ez = _mm_set1_ps(bounds->extent.z);
+
+    int outside = 0;
+    int straddling = 0;
+    for (int group = 0; group < 8; group += 4) {
+        __m128 nx = _mm_load_ps(frustum->nx + group);
+        __m128 ny = _mm_load_ps(frustum->ny + group);
+        __m128 nz = _mm_load_ps(frustum->nz + group);
+        __m128 d = _mm_load_ps(frustum->d + group);
+
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), d));
+        __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex), _mm_mul_ps(_mm_and_ps(ny, absMask), ey)),
+                                   _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        straddling |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()));
+    }
+#else
+    int outside = 0;
+    int straddling = 0;
+    for (int i = 0; i < 6; i++) {
+        float distance = frustum->nx[i] * bounds->center.x + frustum->ny[i] * bounds->center.y + frustum->nz[i] * bounds->center.z + frustum->d[i];
+        float radius = fabsf(frustum->nx[i]) * bounds->extent.x + fabsf(frustum->ny[i]) * bounds->extent.y + fabsf(frustum->nz[i]) * bounds->extent.z;
+        if (distance + radius < 0.0f) outside = 1;
+        if (distance - radius < 0.0f) straddling = 1;
+    }
+#endif
+
+    if (outside) return CULL_OUTSIDE;
+    return straddling ? CULL_INTERSECTS : CULL_INSIDE;
+}
+
+static void AddVisibleMeshes(const BvhNode* node, VisibleMeshes* visible) {
+    for (int i = node->first; i < node->first + node->count; i++) {
+        int mesh = meshOrder[i];
+        visible->meshes.push_back(mesh);
+        visible->stats.trianglesVisible += meshTriangles[mesh];
+    }
+}
+
+// Walk the BVH against the camera frustum; subtrees fully inside skip further plane tests
+void CullScene(Camera3D camera, float aspect, VisibleMeshes* visible) {
+    double start = GetTime();
+
+    visible->meshes.clear();
+    visible->stats = CullStats{ 0 };
+    visible->stats.views = 1;
+    visible->stats.meshesTotal = (int)meshBounds.size();
+    visible->stats.trianglesTotal = sceneTriangles;
+
+    if (!enableFrustumCulling || bvhNodes.empty()) {
+        for (int i = 0; i < (int)meshBounds.size(); i++) visible->meshes.push_back(i);
+        visible->stats.meshesVisible = (int)meshBounds.size();
+        visible->stats.trianglesVisible = sceneTriangles;
+        return;
+    }
+
+    // Same projection BeginMode3D sets up for a perspective camera
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    FrustumPlanes frustum = ExtractFrustum(MatrixMultiply(view, projection));
+
+    // Stack entries carry whether the parent was already fully inside
+    int stack[64];
+    bool stackInside[64];
+    int stackSize = 0;
+    stack[stackSize] = 0;
+    stackInside[stackSize++] = false;
+
+    while (stackSize > 0) {
+        stackSize--;
+        const BvhNode* node = &bvhNodes[stack[stackSize]];
+        bool inside = stackInside[stackSize];
+        visible->stats.nodesVisited++;
+
+        if (!inside) {
+            CullResult result = TestBounds(&frustum, &node->bounds);
+            if (result == CULL_OUTSIDE) continue;
+            inside = (result == CULL_INSIDE);
+        }
+
+        if (node->count > 0) {
+            if (inside) {
+                AddVisibleMeshes(node, visible);
+            } else {
+                // Leaf straddles the frustum: test its meshes individually
+                for (int i = node->first; i < node->first + node->count; i++) {
+                    int mesh = meshOrder[i];
+                    if (TestBounds(&frustum, &meshBounds[mesh]) == CULL_OUTSIDE) continue;
+                    visible->meshes.push_back(mesh);
+                    visible->stats.trianglesVisible += meshTriangles[mesh];
+                }
+            }
+            continue;
+        }
+
+        if (stackSize + 2 > 64) continue;
+        stack[stackSize] = node->left + 1;
+        stackInside[stackSize++] = inside;
+        stack[stackSize] = node->left;
+        stackInside[stackSize++] = inside;
+    }
+
+    visible->stats.meshesVisible = (int)visible->meshes.size();
+    visible->stats.cullMs = (GetTime() - start) * 1000.0;
+}
+
+// Mark the lights whose range sphere touches the camera frustum; returns how many do
+int CullLightSpheres(Camera3D camera, float aspect, const Light* lights, int count, bool* visible) {
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    FrustumPlanes frustum = ExtractFrustum(MatrixMultiply(view, projection));
+
+    int visibleCount = 0;
+    for (int i = 0; i < count; i++) {
+        Vector3 center = lights[i].position;
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++) {
+            float distance = frustum.nx[p] * center.x + frustum.ny[p] * center.y + frustum.nz[p] * center.z + frustum.d[p];
+            inside = (distance >= -lights[i].range);
+        }
+        visible[i] = inside;
+        if (inside) visibleCount++;
+    }
+    return visibleCount;
+}
+
+// Draw only the surviving meshes (inside BeginMode3D) through the sorted render queue;
+// shaderOverride replaces every material's shader
+void DrawVisibleMeshes(Model model, const VisibleMeshes* visible, const Shader* shaderOverride) {
+    BeginRenderQueue(model, shaderOverride);
+    for (int i = 0; i < (int)visible->meshes.size(); i++) PushDrawItem(visible->meshes[i]);
+    FlushRenderQueue();
+}
+
+void AccumulateCullStats(CullStats* total, const CullStats* view) {
+    total->views += view->views;
+    total->meshesTotal += view->meshesTotal;
+    total->meshesVisible += view->meshesVisible;
+    total->trianglesTotal += view->trianglesTotal;
+    total->trianglesVisible += view->trianglesVisible;
+    total->nodesVisited += view->nodesVisited;
+    total->meshesOccluded += view->meshesOccluded;
+    total->trianglesOccluded += view->trianglesOccluded;
+    total->occluderTriangles += view->occluderTriangles;
+    total->cullMs += view->cullMs;
+    total->occlusionMs += view->occlusionMs;
+}
+
+BoundingBox GetMeshCullBox(int mesh) {
+    const CullBounds* bounds = &meshBounds[mesh];
+    return BoundingBox{ Vector3Subtract(bounds->center, bounds->extent), Vector3Add(bounds->center, bounds->extent) };
+}
+
+int GetMeshTriangleCount(int mesh) {
+    return meshTriangles[mesh];
+}
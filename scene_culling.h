@@ -0,0 +1,40 @@
+#pragma once
+
+#include "renderer.h"
+#include <vector>
+
+#define BVH_LEAF_SIZE 4   // meshes per leaf before a node is split
+
+// Submitted vs. total work for one or more culled views
+typedef struct {
+    int views;
+    int meshesTotal;
+    int meshesVisible;
+    int trianglesTotal;
+    int trianglesVisible;
+    int nodesVisited;
+    int meshesOccluded;       // frustum survivors hidden behind the occluders
+    int trianglesOccluded;
+    int occluderTriangles;    // front-facing occluder triangles rasterized
+    double cullMs;
+    double occlusionMs;
+} CullStats;
+
+// Mesh indices that survived culling for one camera
+typedef struct {
+    std::vector<int> meshes;
+    CullStats stats;
+} VisibleMeshes;
+
+extern bool enableFrustumCulling;
+
+void BuildSceneBvh(Model model);
+void UnloadSceneBvh();
+void CullScene(Camera3D camera, float aspect, VisibleMeshes* visible);
+int CullLightSpheres(Camera3D camera, float aspect, const Light* lights, int count, bool* visible);
+void DrawVisibleMeshes(Model model, const VisibleMeshes* visible, const Shader* shaderOverride);
+void AccumulateCullStats(CullStats* total, const CullStats* view);
+
+// World-space box and triangle count of one scene mesh, as the BVH sees them
+BoundingBox GetMeshCullBox(int mesh);
+int GetMeshTriangleCount(int mesh);
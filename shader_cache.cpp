@@ -0,0 +1,345 @@
+#include "shader_cache.h"
+#include "rlgl.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <vector>
+
+// On-disk program binary: this header, then the driver's blob
+typedef struct {
+    char magic[4];            // "SHBN"
+    uint32_t version;
+    uint64_t key;             // sources + driver, also the file name
+    uint32_t format;          // driver binary format enum
+    uint32_t length;
+} ProgramBinaryHeader;
+
+typedef struct {
+    Shader* shader;
+    std::string vsPath;       // empty = raylib's default stage
+    std::string fsPath;
+    std::string defines;
+    long vsTime;
+    long fsTime;
+    ShaderResolveFn resolve;
+    bool pending;             // the watcher read changed sources into vsCode/fsCode; guarded by watchMutex
+    std::string vsCode;
+    std::string fsCode;
+} WatchedShader;
+
+bool enableShaderHotReload = true;
+
+static WatchedShader watched[MAX_WATCHED_SHADERS];
+static int watchedCount = 0;
+static std::mutex watchMutex;
+static std::condition_variable watchWake;
+static std::thread watchThread;
+static bool watchStopping = false;
+
+static ShaderCacheStats stats = { 0 };
+static uint64_t driverKey = 0;   // vendor, renderer and version strings; 0 until first used
+
+// FNV-1a, 64-bit
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// The terminator keeps neighbouring fields from running together; NULL stands for raylib's default stage
+static uint64_t HashText(uint64_t hash, const char* text) {
+    if (text == NULL) text = "<default>";
+    return HashBytes(hash, text, strlen(text) + 1);
+}
+
+static void InitializeDriverKey() {
+    if (driverKey != 0) return;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    stats.binariesSupported = formats > 0;
+    if (stats.binariesSupported) {
+        MakeDirectory(SHADER_CACHE_DIR);
+    } else {
+        TraceLog(LOG_INFO, "SHADERS: The driver offers no program binary formats, compiling every start");
+    }
+
+    uint64_t hash = 14695981039346656037ull;
+    const GLenum strings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (int i = 0; i < 3; i++) hash = HashText(hash, (const char*)glGetString(strings[i]));
+    uint32_t version = SHADER_CACHE_VERSION;
+    driverKey = HashBytes(hash, &version, sizeof(version));
+}
+
+static void BinaryPath(uint64_t key, char* path, size_t size) {
+    snprintf(path, size, "%s/%016llx.bin", SHADER_CACHE_DIR, (unsigned long long)key);
+}
+
+// A linked program from the cache, or 0 when there is none or the driver rejects it
+static unsigned int LoadProgramBinary(uint64_t key) {
+    char path[256];
+    BinaryPath(key, path, sizeof(path));
+    if (!FileExists(path)) return 0;
+
+    int size = 0;
+    unsigned char* data = LoadFileData(path, &size);
+    ProgramBinaryHeader header;
+    bool valid = data != NULL && size >= (int)sizeof(header);
+    if (valid) {
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, "SHBN", 4) == 0 && header.version == SHADER_CACHE_VERSION && header.key == key &&
+                header.length == (uint32_t)(size - (int)sizeof(header));
+    }
+
+    unsigned int id = 0;
+    if (valid) {
+        id = glCreateProgram();
+        glProgramBinary(id, header.format, data + sizeof(header), (GLsizei)header.length);
+        GLint linked = GL_FALSE;
+        glGetProgramiv(id, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            TraceLog(LOG_INFO, "SHADERS: Driver rejected cached binary %s, recompiling", path);
+            glDeleteProgram(id);
+            id = 0;
+        }
+    }
+    UnloadFileData(data);
+    return id;
+}
+
+// Programs linked by raylib were not created with the retrievable hint; drivers that
+// still hand the binary out get it cached, the others simply report length 0
+static void SaveProgramBinary(unsigned int id, uint64_t key) {
+    GLint length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<unsigned char> file(sizeof(ProgramBinaryHeader) + length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(id, length, &written, &format, &file[sizeof(ProgramBinaryHeader)]);
+    if (written <= 0) return;
+
+    ProgramBinaryHeader header = { { 'S', 'H', 'B', 'N' }, SHADER_CACHE_VERSION, key, (uint32_t)format, (uint32_t)written };
+    memcpy(file.data(), &header, sizeof(header));
+
+    char path[256];
+    BinaryPath(key, path, sizeof(path));
+    SaveFileData(path, file.data(), (int)(sizeof(header) + written));
+}
+
+// The default locations LoadShader resolves, for a program restored from a binary
+static Shader ShaderFromProgram(unsigned int id) {
+    Shader shader = { 0 };
+    shader.id = id;
+    shader.locs = (int*)MemAlloc(RL_MAX_SHADER_LOCATIONS * sizeof(int));
+    for (int i = 0; i < RL_MAX_SHADER_LOCATIONS; i++) shader.locs[i] = -1;
+
+    shader.locs[SHADER_LOC_VERTEX_POSITION] = rlGetLocationAttrib(id, RL_DEFAULT_SHADER_ATTRIB_NAME_POSITION);
+    shader.locs[SHADER_LOC_VERTEX_TEXCOORD01] = rlGetLocationAttrib(id, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD);
+    shader.locs[SHADER_LOC_VERTEX_TEXCOORD02] = rlGetLocationAttrib(id, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD2);
+    shader.locs[SHADER_LOC_VERTEX_NORMAL] = rlGetLocationAttrib(id, RL_DEFAULT_SHADER_ATTRIB_NAME_NORMAL);
+    shader.locs[SHADER_LOC_VERTEX_TANGENT] = rlGetLocationAttrib(id, RL_DEFAULT_SHADER_ATTRIB_NAME_TANGENT);
+    shader.locs[SHADER_LOC_VERTEX_COLOR] = rlGetLocationAttrib(id, RL_DEFAULT_SHADER_ATTRIB_NAME_COLOR);
+
+    shader.locs[SHADER_LOC_MATRIX_MVP] = rlGetLocationUniform(id, RL_DEFAULT_SHADER_UNIFORM_NAME_MVP);
+    shader.locs[SHADER_LOC_MATRIX_VIEW] = rlGetLocationUniform(id, RL_DEFAULT_SHADER_UNIFORM_NAME_VIEW);
+    shader.locs[SHADER_LOC_MATRIX_PROJECTION] = rlGetLocationUniform(id, RL_DEFAULT_SHADER_UNIFORM_NAME_PROJECTION);
+    shader.locs[SHADER_LOC_MATRIX_MODEL] = rlGetLocationUniform(id, RL_DEFAULT_SHADER_UNIFORM_NAME_MODEL);
+    shader.locs[SHADER_LOC_MATRIX_NORMAL] = rlGetLocationUniform(id, RL_DEFAULT_SHADER_UNIFORM_NAME_NORMAL);
+
+    shader.locs[SHADER_LOC_COLOR_DIFFUSE] = rlGetLocationUniform(id, RL_DEFAULT_SHADER_UNIFORM_NAME_COLOR);
+    shader.locs[SHADER_LOC_MAP_DIFFUSE] = rlGetLocationUniform(id, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE0);
+    shader.locs[SHADER_LOC_MAP_SPECULAR] = rlGetLocationUniform(id, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE1);
+    shader.locs[SHADER_LOC_MAP_NORMAL] = rlGetLocationUniform(id, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE2);
+    return shader;
+}
+
+// Cached binary when one matches these sources on this driver, otherwise compile and cache it.
+// A failed compile returns raylib's default shader, like LoadShader.
+static Shader LoadProgram(const char* vsCode, const char* fsCode, bool* fromBinary) {
+    InitializeDriverKey();
+    uint64_t key = HashText(HashText(driverKey, vsCode), fsCode);
+
+    *fromBinary = false;
+    if (stats.binariesSupported) {
+        unsigned int id = LoadProgramBinary(key);
+        if (id != 0) {
+            *fromBinary = true;
+            return ShaderFromProgram(id);
+        }
+    }
+
+    Shader shader = LoadShaderFromMemory(vsCode, fsCode);
+    if (stats.binariesSupported && shader.id != rlGetShaderIdDefault()) SaveProgramBinary(shader.id, key);
+    return shader;
+}
+
+// Plain stdio, so the watcher thread never goes through raylib's file callbacks
+static bool ReadSource(const std::string& path, std::string* code) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == NULL) return false;
+
+    code->clear();
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) code->append(buffer, count);
+    fclose(file);
+    return !code->empty();
+}
+
+// Permutation defines must follow #version, which has to stay the first statement
+static void InjectDefines(std::string* code, const std::string& defines) {
+    if (defines.empty() || code->empty()) return;
+    size_t version = code->find("#version");
+    size_t lineEnd = (version == std::string::npos) ? std::string::npos : code->find('\n', version);
+    if (lineEnd == std::string::npos) {
+        code->insert(0, defines);
+    } else {
+        code->insert(lineEnd + 1, defines);
+    }
+}
+
+static const char* SourceOrDefault(const std::string& path, const std::string& code) {
+    return path.empty() ? NULL : code.c_str();
+}
+
+static const char* ShaderName(const WatchedShader* entry) {
+    return entry->fsPath.empty() ? entry->vsPath.c_str() : entry->fsPath.c_str();
+}
+
+void LoadWatchedShader(Shader* shader, const char* vsPath, const char* fsPath, ShaderResolveFn resolve, const char* defines) {
+    double startTime = GetTime();
+
+    std::string vs = vsPath ? vsPath : "";
+    std::string fs = fsPath ? fsPath : "";
+    std::string vsCode, fsCode;
+    if (!vs.empty() && !ReadSource(vs, &vsCode)) TraceLog(LOG_WARNING, "SHADERS: Failed to read %s", vsPath);
+    if (!fs.empty() && !ReadSource(fs, &fsCode)) TraceLog(LOG_WARNING, "SHADERS: Failed to read %s", fsPath);
+    std::string injected = defines ? defines : "";
+    InjectDefines(&vsCode, injected);
+    InjectDefines(&fsCode, injected);
+
+    bool fromBinary = false;
+    *shader = LoadProgram(SourceOrDefault(vs, vsCode), SourceOrDefault(fs, fsCode), &fromBinary);
+    if (resolve) resolve(0);
+
+    stats.programs++;
+    if (fromBinary) stats.binaryHits++;
+    stats.loadMs += (GetTime() - startTime) * 1000.0;
+
+    std::lock_guard<std::mutex> lock(watchMutex);
+    if (watchedCount >= MAX_WATCHED_SHADERS) {
+        TraceLog(LOG_WARNING, "SHADERS: More than %d programs, %s will not hot reload", MAX_WATCHED_SHADERS, fs.empty() ? vsPath : fsPath);
+        return;
+    }
+    WatchedShader* entry = &watched[watchedCount++];
+    entry->shader = shader;
+    entry->vsPath = vs;
+    entry->fsPath = fs;
+    entry->defines = injected;
+    entry->vsTime = vs.empty() ? 0 : GetFileModTime(vsPath);
+    entry->fsTime = fs.empty() ? 0 : GetFileModTime(fsPath);
+    entry->resolve = resolve;
+    entry->pending = false;
+}
+
+void UnloadWatchedShader(Shader* shader) {
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        for (int i = 0; i < watchedCount; i++) {
+            if (watched[i].shader != shader) continue;
+            watched[i] = watched[--watchedCount];
+            watched[watchedCount] = WatchedShader();
+            break;
+        }
+    }
+    UnloadShader(*shader);
+}
+
+static void WatcherMain() {
+    std::unique_lock<std::mutex> lock(watchMutex);
+    while (!watchStopping) {
+        watchWake.wait_for(lock, std::chrono::milliseconds(SHADER_WATCH_INTERVAL_MS), [] { return watchStopping; });
+        if (watchStopping || !enableShaderHotReload) continue;
+
+        for (int i = 0; i < watchedCount; i++) {
+            WatchedShader* entry = &watched[i];
+            long vsTime = entry->vsPath.empty() ? 0 : GetFileModTime(entry->vsPath.c_str());
+            long fsTime = entry->fsPath.empty() ? 0 : GetFileModTime(entry->fsPath.c_str());
+            if (vsTime == entry->vsTime && fsTime == entry->fsTime) continue;
+            entry->vsTime = vsTime;
+            entry->fsTime = fsTime;
+
+            // A file caught halfway through a save fails here or in the compile; the next save retries
+            if ((!entry->vsPath.empty() && !ReadSource(entry->vsPath, &entry->vsCode)) ||
+                (!entry->fsPath.empty() && !ReadSource(entry->fsPath, &entry->fsCode))) continue;
+            InjectDefines(&entry->vsCode, entry->defines);
+            InjectDefines(&entry->fsCode, entry->defines);
+            entry->pending = true;
+        }
+    }
+}
+
+void StartShaderHotReload() {
+    if (watchThread.joinable()) return;
+    watchStopping = false;
+    watchThread = std::thread(WatcherMain);
+}
+
+void StopShaderHotReload() {
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        watchStopping = true;
+    }
+    watchWake.notify_all();
+    if (watchThread.joinable()) watchThread.join();
+}
+
+void UpdateShaderHotReload() {
+    WatchedShader* entry = NULL;
+    std::string vsCode, fsCode;
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        for (int i = 0; i < watchedCount && entry == NULL; i++) {
+            if (!watched[i].pending) continue;
+            entry = &watched[i];
+            entry->pending = false;
+            vsCode.swap(entry->vsCode);
+            fsCode.swap(entry->fsCode);
+        }
+    }
+    if (entry == NULL) return;
+
+    // One program per frame; the running one stays bound until the new one has linked
+    double startTime = GetTime();
+    bool fromBinary = false;
+    Shader program = LoadProgram(SourceOrDefault(entry->vsPath, vsCode), SourceOrDefault(entry->fsPath, fsCode), &fromBinary);
+    if (program.id == rlGetShaderIdDefault()) {
+        stats.failedReloads++;
+        TraceLog(LOG_WARNING, "SHADERS: %s failed to build, keeping the running program", ShaderName(entry));
+        return;
+    }
+
+    Shader previous = *entry->shader;
+    *entry->shader = program;
+    if (entry->resolve) entry->resolve(previous.id);
+    UnloadShader(previous);
+
+    stats.reloads++;
+    stats.lastReloadMs = (GetTime() - startTime) * 1000.0;
+    TraceLog(LOG_INFO, "SHADERS: Reloaded %s in %.1f ms%s", ShaderName(entry), stats.lastReloadMs, fromBinary ? " (cached binary)" : "");
+}
+
+const ShaderCacheStats* GetShaderCacheStats() {
+    return &stats;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "raylib.h"
+#include <functional>
+
+// Linked program binaries, keyed by the shader sources and the driver, and source hot reload
+#define SHADER_CACHE_DIR "resources/shader_cache"
+#define SHADER_CACHE_VERSION 1
+#define SHADER_WATCH_INTERVAL_MS 250
+#define MAX_WATCHED_SHADERS 64
+
+typedef struct {
+    bool binariesSupported;   // the driver offers at least one program binary format
+    int programs;             // loaded through the cache at startup
+    int binaryHits;           // restored from a cached binary, no compile
+    double loadMs;            // startup time spent creating programs
+    int reloads;              // hot reloads swapped in
+    int failedReloads;        // reloads that did not compile or link; the old program stays
+    double lastReloadMs;
+} ShaderCacheStats;
+
+extern bool enableShaderHotReload;
+
+// Runs after a program is (re)created: resolve cached locations, set constant uniforms and
+// refresh copies of the Shader. previousId is 0 on the first load, else the replaced program.
+typedef std::function<void(unsigned int previousId)> ShaderResolveFn;
+
+// Load vs/fs (NULL = raylib's default stage) through the binary cache and keep *shader
+// current across hot reloads; *shader must outlive the watch (a global or file static).
+// defines ("#define X\n" lines) go right after each stage's #version line.
+void LoadWatchedShader(Shader* shader, const char* vsPath, const char* fsPath, ShaderResolveFn resolve = nullptr, const char* defines = NULL);
+void UnloadWatchedShader(Shader* shader);
+
+// A watcher thread polls the sources and reads changed ones; the main thread relinks one
+// program per UpdateShaderHotReload and swaps it in between frames
+void StartShaderHotReload();
+void StopShaderHotReload();
+void UpdateShaderHotReload();
+
+const ShaderCacheStats* GetShaderCacheStats();
@@ -0,0 +1,211 @@
+#include "shader_permutations.h"
+#include "shader_cache.h"
+#include "light_buffer.h"
+#include "draw_constants.h"
+#include "shadow_atlas.h"
+#include "light_clusters.h"
+#include "irradiance_grid.h"
+#include "bloom.h"
+#include "asset_loader.h"
+#include "rlgl.h"
+#include <stdio.h>
+
+// Light array size per bucket; the last one is the full LightBlock the base program declares.
+// All are capped to the driver's LightBlock capacity in BucketCapacity.
+static const int bucketCapacity[LIT_LIGHT_BUCKETS] = { 16, 64, 256, MAX_LIGHTS };
+
+typedef struct {
+    bool built;
+    bool failed;        // did not compile; materials fall back to the base program
+    int locEyePos;
+    int locAmb;
+    int locSpec;
+    int locShine;
+    int locBloomCutoff;
+} LitVariant;
+
+bool enableLitVariants = true;
+
+// Watched shaders keep a pointer to their Shader, so variants live in fixed slots
+static Shader variantShaders[LIT_FEATURE_COMBINATIONS][LIT_LIGHT_BUCKETS];
+static LitVariant variants[LIT_FEATURE_COMBINATIONS][LIT_LIGHT_BUCKETS];
+static LitVariantStats stats = { 0, 0, LIT_LIGHT_BUCKETS - 1, MAX_LIGHTS, 0.0 };
+
+static int assignedBucket = -1;
+static bool assignedSpecular = false;
+static bool assignedEnabled = false;
+
+static int BucketCapacity(int bucket) {
+    int capacity = GetLightCapacity();
+    return bucketCapacity[bucket] < capacity ? bucketCapacity[bucket] : capacity;
+}
+
+int GetLightBucket(int count) {
+    for (int bucket = 0; bucket < LIT_LIGHT_BUCKETS - 1; bucket++) {
+        if (count <= BucketCapacity(bucket)) return bucket;
+    }
+    return LIT_LIGHT_BUCKETS - 1;
+}
+
+int GetLightBucketCapacity(int bucket) {
+    return BucketCapacity(bucket);
+}
+
+std::string GetLitVariantDefines(int features, int bucket) {
+    std::string defines;
+    if (features & LIT_NORMAL_MAP) defines += "#define HAS_NORMAL_MAP\n";
+    if (features & LIT_SRGB_DIFFUSE) defines += "#define SRGB_DIFFUSE\n";
+    if (features & LIT_SPECULAR) defines += "#define SPECULAR\n";
+    char capacity[48];
+    snprintf(capacity, sizeof(capacity), "#define LIGHT_CAPACITY %d\n", BucketCapacity(bucket));
+    return defines + capacity;
+}
+
+static bool IsBaseVariant(int features, int bucket) {
+    return features == LIT_ALL_FEATURES && bucket == LIT_LIGHT_BUCKETS - 1;
+}
+
+static void BuildVariant(int features, int bucket) {
+    Shader* shader = &variantShaders[features][bucket];
+    LitVariant* variant = &variants[features][bucket];
+    double startTime = GetTime();
+
+    std::string defines = GetLitVariantDefines(features, bucket);
+    LoadWatchedShader(shader, "resources/shaders/default.vs", "resources/shaders/phong.fs", [shader, variant](unsigned int previousId) {
+        if (shader->id == rlGetShaderIdDefault()) return;
+        variant->locEyePos = GetShaderLocation(*shader, "u_eyePos");
+        variant->locAmb = GetShaderLocation(*shader, "u_ambientColor");
+        variant->locSpec = GetShaderLocation(*shader, "u_specularColor");
+        variant->locShine = GetShaderLocation(*shader, "u_shininess");
+        variant->locBloomCutoff = GetShaderLocation(*shader, "u_bloomCutoff");
+        shader->locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(*shader, "diffuseMap");
+        shader->locs[SHADER_LOC_MAP_NORMAL] = GetShaderLocation(*shader, "normalMap");
+        BindLightBuffer(*shader);
+        BindDrawConstants(*shader);
+        BindShadowAtlas(*shader);
+        BindLightClusters(*shader, previousId);
+        BindIrradianceGrid(*shader, previousId);
+        for (int i = 0; i < sponzaModel.materialCount && previousId != 0; i++) {
+            if (sponzaModel.materials[i].shader.id == previousId) sponzaModel.materials[i].shader = *shader;
+        }
+    }, defines.c_str());
+
+    variant->built = true;
+    if (shader->id == rlGetShaderIdDefault()) {
+        variant->failed = true;
+        UnloadWatchedShader(shader);
+        TraceLog(LOG_WARNING, "SHADERS: Lit variant %d/%d failed to build, using the base program", features, bucket);
+        return;
+    }
+
+    double ms = (GetTime() - startTime) * 1000.0;
+    stats.compiled++;
+    stats.compileMs += ms;
+    TraceLog(LOG_INFO, "SHADERS: Built lit variant features %d, %d lights in %.1f ms", features, BucketCapacity(bucket), ms);
+}
+
+static Shader GetLitVariant(int features, int bucket) {
+    if (IsBaseVariant(features, bucket)) return sh;
+    LitVariant* variant = &variants[features][bucket];
+    if (!variant->built) BuildVariant(features, bucket);
+    return variant->failed ? sh : variantShaders[features][bucket];
+}
+
+static bool IsRealTexture(Texture2D texture) {
+    return texture.id != 0 && texture.id != rlGetTextureIdDefault();
+}
+
+static bool IsSpecularActive() {
+    return (specularColor.x > 0.0f || specularColor.y > 0.0f || specularColor.z > 0.0f) && shininess > 0.0f;
+}
+
+// The features a material needs; an unneeded one only costs work, so the full set is always safe
+static int GetMaterialFeatures(const Material* material) {
+    int features = 0;
+    if (IsRealTexture(material->maps[MATERIAL_MAP_NORMAL].texture)) features |= LIT_NORMAL_MAP;
+    if (IsRealTexture(material->maps[MATERIAL_MAP_DIFFUSE].texture)) features |= LIT_SRGB_DIFFUSE;
+    if (IsSpecularActive()) features |= LIT_SPECULAR;
+    return features;
+}
+
+void AssignLitVariants(Model* model) {
+    assignedBucket = GetLightBucket(lightCount);
+    assignedSpecular = IsSpecularActive();
+    assignedEnabled = enableLitVariants;
+
+    unsigned int used[LIT_FEATURE_COMBINATIONS * LIT_LIGHT_BUCKETS];
+    int usedCount = 0;
+    for (int i = 0; i < model->materialCount; i++) {
+        Shader shader = sh;
+        if (enableLitVariants) shader = GetLitVariant(GetMaterialFeatures(&model->materials[i]), assignedBucket);
+        model->materials[i].shader = shader;
+
+        bool seen = false;
+        for (int j = 0; j < usedCount; j++) seen = seen || used[j] == shader.id;
+        if (!seen) used[usedCount++] = shader.id;
+    }
+
+    stats.inUse = usedCount;
+    stats.bucket = enableLitVariants ? assignedBucket : LIT_LIGHT_BUCKETS - 1;
+    stats.capacity = BucketCapacity(stats.bucket);
+}
+
+void QueueLitVariantBuilds(const Model* model) {
+    // Specular and the light bucket change at runtime; the texture features are fixed per material
+    bool reachable[LIT_FEATURE_COMBINATIONS] = { false };
+    for (int i = 0; i < model->materialCount; i++) {
+        int features = GetMaterialFeatures(&model->materials[i]) & ~LIT_SPECULAR;
+        reachable[features] = reachable[features | LIT_SPECULAR] = true;
+    }
+
+    for (int features = 0; features < LIT_FEATURE_COMBINATIONS; features++) {
+        for (int bucket = 0; bucket < LIT_LIGHT_BUCKETS && reachable[features]; bucket++) {
+            if (IsBaseVariant(features, bucket) || variants[features][bucket].built) continue;
+            char name[ASSET_NAME_LENGTH];
+            snprintf(name, sizeof(name), "lit variant %d/%d", features, bucket);
+            QueueAsset(name, nullptr, [features, bucket] {
+                if (!variants[features][bucket].built) BuildVariant(features, bucket);
+            });
+        }
+    }
+}
+
+void UpdateLitVariants(Model* model) {
+    if (model->materialCount == 0) return;
+    if (GetLightBucket(lightCount) != assignedBucket || IsSpecularActive() != assignedSpecular || enableLitVariants != assignedEnabled) {
+        AssignLitVariants(model);
+    }
+
+    // The base program's uniforms are set by UpdateShaderUniforms
+    float bloomCutoff = GetBloomCutoff();
+    for (int features = 0; features < LIT_FEATURE_COMBINATIONS; features++) {
+        for (int bucket = 0; bucket < LIT_LIGHT_BUCKETS; bucket++) {
+            const LitVariant* variant = &variants[features][bucket];
+            if (!variant->built || variant->failed) continue;
+            Shader shader = variantShaders[features][bucket];
+            SetShaderValue(shader, variant->locEyePos, &cam.position, SHADER_UNIFORM_VEC3);
+            SetShaderValue(shader, variant->locAmb, &ambientColor, SHADER_UNIFORM_VEC3);
+            SetShaderValue(shader, variant->locSpec, &specularColor, SHADER_UNIFORM_VEC3);
+            SetShaderValue(shader, variant->locShine, &shininess, SHADER_UNIFORM_FLOAT);
+            SetShaderValue(shader, variant->locBloomCutoff, &bloomCutoff, SHADER_UNIFORM_FLOAT);
+        }
+    }
+}
+
+void UnloadLitVariants() {
+    for (int features = 0; features < LIT_FEATURE_COMBINATIONS; features++) {
+        for (int bucket = 0; bucket < LIT_LIGHT_BUCKETS; bucket++) {
+            LitVariant* variant = &variants[features][bucket];
+            if (variant->built && !variant->failed) UnloadWatchedShader(&variantShaders[features][bucket]);
+            *variant = LitVariant();
+        }
+    }
+    stats.compiled = 0;
+    stats.inUse = 0;
+    stats.compileMs = 0.0;
+    assignedBucket = -1;
+}
+
+const LitVariantStats* GetLitVariantStats() {
+    return &stats;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "renderer.h"
+#include <string>
+
+// Feature bits of the lit (phong) shader; every combination and light bucket is its own program
+typedef enum {
+    LIT_NORMAL_MAP   = 1 << 0,   // HAS_NORMAL_MAP: the material has a normal map
+    LIT_SRGB_DIFFUSE = 1 << 1,   // SRGB_DIFFUSE: the material has a diffuse texture to sample and decode
+    LIT_SPECULAR     = 1 << 2    // SPECULAR: the specular color is not black
+} LitFeature;
+
+#define LIT_ALL_FEATURES (LIT_NORMAL_MAP | LIT_SRGB_DIFFUSE | LIT_SPECULAR)
+#define LIT_FEATURE_COMBINATIONS 8
+#define LIT_LIGHT_BUCKETS 4      // light array sizes 16, 64, 256 and MAX_LIGHTS
+
+typedef struct {
+    int compiled;       // variants built so far (the base program not included)
+    int inUse;          // distinct programs on Sponza's materials
+    int bucket;
+    int capacity;       // light array size of the current bucket
+    double compileMs;   // time spent building variants
+} LitVariantStats;
+
+extern bool enableLitVariants;   // off: every material gets the base program, sh
+
+int GetLightBucket(int count);
+int GetLightBucketCapacity(int bucket);
+
+// "#define" lines for a variant; the base program sh is LIT_ALL_FEATURES in the last bucket
+std::string GetLitVariantDefines(int features, int bucket);
+
+void UnloadLitVariants();
+
+// Give each material the cheapest variant that covers it, building variants on first use
+void AssignLitVariants(Model* model);
+
+// Queue a loading upload for every other variant the model's materials can reach (any light
+// bucket, specular on or off), so none is compiled mid-frame once loading is done
+void QueueLitVariantBuilds(const Model* model);
+
+// Per frame: reassign when the light bucket or the specular switch changes, then set the
+// per-frame uniforms of every built variant
+void UpdateLitVariants(Model* model);
+
+const LitVariantStats* GetLitVariantStats();
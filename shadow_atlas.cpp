@@ -0,0 +1,314 @@
+#include "shadow_atlas.h"
+#include "scene_culling.h"
+#include "light_probe.h"
+#include "draw_constants.h"
+#include "shader_cache.h"
+#include "external/glad.h"
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#define SHADOW_ALL_FACES 0x3F
+
+typedef struct {
+    int light;                 // index into lights[], -1 while free
+    Vector3 position;          // light state the valid faces were rendered for
+    float range;
+    unsigned int validFaces;   // bit per cube face, up to date with the light
+    unsigned int filledFaces;  // bit per cube face holding any depth, stale or not
+    bool ready;                // every face filled; only then do the shaders see it
+    int staleFrames;           // frames spent waiting for faces, raises the slot's claim on the budget
+} ShadowSlot;
+
+// std140 ShadowBlock; matrices are row_major so raylib's Matrix uploads as is
+typedef struct {
+    Matrix faces[MAX_SHADOW_LIGHTS * 6];    // world -> cube face clip space
+    Vector4 rects[MAX_SHADOW_LIGHTS * 6];   // face tile in the atlas: uv offset, uv scale
+    int slots[MAX_LIGHTS];                  // slot + 1 per light, 0 = unshadowed (ivec4-packed)
+} ShadowBlockData;
+
+static_assert(sizeof(ShadowBlockData) == MAX_SHADOW_LIGHTS * 6 * 80 + MAX_LIGHTS * 4, "ShadowBlock must match its std140 layout");
+
+bool enableShadows = true;
+int shadowFaceBudget = DEFAULT_SHADOW_FACE_BUDGET;
+
+static GLuint atlasTexture = 0;
+static GLuint atlasFbo = 0;
+static GLuint shadowUbo = 0;
+static Shader shShadowDepth;
+static ShadowSlot slots[MAX_SHADOW_LIGHTS];
+static ShadowBlockData block;
+static bool blockDirty = true;
+static ShadowAtlasStats stats = { 0 };
+
+static VisibleMeshes faceVisible;
+static bool lightOnScreen[MAX_LIGHTS];
+static int lightSlot[MAX_LIGHTS];
+static std::vector<std::pair<float, int>> rankedLights;
+
+// Lower-left pixel of a face's tile; a slot is three faces across and two up
+static void GetFaceTile(int slot, int face, int* x, int* y) {
+    *x = ((slot % SHADOW_SLOT_COLUMNS) * 3 + face % 3) * SHADOW_FACE_SIZE;
+    *y = ((slot / SHADOW_SLOT_COLUMNS) * 2 + face / 3) * SHADOW_FACE_SIZE;
+}
+
+static void FreeSlot(int slot) {
+    slots[slot].light = -1;
+    slots[slot].validFaces = 0;
+    slots[slot].filledFaces = 0;
+    slots[slot].ready = false;
+    slots[slot].staleFrames = 0;
+    blockDirty = true;
+}
+
+void InitializeShadowAtlas() {
+    LoadWatchedShader(&shShadowDepth, "resources/shaders/depth.vs", "resources/shaders/depth.fs", [](unsigned int) {
+        BindDrawConstants(shShadowDepth);
+    });
+
+    // Hardware depth compare: a linear lookup is a 2x2 PCF tap
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, SHADOW_ATLAS_WIDTH, SHADOW_ATLAS_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &atlasFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, atlasFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, atlasTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        TraceLog(LOG_WARNING, "SHADOWS: Atlas framebuffer is incomplete");
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    memset(&block, 0, sizeof(block));
+    for (int slot = 0; slot < MAX_SHADOW_LIGHTS; slot++) {
+        FreeSlot(slot);
+        for (int face = 0; face < 6; face++) {
+            int x, y;
+            GetFaceTile(slot, face, &x, &y);
+            block.rects[slot * 6 + face] = Vector4{ (float)x / SHADOW_ATLAS_WIDTH, (float)y / SHADOW_ATLAS_HEIGHT,
+                                                    (float)SHADOW_FACE_SIZE / SHADOW_ATLAS_WIDTH, (float)SHADOW_FACE_SIZE / SHADOW_ATLAS_HEIGHT };
+        }
+    }
+
+    glGenBuffers(1, &shadowUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, shadowUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(ShadowBlockData), &block, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, SHADOW_BLOCK_BINDING, shadowUbo);
+    blockDirty = false;
+
+    glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    stats = ShadowAtlasStats{ 0 };
+    TraceLog(LOG_INFO, "SHADOWS: %ix%i atlas, %i lights of six %ipx faces", SHADOW_ATLAS_WIDTH, SHADOW_ATLAS_HEIGHT, MAX_SHADOW_LIGHTS, SHADOW_FACE_SIZE);
+}
+
+void UnloadShadowAtlas() {
+    UnloadWatchedShader(&shShadowDepth);
+    glDeleteFramebuffers(1, &atlasFbo);
+    glDeleteTextures(1, &atlasTexture);
+    glDeleteBuffers(1, &shadowUbo);
+    atlasFbo = atlasTexture = shadowUbo = 0;
+}
+
+void BindShadowAtlas(Shader shader) {
+    GLuint blockIndex = glGetUniformBlockIndex(shader.id, "ShadowBlock");
+    if (blockIndex == GL_INVALID_INDEX) {
+        TraceLog(LOG_WARNING, "SHADOWS: [SHDR ID %i] ShadowBlock not found", shader.id);
+        return;
+    }
+    glUniformBlockBinding(shader.id, blockIndex, SHADOW_BLOCK_BINDING);
+    int unit = SHADOW_TEXTURE_UNIT;
+    SetShaderValue(shader, GetShaderLocation(shader, "u_shadowAtlas"), &unit, SHADER_UNIFORM_INT);
+}
+
+// Roughly the share of the screen the light can reach, weighted by how bright it is
+static float GetScreenContribution(const Light* light, Vector3 eye) {
+    float distance = Vector3Distance(light->position, eye);
+    float extent = light->range / fmaxf(distance, light->range);   // 1 once the camera is inside the sphere
+    float brightness = fmaxf(light->color.x, fmaxf(light->color.y, light->color.z)) * light->intensity;
+    return extent * extent * brightness;
+}
+
+// Depth-only Sponza from the light through one cube face, into that face's tile
+static void RenderShadowFace(int slot, int face) {
+    const Light* light = &lights[slots[slot].light];
+    Camera3D faceCamera = GetProbeFaceCamera(light->position, face);
+    Matrix view = MatrixLookAt(faceCamera.position, faceCamera.target, faceCamera.up);
+    Matrix projection = MatrixPerspective(90.0 * DEG2RAD, 1.0, SHADOW_NEAR, fmaxf(light->range, SHADOW_NEAR * 2.0f));
+    block.faces[slot * 6 + face] = MatrixMultiply(view, projection);
+
+    int x, y;
+    GetFaceTile(slot, face, &x, &y);
+    glViewport(x, y, SHADOW_FACE_SIZE, SHADOW_FACE_SIZE);
+    glScissor(x, y, SHADOW_FACE_SIZE, SHADOW_FACE_SIZE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    CullScene(faceCamera, 1.0f, &faceVisible);
+
+    rlMatrixMode(RL_PROJECTION);
+    rlPushMatrix();
+    rlLoadIdentity();
+    rlMultMatrixf(MatrixToFloat(projection));
+    rlMatrixMode(RL_MODELVIEW);
+    rlLoadIdentity();
+    rlMultMatrixf(MatrixToFloat(view));
+
+    DrawVisibleMeshes(sponzaModel, &faceVisible, &shShadowDepth);
+
+    rlMatrixMode(RL_PROJECTION);
+    rlPopMatrix();
+    rlMatrixMode(RL_MODELVIEW);
+    rlLoadIdentity();
+}
+
+static void UploadShadowBlock() {
+    if (!blockDirty) return;
+    memset(block.slots, 0, sizeof(block.slots));
+    for (int slot = 0; slot < MAX_SHADOW_LIGHTS; slot++) {
+        if (slots[slot].ready) block.slots[slots[slot].light] = slot + 1;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, shadowUbo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ShadowBlockData), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    blockDirty = false;
+}
+
+void UpdateShadowAtlas(Camera3D camera, float aspect) {
+    double startTime = GetTime();
+    stats.candidates = 0;
+    stats.offscreenLights = 0;
+    stats.shadowedLights = 0;
+    stats.facesRendered = 0;
+    stats.facesPending = 0;
+    stats.facesCached = 0;
+
+    if (!enableShadows || sponzaModel.meshCount == 0) {
+        for (int slot = 0; slot < MAX_SHADOW_LIGHTS; slot++) {
+            if (slots[slot].light >= 0) FreeSlot(slot);
+        }
+        UploadShadowBlock();
+        stats.updateMs = (GetTime() - startTime) * 1000.0;
+        return;
+    }
+
+    // Lights whose range sphere misses the view cannot shadow anything on screen
+    int onScreen = CullLightSpheres(camera, aspect, lights, lightCount, lightOnScreen);
+    stats.offscreenLights = lightCount - onScreen;
+    rankedLights.clear();
+    for (int i = 0; i < lightCount; i++) {
+        if (!lightOnScreen[i] || lights[i].intensity <= 0.0f) continue;
+        rankedLights.push_back({ GetScreenContribution(&lights[i], camera.position), i });
+    }
+    stats.candidates = (int)rankedLights.size();
+    int chosen = std::min((int)rankedLights.size(), MAX_SHADOW_LIGHTS);
+    std::partial_sort(rankedLights.begin(), rankedLights.begin() + chosen, rankedLights.end(),
+                      [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+
+    // Lights that stay chosen keep their slot and cached faces; the rest give theirs up
+    for (int i = 0; i < lightCount; i++) lightSlot[i] = -1;
+    for (int slot = 0; slot < MAX_SHADOW_LIGHTS; slot++) {
+        if (slots[slot].light >= 0 && slots[slot].light < lightCount) lightSlot[slots[slot].light] = slot;
+    }
+    bool keep[MAX_SHADOW_LIGHTS] = { false };
+    for (int k = 0; k < chosen; k++) {
+        int slot = lightSlot[rankedLights[k].second];
+        if (slot >= 0) keep[slot] = true;
+    }
+    for (int slot = 0; slot < MAX_SHADOW_LIGHTS; slot++) {
+        if (slots[slot].light >= 0 && !keep[slot]) FreeSlot(slot);
+    }
+
+    int order[MAX_SHADOW_LIGHTS];
+    float claim[MAX_SHADOW_LIGHTS];
+    for (int k = 0; k < chosen; k++) {
+        int light = rankedLights[k].second;
+        int slot = lightSlot[light];   // a chosen light's slot was kept above
+        if (slot < 0) {
+            for (slot = 0; slots[slot].light >= 0; slot++) {}
+            slots[slot].light = light;
+            slots[slot].position = lights[light].position;
+            slots[slot].range = lights[light].range;
+        }
+
+        // A moved light re-renders every face; until then the old faces keep their own matrices
+        if (!Vector3Equals(slots[slot].position, lights[light].position) || slots[slot].range != lights[light].range) {
+            slots[slot].position = lights[light].position;
+            slots[slot].range = lights[light].range;
+            slots[slot].validFaces = 0;
+        }
+        order[k] = slot;
+        claim[slot] = rankedLights[k].first * (float)(1 + slots[slot].staleFrames);
+    }
+
+    // Spend the face budget on the largest contributions first; waiting slots gain weight
+    // every frame so lights that keep moving cannot starve the rest
+    std::sort(order, order + chosen, [&claim](int a, int b) { return claim[a] > claim[b]; });
+    int budget = shadowFaceBudget;
+    bool rendering = false;
+    for (int k = 0; k < chosen; k++) {
+        ShadowSlot* slot = &slots[order[k]];
+        for (int face = 0; face < 6; face++) {
+            unsigned int bit = 1u << face;
+            if (slot->validFaces & bit) {
+                stats.facesCached++;
+                continue;
+            }
+            if (budget <= 0) {
+                stats.facesPending++;
+                continue;
+            }
+
+            if (!rendering) {
+                rlDrawRenderBatchActive();
+                glBindFramebuffer(GL_FRAMEBUFFER, atlasFbo);
+                glEnable(GL_SCISSOR_TEST);
+                glEnable(GL_POLYGON_OFFSET_FILL);
+                glPolygonOffset(1.5f, 4.0f);
+                rlEnableDepthTest();
+                rlEnableDepthMask();
+                rendering = true;
+            }
+            RenderShadowFace(order[k], face);
+            slot->validFaces |= bit;
+            slot->filledFaces |= bit;
+            budget--;
+            stats.facesRendered++;
+            blockDirty = true;
+        }
+
+        slot->staleFrames = (slot->validFaces == SHADOW_ALL_FACES) ? 0 : slot->staleFrames + 1;
+        if (slot->filledFaces == SHADOW_ALL_FACES && !slot->ready) {
+            slot->ready = true;
+            blockDirty = true;
+        }
+        if (slot->ready) stats.shadowedLights++;
+    }
+
+    if (rendering) {
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glDisable(GL_SCISSOR_TEST);
+        rlDisableDepthTest();
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, rlGetFramebufferWidth(), rlGetFramebufferHeight());
+    }
+
+    UploadShadowBlock();
+    stats.facesRenderedTotal += stats.facesRendered;
+    stats.updateMs = (GetTime() - startTime) * 1000.0;
+}
+
+const ShadowAtlasStats* GetShadowAtlasStats() {
+    return &stats;
+}
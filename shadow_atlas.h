@@ -0,0 +1,40 @@
+#pragma once
+
+#include "renderer.h"
+
+// Omni shadows: each shadowed light owns a 3x2 block of cube faces in one shared depth atlas.
+// Faces only hold Sponza, so they stay valid until the light moves or changes range.
+#define SHADOW_FACE_SIZE 256
+#define MAX_SHADOW_LIGHTS 16         // must match MAX_SHADOW_LIGHTS in phong.fs and deferred_light.fs
+#define SHADOW_SLOT_COLUMNS 4
+#define SHADOW_ATLAS_WIDTH (SHADOW_FACE_SIZE * 3 * SHADOW_SLOT_COLUMNS)
+#define SHADOW_ATLAS_HEIGHT (SHADOW_FACE_SIZE * 2 * (MAX_SHADOW_LIGHTS / SHADOW_SLOT_COLUMNS))
+#define SHADOW_NEAR 0.05f
+#define SHADOW_TEXTURE_UNIT 12       // next to the irradiance grid and cluster units
+#define SHADOW_BLOCK_BINDING 2       // uniform buffer binding point of ShadowBlock
+#define DEFAULT_SHADOW_FACE_BUDGET 12
+
+typedef struct {
+    int candidates;         // lights whose range sphere is on screen
+    int offscreenLights;    // skipped, range sphere outside the camera frustum
+    int shadowedLights;     // lights with all six faces in the atlas
+    int facesRendered;      // this frame
+    int facesPending;       // stale or missing faces left for later frames
+    int facesCached;        // valid faces reused this frame
+    long long facesRenderedTotal;
+    double updateMs;
+} ShadowAtlasStats;
+
+extern bool enableShadows;
+extern int shadowFaceBudget;   // cube faces re-rendered per frame at most
+
+void InitializeShadowAtlas();
+void UnloadShadowAtlas();
+
+// Point a lit shader's ShadowBlock and atlas sampler at the shared resources
+void BindShadowAtlas(Shader shader);
+
+// Pick this frame's shadowed lights by screen contribution and re-render stale faces within the budget
+void UpdateShadowAtlas(Camera3D camera, float aspect);
+
+const ShadowAtlasStats* GetShadowAtlasStats();
@@ -0,0 +1,460 @@
+#include "texture_compression.h"
+#include "job_system.h"
+#include "rlgl.h"
+#include "external/glad.h"
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#define BLOCK_ROWS_PER_JOB 2
+
+static int supportS3TC = -1;   // unknown until the first query, which needs a GL context
+static int decodeFallbacks = 0;
+
+static int BlockBytes(TextureCodec codec) {
+    return (codec == TEXTURE_CODEC_BC1) ? 8 : 16;
+}
+
+size_t GetCompressedLevelSize(TextureCodec codec, int width, int height) {
+    if (codec == TEXTURE_CODEC_NONE) return (size_t)width * height * 4;
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * BlockBytes(codec);
+}
+
+size_t GetCompressedChainSize(TextureCodec codec, int width, int height, int mipmaps) {
+    size_t size = 0;
+    for (int level = 0; level < mipmaps; level++) {
+        size += GetCompressedLevelSize(codec, width, height);
+        width = (width > 1) ? width / 2 : 1;
+        height = (height > 1) ? height / 2 : 1;
+    }
+    return size;
+}
+
+// 5:6:5 endpoints, rounded on the way in and bit-replicated back to 8 bits on the way out
+static uint16_t Pack565(const float* color) {
+    int r = (int)(fminf(fmaxf(color[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+    int g = (int)(fminf(fmaxf(color[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+    int b = (int)(fminf(fmaxf(color[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void Unpack565(uint16_t packed, float* color) {
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (float)((r << 3) | (r >> 2));
+    color[1] = (float)((g << 2) | (g >> 4));
+    color[2] = (float)((b << 3) | (b >> 2));
+}
+
+// Nearest of the four palette entries per pixel; returns the block's squared error
+static float FitColorIndices(const float pixels[16][3], uint16_t c0, uint16_t c1, unsigned char* indices) {
+    float palette[4][3];
+    Unpack565(c0, palette[0]);
+    Unpack565(c1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+        palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+
+    float error = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float best = 1e30f;
+        for (int p = 0; p < 4; p++) {
+            float dr = pixels[i][0] - palette[p][0], dg = pixels[i][1] - palette[p][1], db = pixels[i][2] - palette[p][2];
+            float d = dr * dr + dg * dg + db * db;
+            if (d < best) {
+                best = d;
+                indices[i] = (unsigned char)p;
+            }
+        }
+        error += best;
+    }
+    return error;
+}
+
+// Least-squares endpoints for fixed indices; false when every pixel picked the same weight
+static bool RefitColorEndpoints(const float pixels[16][3], const unsigned char* indices, float* e0, float* e1) {
+    static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f, ax[3] = { 0 }, bx[3] = { 0 };
+    for (int i = 0; i < 16; i++) {
+        float a = weights[indices[i]], b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int c = 0; c < 3; c++) {
+            ax[c] += a * pixels[i][c];
+            bx[c] += b * pixels[i][c];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (fabsf(det) < 1e-6f) return false;
+    for (int c = 0; c < 3; c++) {
+        e0[c] = (bb * ax[c] - ab * bx[c]) / det;
+        e1[c] = (aa * bx[c] - ab * ax[c]) / det;
+    }
+    return true;
+}
+
+// BC1 in four-color mode: endpoints on the principal axis of the block's colors, one least-squares refit
+static void EncodeColorBlock(const unsigned char* block, unsigned char* out) {
+    float pixels[16][3], mean[3] = { 0 };
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            pixels[i][c] = (float)block[i * 4 + c];
+            mean[c] += pixels[i][c] / 16.0f;
+        }
+    }
+
+    float cov[6] = { 0 };
+    for (int i = 0; i < 16; i++) {
+        float r = pixels[i][0] - mean[0], g = pixels[i][1] - mean[1], b = pixels[i][2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+
+    // Start from the covariance row of the widest channel; a few power iterations are plenty for 3x3
+    const float rows[3][3] = { { cov[0], cov[1], cov[2] }, { cov[1], cov[3], cov[4] }, { cov[2], cov[4], cov[5] } };
+    int widest = (cov[3] > cov[0]) ? 1 : 0;
+    if (cov[5] > rows[widest][widest]) widest = 2;
+    float axis[3] = { rows[widest][0], rows[widest][1], rows[widest][2] };
+    if (rows[widest][widest] < 1e-6f) {
+        axis[0] = axis[1] = axis[2] = 1.0f;   // flat block, both endpoints land on the mean
+    }
+    for (int iteration = 0; iteration < 4; iteration++) {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float scale = fmaxf(fabsf(x), fmaxf(fabsf(y), fabsf(z)));
+        if (scale < 1e-6f) break;
+        axis[0] = x / scale; axis[1] = y / scale; axis[2] = z / scale;
+    }
+
+    float lengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = ((pixels[i][0] - mean[0]) * axis[0] + (pixels[i][1] - mean[1]) * axis[1] + (pixels[i][2] - mean[2]) * axis[2]) / lengthSq;
+        minT = fminf(minT, t);
+        maxT = fmaxf(maxT, t);
+    }
+
+    float e0[3], e1[3];
+    for (int c = 0; c < 3; c++) {
+        e0[c] = mean[c] + axis[c] * maxT;
+        e1[c] = mean[c] + axis[c] * minT;
+    }
+
+    uint16_t c0 = Pack565(e0), c1 = Pack565(e1);
+    unsigned char indices[16];
+    float error = FitColorIndices(pixels, c0, c1, indices);
+
+    if (RefitColorEndpoints(pixels, indices, e0, e1)) {
+        uint16_t r0 = Pack565(e0), r1 = Pack565(e1);
+        unsigned char refitIndices[16];
+        if (FitColorIndices(pixels, r0, r1, refitIndices) < error) {
+            c0 = r0;
+            c1 = r1;
+            memcpy(indices, refitIndices, sizeof(indices));
+        }
+    }
+
+    // Four-color mode needs c0 > c1: swap the endpoints and mirror the indices (0<->1, 2<->3)
+    if (c0 < c1) {
+        uint16_t swap = c0;
+        c0 = c1;
+        c1 = swap;
+        for (int i = 0; i < 16; i++) indices[i] ^= 1;
+    } else if (c0 == c1) {
+        memset(indices, 0, sizeof(indices));
+    }
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++) bits |= (uint32_t)indices[i] << (2 * i);
+    out[0] = (unsigned char)(c0 & 0xFF); out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xFF); out[3] = (unsigned char)(c1 >> 8);
+    for (int i = 0; i < 4; i++) out[4 + i] = (unsigned char)(bits >> (8 * i));
+}
+
+// BC4 in eight-value mode between the block's min and max of one channel (stride 4 in an RGBA block)
+static void EncodeChannelBlock(const unsigned char* block, unsigned char* out) {
+    int lo = 255, hi = 0;
+    for (int i = 0; i < 16; i++) {
+        int v = block[i * 4];
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+    }
+
+    out[0] = (unsigned char)hi;
+    out[1] = (unsigned char)lo;
+    uint64_t bits = 0;
+    if (hi > lo) {
+        float palette[8] = { (float)hi, (float)lo };
+        for (int p = 2; p < 8; p++) palette[p] = ((8 - p) * hi + (p - 1) * lo) / 7.0f;
+
+        for (int i = 0; i < 16; i++) {
+            float v = (float)block[i * 4];
+            int best = 0;
+            for (int p = 1; p < 8; p++) {
+                if (fabsf(palette[p] - v) < fabsf(palette[best] - v)) best = p;
+            }
+            bits |= (uint64_t)best << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; i++) out[2 + i] = (unsigned char)(bits >> (8 * i));
+}
+
+static void DecodeColorBlock(const unsigned char* in, unsigned char* block, bool fourColor) {
+    uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8)), c1 = (uint16_t)(in[2] | (in[3] << 8));
+    float palette[4][4];
+    Unpack565(c0, palette[0]);
+    Unpack565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255.0f;
+    for (int c = 0; c < 3; c++) {
+        if (fourColor || c0 > c1) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+            palette[3][c] = 0.0f;
+        }
+    }
+    if (!fourColor && c0 <= c1) palette[3][3] = 0.0f;
+
+    uint32_t bits = (uint32_t)in[4] | ((uint32_t)in[5] << 8) | ((uint32_t)in[6] << 16) | ((uint32_t)in[7] << 24);
+    for (int i = 0; i < 16; i++) {
+        const float* color = palette[(bits >> (2 * i)) & 3];
+        for (int c = 0; c < 4; c++) block[i * 4 + c] = (unsigned char)(color[c] + 0.5f);
+    }
+}
+
+static void DecodeChannelBlock(const unsigned char* in, unsigned char* block) {
+    int a0 = in[0], a1 = in[1];
+    float palette[8] = { (float)a0, (float)a1 };
+    if (a0 > a1) {
+        for (int p = 2; p < 8; p++) palette[p] = ((8 - p) * a0 + (p - 1) * a1) / 7.0f;
+    } else {
+        for (int p = 2; p < 6; p++) palette[p] = ((6 - p) * a0 + (p - 1) * a1) / 5.0f;
+        palette[6] = 0.0f;
+        palette[7] = 255.0f;
+    }
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++) bits |= (uint64_t)in[2 + i] << (8 * i);
+    for (int i = 0; i < 16; i++) block[i * 4] = (unsigned char)(palette[(bits >> (3 * i)) & 7] + 0.5f);
+}
+
+void EncodeTextureBlock(TextureCodec codec, const unsigned char* block, unsigned char* out) {
+    switch (codec) {
+        case TEXTURE_CODEC_BC1: EncodeColorBlock(block, out); break;
+        case TEXTURE_CODEC_BC3: EncodeChannelBlock(block + 3, out); EncodeColorBlock(block, out + 8); break;
+        case TEXTURE_CODEC_BC5: EncodeChannelBlock(block + 0, out); EncodeChannelBlock(block + 1, out + 8); break;
+        default: break;
+    }
+}
+
+void DecodeTextureBlock(TextureCodec codec, const unsigned char* in, unsigned char* block) {
+    switch (codec) {
+        case TEXTURE_CODEC_BC1: DecodeColorBlock(in, block, false); break;
+        case TEXTURE_CODEC_BC3: DecodeColorBlock(in + 8, block, true); DecodeChannelBlock(in, block + 3); break;
+        case TEXTURE_CODEC_BC5:
+            DecodeChannelBlock(in, block + 0);
+            DecodeChannelBlock(in + 8, block + 1);
+            for (int i = 0; i < 16; i++) {
+                block[i * 4 + 2] = 0;
+                block[i * 4 + 3] = 255;
+            }
+            break;
+        default: break;
+    }
+}
+
+// Runs fn(blockX, blockY, level pixels, level blocks) over every block of every level, rows spread over the workers
+template <typename BlockFn>
+static void ForEachBlock(TextureCodec codec, int width, int height, int mipmaps, unsigned char* pixels, unsigned char* blocks, BlockFn fn) {
+    for (int level = 0; level < mipmaps; level++) {
+        int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        ParallelFor(blocksY, BLOCK_ROWS_PER_JOB, [=](int begin, int end) {
+            for (int by = begin; by < end; by++) {
+                for (int bx = 0; bx < blocksX; bx++) {
+                    fn(pixels, width, height, bx, by, blocks + ((size_t)by * blocksX + bx) * BlockBytes(codec));
+                }
+            }
+        });
+
+        pixels += (size_t)width * height * 4;
+        blocks += GetCompressedLevelSize(codec, width, height);
+        width = (width > 1) ? width / 2 : 1;
+        height = (height > 1) ? height / 2 : 1;
+    }
+}
+
+void EncodeTextureChain(Image image, TextureCodec codec, unsigned char* output) {
+    ForEachBlock(codec, image.width, image.height, image.mipmaps, (unsigned char*)image.data, output,
+                 [codec](const unsigned char* pixels, int width, int height, int bx, int by, unsigned char* out) {
+        // Edge blocks of odd-sized and tiny levels repeat the last row and column
+        unsigned char block[64];
+        for (int y = 0; y < 4; y++) {
+            int sy = (by * 4 + y < height) ? by * 4 + y : height - 1;
+            for (int x = 0; x < 4; x++) {
+                int sx = (bx * 4 + x < width) ? bx * 4 + x : width - 1;
+                memcpy(&block[(y * 4 + x) * 4], &pixels[((size_t)sy * width + sx) * 4], 4);
+            }
+        }
+        EncodeTextureBlock(codec, block, out);
+    });
+}
+
+static std::vector<unsigned char> DecodeTextureChain(const unsigned char* data, int width, int height, int mipmaps, TextureCodec codec) {
+    std::vector<unsigned char> pixels(GetCompressedChainSize(TEXTURE_CODEC_NONE, width, height, mipmaps));
+    ForEachBlock(codec, width, height, mipmaps, pixels.data(), (unsigned char*)data,
+                 [codec](unsigned char* pixels, int width, int height, int bx, int by, const unsigned char* in) {
+        unsigned char block[64];
+        DecodeTextureBlock(codec, in, block);
+        for (int y = 0; y < 4 && by * 4 + y < height; y++) {
+            for (int x = 0; x < 4 && bx * 4 + x < width; x++) {
+                memcpy(&pixels[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4], &block[(y * 4 + x) * 4], 4);
+            }
+        }
+    });
+    return pixels;
+}
+
+static bool HasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension != NULL && strcmp(extension, name) == 0) return true;
+    }
+    return false;
+}
+
+bool IsTextureCodecSupported(TextureCodec codec) {
+    switch (codec) {
+        case TEXTURE_CODEC_NONE:
+        case TEXTURE_CODEC_BC5:
+            return true;
+        case TEXTURE_CODEC_BC1:
+        case TEXTURE_CODEC_BC3:
+            if (supportS3TC < 0) {
+                supportS3TC = HasExtension("GL_EXT_texture_compression_s3tc") ? 1 : 0;
+                if (!supportS3TC) TraceLog(LOG_WARNING, "TEXTURES: No S3TC support, BC1/BC3 textures are decoded on the CPU");
+            }
+            return supportS3TC == 1;
+    }
+    return false;
+}
+
+static GLenum GlFormat(TextureCodec codec) {
+    switch (codec) {
+        case TEXTURE_CODEC_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TEXTURE_CODEC_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        default: return GL_COMPRESSED_RG_RGTC2;
+    }
+}
+
+// raylib has no two-channel format; BC5 reports DXT5, which has the same block size
+static int RaylibFormat(TextureCodec codec) {
+    return (codec == TEXTURE_CODEC_BC1) ? PIXELFORMAT_COMPRESSED_DXT1_RGB : PIXELFORMAT_COMPRESSED_DXT5_RGBA;
+}
+
+static TextureCodec CodecOfFormat(int format) {
+    switch (format) {
+        case PIXELFORMAT_COMPRESSED_DXT1_RGB:
+        case PIXELFORMAT_COMPRESSED_DXT1_RGBA: return TEXTURE_CODEC_BC1;
+        case PIXELFORMAT_COMPRESSED_DXT3_RGBA:
+        case PIXELFORMAT_COMPRESSED_DXT5_RGBA: return TEXTURE_CODEC_BC3;
+        default: return TEXTURE_CODEC_NONE;
+    }
+}
+
+Texture2D LoadCompressedTexture(const unsigned char* data, int width, int height, int mipmaps, TextureCodec codec) {
+    Texture2D texture = { 0 };
+    texture.width = width;
+    texture.height = height;
+    texture.mipmaps = mipmaps;
+
+    if (!IsTextureCodecSupported(codec)) {
+        std::vector<unsigned char> pixels = DecodeTextureChain(data, width, height, mipmaps, codec);
+        texture.id = rlLoadTexture(pixels.data(), width, height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, mipmaps);
+        texture.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        decodeFallbacks++;
+        return texture;
+    }
+
+    glGenTextures(1, &texture.id);
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    for (int level = 0, w = width, h = height; level < mipmaps; level++) {
+        GLsizei size = (GLsizei)GetCompressedLevelSize(codec, w, h);
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, GlFormat(codec), w, h, 0, size, data);
+        data += size;
+        w = (w > 1) ? w / 2 : 1;
+        h = (h > 1) ? h / 2 : 1;
+    }
+
+    // Same sampling state rlLoadTexture gives a texture with mipmaps
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (mipmaps > 1) ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (mipmaps > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipmaps - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    texture.format = RaylibFormat(codec);
+    return texture;
+}
+
+TextureCubemap LoadCompressedCubemap(const unsigned char* faces, int size, TextureCodec codec) {
+    TextureCubemap cubemap = { 0 };
+    cubemap.width = size;
+    cubemap.height = size;
+    cubemap.mipmaps = 1;
+    size_t faceBytes = GetCompressedLevelSize(codec, size, size);
+
+    if (!IsTextureCodecSupported(codec)) {
+        size_t pixelBytes = GetCompressedLevelSize(TEXTURE_CODEC_NONE, size, size);
+        std::vector<unsigned char> pixels(pixelBytes * 6);
+        for (int face = 0; face < 6; face++) {
+            std::vector<unsigned char> decoded = DecodeTextureChain(faces + faceBytes * face, size, size, 1, codec);
+            memcpy(&pixels[pixelBytes * face], decoded.data(), pixelBytes);
+        }
+        cubemap.id = rlLoadTextureCubemap(pixels.data(), size, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+        cubemap.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        decodeFallbacks++;
+        return cubemap;
+    }
+
+    glGenTextures(1, &cubemap.id);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap.id);
+    for (int face = 0; face < 6; face++) {
+        glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GlFormat(codec), size, size, 0, (GLsizei)faceBytes, faces + faceBytes * face);
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    cubemap.format = RaylibFormat(codec);
+    return cubemap;
+}
+
+int GetTextureDecodeFallbackCount() {
+    return decodeFallbacks;
+}
+
+void AddTextureMemory(TextureMemory* memory, Texture2D texture, int faces) {
+    if (texture.id == 0) return;
+    TextureCodec codec = CodecOfFormat(texture.format);
+    size_t gpuBytes = 0;
+    for (int level = 0, w = texture.width, h = texture.height; level < texture.mipmaps; level++) {
+        gpuBytes += (codec != TEXTURE_CODEC_NONE) ? GetCompressedLevelSize(codec, w, h) : (size_t)GetPixelDataSize(w, h, texture.format);
+        w = (w > 1) ? w / 2 : 1;
+        h = (h > 1) ? h / 2 : 1;
+    }
+
+    memory->gpuBytes += gpuBytes * faces;
+    memory->uncompressedBytes += GetCompressedChainSize(TEXTURE_CODEC_NONE, texture.width, texture.height, texture.mipmaps) * faces;
+    memory->textures++;
+    if (codec != TEXTURE_CODEC_NONE) memory->compressed++;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "raylib.h"
+#include <stddef.h>
+
+// Block-compressed encodings the cook writes; every one works on 4x4 pixel blocks
+typedef enum {
+    TEXTURE_CODEC_NONE = 0,   // RGBA8
+    TEXTURE_CODEC_BC1,        // opaque color, 8 bytes per block (DXT1)
+    TEXTURE_CODEC_BC3,        // color + alpha: a BC4 alpha block, then a BC1 color block (DXT5)
+    TEXTURE_CODEC_BC5         // two channels, a BC4 block each (RGTC2); normal map X and Y
+} TextureCodec;
+
+// GPU memory of a set of textures next to what the same mip chains cost as RGBA8
+typedef struct {
+    size_t gpuBytes;
+    size_t uncompressedBytes;
+    int textures;
+    int compressed;
+} TextureMemory;
+
+size_t GetCompressedLevelSize(TextureCodec codec, int width, int height);
+size_t GetCompressedChainSize(TextureCodec codec, int width, int height, int mipmaps);
+
+// One 4x4 block of RGBA8 pixels, row by row, to and from its encoding (8 bytes for BC1, 16 for BC3 and BC5)
+void EncodeTextureBlock(TextureCodec codec, const unsigned char* block, unsigned char* out);
+void DecodeTextureBlock(TextureCodec codec, const unsigned char* in, unsigned char* block);
+
+// Encode an RGBA8 image and its mip chain (rlLoadTexture layout) on the job system workers
+void EncodeTextureChain(Image image, TextureCodec codec, unsigned char* output);
+
+// BC5 is core since GL 3.0; BC1/BC3 need EXT_texture_compression_s3tc
+bool IsTextureCodecSupported(TextureCodec codec);
+
+// Create GL textures from encoded data; without driver support the blocks are
+// decoded to RGBA8 on the CPU first and uploaded like any other texture
+Texture2D LoadCompressedTexture(const unsigned char* data, int width, int height, int mipmaps, TextureCodec codec);
+TextureCubemap LoadCompressedCubemap(const unsigned char* faces, int size, TextureCodec codec);
+int GetTextureDecodeFallbackCount();
+
+// Add one texture (faces = 6 for a cubemap); the caller skips textures it has already counted
+void AddTextureMemory(TextureMemory* memory, Texture2D texture, int faces);
@@ -0,0 +1,149 @@
+#include "texture_compression.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// Round trip of known 4x4 blocks through the CPU encoder and decoder; fails when the decoded
+// block drifts further from the source than the format's quantization explains
+typedef struct {
+    const char* name;
+    unsigned char pixels[64];
+} TestBlock;
+
+typedef struct {
+    int maxError;   // largest per-channel difference
+    double rmse;    // over the checked channels of all 16 pixels
+} BlockError;
+
+static void FillSolid(TestBlock* block, unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    for (int i = 0; i < 16; i++) {
+        block->pixels[i * 4 + 0] = r;
+        block->pixels[i * 4 + 1] = g;
+        block->pixels[i * 4 + 2] = b;
+        block->pixels[i * 4 + 3] = a;
+    }
+}
+
+static TestBlock SolidBlock() {
+    TestBlock block = { "solid", { 0 } };
+    FillSolid(&block, 200, 100, 50, 255);
+    return block;
+}
+
+// Horizontal ramp from dark blue to orange: four steps, one per palette entry of BC1
+static TestBlock GradientBlock() {
+    TestBlock block = { "gradient", { 0 } };
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            int t = x * 255 / 3;
+            unsigned char* pixel = &block.pixels[(y * 4 + x) * 4];
+            pixel[0] = (unsigned char)(40 + t * 200 / 255);
+            pixel[1] = (unsigned char)(30 + t * 120 / 255);
+            pixel[2] = (unsigned char)(180 - t * 160 / 255);
+            pixel[3] = 255;
+        }
+    }
+    return block;
+}
+
+// Checkerboard of two colors; both sit exactly on the endpoints
+static TestBlock TwoColorBlock() {
+    TestBlock block = { "two-color", { 0 } };
+    for (int i = 0; i < 16; i++) {
+        bool first = ((i % 4) + (i / 4)) % 2 == 0;
+        unsigned char* pixel = &block.pixels[i * 4];
+        pixel[0] = first ? 230 : 20;
+        pixel[1] = first ? 220 : 60;
+        pixel[2] = first ? 30 : 200;
+        pixel[3] = 255;
+    }
+    return block;
+}
+
+// Opaque left half and transparent right half over one color, as on a cutout's silhouette
+static TestBlock AlphaEdgeBlock() {
+    TestBlock block = { "alpha edge", { 0 } };
+    FillSolid(&block, 90, 160, 70, 255);
+    for (int i = 0; i < 16; i++) {
+        if (i % 4 >= 2) block.pixels[i * 4 + 3] = 0;
+    }
+    return block;
+}
+
+static const char* CodecName(TextureCodec codec) {
+    switch (codec) {
+        case TEXTURE_CODEC_BC1: return "BC1";
+        case TEXTURE_CODEC_BC3: return "BC3";
+        case TEXTURE_CODEC_BC5: return "BC5";
+        default: return "RGBA8";
+    }
+}
+
+// BC1 drops alpha and BC5 keeps only red and green; the rest is not compared
+static BlockError RoundTrip(TextureCodec codec, const TestBlock* block) {
+    unsigned char encoded[16], decoded[64];
+    EncodeTextureBlock(codec, block->pixels, encoded);
+    DecodeTextureBlock(codec, encoded, decoded);
+
+    int channels = (codec == TEXTURE_CODEC_BC3) ? 4 : (codec == TEXTURE_CODEC_BC5) ? 2 : 3;
+    BlockError error = { 0, 0.0 };
+    double sum = 0.0;
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < channels; c++) {
+            int diff = abs((int)decoded[i * 4 + c] - (int)block->pixels[i * 4 + c]);
+            if (diff > error.maxError) error.maxError = diff;
+            sum += (double)diff * diff;
+        }
+    }
+    error.rmse = sqrt(sum / (16.0 * channels));
+    return error;
+}
+
+int main() {
+    // Per-channel bounds: BC1 endpoints are 5:6:5, so a color is off by up to 4 plus a rounding step
+    // on the interpolated entries. BC4 keeps 8-bit endpoints, but its six in-between values split the
+    // range in sevenths, so the ramp's thirds land up to 1/21 of its 200-wide span (10) from one.
+    typedef struct {
+        TextureCodec codec;
+        TestBlock block;
+        int maxError;
+        double maxRmse;
+    } TestCase;
+    const TestCase cases[] = {
+        { TEXTURE_CODEC_BC1, SolidBlock(), 4, 4.0 },
+        { TEXTURE_CODEC_BC1, GradientBlock(), 6, 3.0 },
+        { TEXTURE_CODEC_BC1, TwoColorBlock(), 4, 4.0 },
+        { TEXTURE_CODEC_BC3, SolidBlock(), 4, 4.0 },
+        { TEXTURE_CODEC_BC3, GradientBlock(), 6, 3.0 },
+        { TEXTURE_CODEC_BC3, TwoColorBlock(), 4, 4.0 },
+        { TEXTURE_CODEC_BC3, AlphaEdgeBlock(), 4, 4.0 },
+        { TEXTURE_CODEC_BC5, SolidBlock(), 0, 0.0 },
+        { TEXTURE_CODEC_BC5, GradientBlock(), 10, 6.0 },
+        { TEXTURE_CODEC_BC5, TwoColorBlock(), 0, 0.0 },
+    };
+
+    int failures = 0;
+    for (const TestCase& test : cases) {
+        BlockError error = RoundTrip(test.codec, &test.block);
+        bool passed = error.maxError <= test.maxError && error.rmse <= test.maxRmse;
+        printf("%s %-10s max %3d (limit %3d), rmse %6.2f (limit %6.2f)  %s\n", CodecName(test.codec), test.block.name,
+               error.maxError, test.maxError, error.rmse, test.maxRmse, passed ? "ok" : "FAILED");
+        if (!passed) failures++;
+    }
+
+    // The alpha edge has to stay a hard edge: BC3 keeps 0 and 255 as its BC4 endpoints
+    TestBlock edge = AlphaEdgeBlock();
+    unsigned char encoded[16], decoded[64];
+    EncodeTextureBlock(TEXTURE_CODEC_BC3, edge.pixels, encoded);
+    DecodeTextureBlock(TEXTURE_CODEC_BC3, encoded, decoded);
+    for (int i = 0; i < 16; i++) {
+        if (decoded[i * 4 + 3] != edge.pixels[i * 4 + 3]) {
+            printf("BC3 alpha edge: pixel %d alpha %d, expected %d  FAILED\n", i, decoded[i * 4 + 3], edge.pixels[i * 4 + 3]);
+            failures++;
+            break;
+        }
+    }
+
+    printf("%d of %d checks failed\n", failures, (int)(sizeof(cases) / sizeof(cases[0])) + 1);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}